@@ -204,8 +204,11 @@ void Copter::barometer_accumulate(void)
 
 void Copter::perf_update(void)
 {
-    if (should_log(MASK_LOG_PM))
+    if (should_log(MASK_LOG_PM)) {
         Log_Write_Performance();
+        Log_Write_Latency();
+    }
+    latency_trace.reset_stats();
     if (scheduler.debug()) {
         gcs_send_text_fmt(MAV_SEVERITY_WARNING, "PERF: %u/%u %lu %lu\n",
                           (unsigned)perf_info_get_num_long_running(),
@@ -255,19 +258,36 @@ void Copter::loop()
 void Copter::fast_loop()
 {
 
+#if RATE_THREAD == ENABLED
+    // take back the rate controllers if the rate loop thread has stopped
+    rate_thread_check();
+#endif
+
+    if (!rate_thread_active) {
+        // trace the latest IMU sample through to the motor outputs
+        latency_trace.begin(ins.get_last_gyro_arrival_us());
+    }
+
     // IMU DCM Algorithm
     // --------------------
     read_AHRS();
 
-    // run low level rate controllers that only require IMU data
-    attitude_control.rate_controller_run();//RUAS
+    if (!rate_thread_active) {
+        latency_trace.mark(LatencyTrace::STAGE_AHRS);
+
+        // run low level rate controllers that only require IMU data
+        attitude_control.rate_controller_run();//RUAS
+        latency_trace.mark(LatencyTrace::STAGE_RATE_CONTROL);
 
 #if FRAME_CONFIG == HELI_FRAME
-    update_heli_control_dynamics();
+        update_heli_control_dynamics();
 #endif //HELI_FRAME
 
-    // send outputs to the motors library
-    motors_output();
+        // send outputs to the motors library
+        motors_output();
+        latency_trace.mark(LatencyTrace::STAGE_OUTPUT);
+        latency_trace.end();
+    }
 
     // Inertial Nav
     // --------------------
@@ -276,9 +296,26 @@ void Copter::fast_loop()
     // check if ekf has reset target heading
     check_ekf_yaw_reset();
 
+#if SHARED_COMMAND == ENABLED
+    // pick up offboard targets in time for this loop's controllers
+    shared_command_update();
+#endif
+
     // run the attitude controllers
     update_flight_mode();
 
+#if RATE_THREAD == ENABLED
+    if (rate_thread_active) {
+        // hand the new targets, throttle and any rate controller relax
+        // to the rate loop thread
+        struct rate_thread_targets targets;
+        targets.ang_vel_target_rads = attitude_control.get_ang_vel_target_rads();
+        targets.gyro_drift = ahrs.get_gyro_drift();
+        targets.request = attitude_control.get_rate_thread_request();
+        rate_targets.write(targets);
+    }
+#endif
+
     // update home from EKF if necessary
     update_home_from_EKF();
 
@@ -294,6 +331,210 @@ void Copter::fast_loop()
     if (should_log(MASK_LOG_ANY)) {
         Log_Sensor_Health();
     }
+
+#if SHARED_STATE == ENABLED
+    // export this loop's state to local companion processes
+    shared_state_update();
+#endif
+}
+
+#if RATE_THREAD == ENABLED
+// rate_thread_init - ask the HAL to run rate_thread_update for each
+// gyro sample. Falls back to running the rate controllers from
+// fast_loop if the board can't
+void Copter::rate_thread_init()
+{
+    // the sensor rate is only an upper bound; backends that read a
+    // FIFO wake the thread once per burst
+    const uint16_t rate_hz = MIN(ins.get_gyro_rate_hz(), RATE_THREAD_MAX_HZ);
+    if (rate_hz <= MAIN_LOOP_RATE) {
+        // nothing to gain over fast_loop
+        return;
+    }
+    rate_thread_sem = hal.util->new_semaphore();
+    if (rate_thread_sem == nullptr) {
+        return;
+    }
+    if (!hal.scheduler->register_rate_process(FUNCTOR_BIND_MEMBER(&Copter::rate_thread_update, void))) {
+        return;
+    }
+    rate_thread_start();
+    hal.console->printf("Rate loop thread at up to %uHz\n", (unsigned)rate_hz);
+}
+
+// rate_thread_start - hand the rate controllers and motor outputs to
+// the rate loop thread
+void Copter::rate_thread_start()
+{
+    rate_thread_lock();
+    rate_thread_last_us = AP_HAL::micros();
+    rate_thread_wakeup_us = rate_thread_last_us;
+    rate_thread_count_start_us = rate_thread_last_us;
+    rate_thread_count = 0;
+    // the motors ramp and filter per call to output(). This is
+    // corrected to the measured rate once the thread is running
+    motors.set_loop_rate(MIN(ins.get_gyro_rate_hz(), RATE_THREAD_MAX_HZ));
+    // the flight modes leave the throttle and rate integrators to the
+    // thread from here on
+    attitude_control.set_rate_thread_requests(true);
+    rate_thread_active = true;
+    rate_thread_unlock();
+}
+
+// rate_thread_stop - take the rate controllers and motor outputs back
+// for fast_loop
+void Copter::rate_thread_stop()
+{
+    rate_thread_lock();
+    rate_thread_active = false;
+    motors.set_loop_rate(MAIN_LOOP_RATE);
+    attitude_control.set_rate_dt(MAIN_LOOP_SECONDS);
+    // apply any throttle and relax the thread hasn't picked up yet
+    attitude_control.set_rate_thread_requests(false);
+    attitude_control.apply_rate_thread_request(attitude_control.get_rate_thread_request());
+    rate_thread_unlock();
+}
+
+// rate_thread_pause - for main loop code that drives the motors itself
+// for a while, such as compassmot and the motor test. Does nothing if
+// the thread isn't running
+void Copter::rate_thread_pause()
+{
+    if (rate_thread_active) {
+        rate_thread_stop();
+        rate_thread_paused = true;
+    }
+}
+
+// rate_thread_resume - undo rate_thread_pause
+void Copter::rate_thread_resume()
+{
+    if (rate_thread_paused) {
+        rate_thread_paused = false;
+        rate_thread_start();
+    }
+}
+
+// rate_thread_update - run the rate controllers and motor outputs for
+// the latest gyro sample against the targets and throttle of the last
+// fast_loop. Called on the HAL rate loop thread, so must not block
+void Copter::rate_thread_update()
+{
+    const uint32_t now_us = AP_HAL::micros();
+    if (now_us - rate_thread_last_us < 900000UL / RATE_THREAD_MAX_HZ) {
+        // decimate samples arriving faster than RATE_THREAD_MAX_HZ
+        return;
+    }
+    rate_thread_wakeup_us = now_us;
+    if (!rate_thread_sem->take_nonblocking()) {
+        // main loop code is changing the motor or controller state,
+        // which only takes a moment. Use the next sample
+        return;
+    }
+    if (!rate_thread_active) {
+        // fast_loop has taken the rate controllers back
+        rate_thread_sem->give();
+        return;
+    }
+
+    const float dt = (now_us - rate_thread_last_us) * 1.0e-6f;
+    rate_thread_last_us = now_us;
+
+    struct rate_thread_targets targets;
+    Vector3f gyro;
+    if (!rate_targets.read(targets) || !ins.get_rate_gyro(gyro)) {
+        // nothing from fast_loop yet
+        rate_thread_sem->give();
+        return;
+    }
+
+    // the rate PIDs are only run from this thread now, at the rate
+    // the samples actually arrive
+    attitude_control.set_rate_dt(constrain_float(dt, 1.0f / RATE_THREAD_MAX_HZ, MAIN_LOOP_SECONDS));
+    rate_thread_update_loop_rate(now_us);
+    attitude_control.apply_rate_thread_request(targets.request);
+
+    latency_trace.begin(ins.get_last_gyro_arrival_us());
+    latency_trace.mark(LatencyTrace::STAGE_AHRS);
+
+    attitude_control.rate_controller_run_gyro(targets.ang_vel_target_rads, gyro + targets.gyro_drift);
+    latency_trace.mark(LatencyTrace::STAGE_RATE_CONTROL);
+
+    motors_output();
+    latency_trace.mark(LatencyTrace::STAGE_OUTPUT);
+    latency_trace.end();
+
+    rate_thread_sem->give();
+}
+
+// rate_thread_update_loop_rate - set the motors loop rate, which their
+// ramps and filters assume, from the rate the thread actually runs at
+void Copter::rate_thread_update_loop_rate(uint32_t now_us)
+{
+    rate_thread_count++;
+    const uint32_t elapsed_us = now_us - rate_thread_count_start_us;
+    if (elapsed_us < 1000000UL) {
+        return;
+    }
+    const uint32_t rate_hz = (uint64_t)rate_thread_count * 1000000UL / elapsed_us;
+    motors.set_loop_rate(constrain_int32(rate_hz, MAIN_LOOP_RATE, RATE_THREAD_MAX_HZ));
+    rate_thread_count = 0;
+    rate_thread_count_start_us = now_us;
+}
+
+// rate_thread_check - watchdog for the rate loop thread. If gyro
+// wakeups stop, fast_loop runs the rate controllers and motors again
+// rather than leaving the motors at their last output
+void Copter::rate_thread_check()
+{
+    if (!rate_thread_active) {
+        return;
+    }
+    // read the last wakeup first so it can't be later than now
+    const uint32_t last_us = rate_thread_wakeup_us;
+    if (AP_HAL::micros() - last_us < RATE_THREAD_TIMEOUT_MS * 1000UL) {
+        return;
+    }
+    rate_thread_stop();
+    gcs_send_text(MAV_SEVERITY_CRITICAL, "Rate loop thread stopped");
+    Log_Write_Error(ERROR_SUBSYSTEM_RATE_THREAD, ERROR_CODE_FAILSAFE_OCCURRED);
+}
+
+#endif // RATE_THREAD
+
+// rate_thread_lock - keep the rate loop thread out of the rate
+// controllers and motors while main loop code changes their state.
+// The thread skips samples rather than wait, so hold this only around
+// the calls that change that state
+void Copter::rate_thread_lock()
+{
+#if RATE_THREAD == ENABLED
+    if (rate_thread_sem != nullptr &&
+        !rate_thread_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        AP_HAL::panic("Rate loop: unable to get semaphore");
+    }
+#endif
+}
+
+// rate_thread_trylock - rate_thread_lock for callers that can't block.
+// Returns false if the rate loop thread holds the lock
+bool Copter::rate_thread_trylock()
+{
+#if RATE_THREAD == ENABLED
+    if (rate_thread_sem != nullptr) {
+        return rate_thread_sem->take_nonblocking();
+    }
+#endif
+    return true;
+}
+
+void Copter::rate_thread_unlock()
+{
+#if RATE_THREAD == ENABLED
+    if (rate_thread_sem != nullptr) {
+        rate_thread_sem->give();
+    }
+#endif
 }
 
 // rc_loops - reads user input from transmitter/receiver
@@ -314,7 +555,9 @@ void Copter::throttle_loop()
     read_inertial_altitude();
 
     // update throttle_low_comp value (controls priority of throttle vs attitude control)
+    rate_thread_lock();
     update_throttle_thr_mix();
+    rate_thread_unlock();
 
     // check auto_armed status
     update_auto_armed();
@@ -487,6 +730,11 @@ void Copter::one_hz_loop()
 
     update_arming_checks();
 
+    // latency stats are logged with PM, and each loop is exported
+    // as a trace with LATENCY
+    latency_trace.set_enabled(should_log(MASK_LOG_PM) || (g.log_bitmask & MASK_LOG_LATENCY),
+                              (g.log_bitmask & MASK_LOG_LATENCY) != 0);
+
     if (!motors.armed()) {
         // make it possible to change ahrs orientation at runtime during initial config
         ahrs.set_orientation();
@@ -494,6 +742,7 @@ void Copter::one_hz_loop()
         update_using_interlock();
 
 #if FRAME_CONFIG != HELI_FRAME
+        rate_thread_lock();
         // check the user hasn't updated the frame orientation
         motors.set_frame_orientation(g.frame_orientation);
 
@@ -501,6 +750,7 @@ void Copter::one_hz_loop()
         motors.set_throttle_range(g.throttle_min, channel_throttle->radio_min, channel_throttle->radio_max);
         // set hover throttle
         motors.set_hover_throttle(g.throttle_mid);
+        rate_thread_unlock();
 #endif
     }
 
@@ -128,7 +128,9 @@ void Copter::set_throttle_takeoff()
     pos_control.init_takeoff();
 
     // tell motors to do a slow start
+    rate_thread_lock();
     motors.slow_start(true);
+    rate_thread_unlock();
 }
 
 // get_pilot_desired_throttle - transform pilot's throttle input to make cruise throttle mid stick
@@ -33,6 +33,7 @@
 #include <stdarg.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
 
 // Common dependencies
 #include <AP_Common/AP_Common.h>
@@ -83,6 +84,7 @@
 #include <AP_Declination/AP_Declination.h>     // ArduPilot Mega Declination Helper Library
 #include <AC_Fence/AC_Fence.h>           // Arducopter Fence library
 #include <AP_Scheduler/AP_Scheduler.h>       // main loop scheduler
+#include <AP_Scheduler/LatencyTrace.h>       // sensor to motor latency
 #include <AP_RCMapper/AP_RCMapper.h>        // RC input mapping library
 #include <AP_Notify/AP_Notify.h>          // Notify library
 #include <AP_BattMonitor/AP_BattMonitor.h>     // Battery monitor library
@@ -91,6 +93,8 @@
 #include <AP_LandingGear/AP_LandingGear.h>     // Landing Gear library
 #include <AP_Terrain/AP_Terrain.h>
 #include <AP_ADSB/AP_ADSB.h>
+#include <AP_SharedState/AP_SharedState.h>
+#include <AP_SharedState/AP_SharedCommand.h>
 #include <AP_RPM/AP_RPM.h>
 #include <AC_InputManager/AC_InputManager.h>        // Pilot input handling library
 #include <AC_InputManager/AC_InputManager_Heli.h>   // Heli specific pilot input handling library
@@ -102,7 +106,7 @@
 // libraries which are dependent on #defines in defines.h and/or config.h
 #if SPRAYER == ENABLED
 #include <AC_Sprayer/AC_Sprayer.h>         // crop sprayer library
-#endif
+#endif
 #if EPM_ENABLED == ENABLED
 #include <AP_EPM/AP_EPM.h>             // EPM cargo gripper stuff
 #endif
@@ -113,14 +117,14 @@
 #include <AC_PrecLand/AC_PrecLand.h>
 #include <AP_IRLock/AP_IRLock.h>
 #endif
-
+
 // Local modules
 #include "Parameters.h"
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include <SITL/SITL.h>
-#endif
-
+#endif
+
 #include <AP_Detection/AP_Detection_I2C.h>     //RUAS detection IO library
 
 class Copter : public AP_HAL::HAL::Callbacks {
@@ -149,6 +153,36 @@ private:
     // main loop scheduler
     AP_Scheduler scheduler;
 
+    // IMU sample to motor output latency of the fast loop, or of the
+    // rate loop thread while that is running
+    LatencyTrace latency_trace;
+
+    // set once the HAL is running rate_thread_update() for each gyro
+    // sample, after which fast_loop leaves the rate controllers and
+    // motor outputs to it
+    volatile bool rate_thread_active;
+#if RATE_THREAD == ENABLED
+    // rate controller inputs from fast_loop for the rate loop thread
+    struct rate_thread_targets {
+        Vector3f ang_vel_target_rads;
+        Vector3f gyro_drift;
+        AC_AttitudeControl::rate_thread_request request;
+    };
+    AP_HAL::DoubleBuffer<rate_thread_targets> rate_targets;
+    // held by the rate loop thread while it runs the rate controllers
+    // and motors, and by main loop code that changes their state
+    AP_HAL::Semaphore *rate_thread_sem;
+    // time of the last wakeup the rate loop thread acted on
+    volatile uint32_t rate_thread_last_us;
+    // time of the last wakeup, acted on or not, for the watchdog
+    volatile uint32_t rate_thread_wakeup_us;
+    // measurement of the rate the thread actually runs at
+    uint32_t rate_thread_count_start_us;
+    uint16_t rate_thread_count;
+    // set while rate_thread_pause() has taken the motors back
+    bool rate_thread_paused;
+#endif
+
     // AP_Notify instance
     AP_Notify notify;
 
@@ -178,7 +212,7 @@ private:
 
     //RUAS create a new object in the AP_Detection_I2C class
     AP_Detection_I2C detection;
-
+
 #if CONFIG_SONAR == ENABLED
     RangeFinder sonar {serial_manager};
     bool sonar_enabled; // enable user switch for sonar
@@ -250,7 +284,7 @@ private:
         };
         uint32_t value;
     } ap;
-
+
     //************************************//
     // RUAS Various detection/avoidance params
     Vector3f rel_d;                   // The last relative distance update from the detection hardware, x,y,z updated at 5Hz
@@ -556,6 +590,22 @@ private:
 
     AP_ADSB adsb {ahrs};
 
+#if SHARED_STATE == ENABLED
+    // fast loop state for processes on the same board
+    AP_SharedState shared_state;
+#endif
+
+#if SHARED_COMMAND == ENABLED
+    // guided and avoidance targets from processes on the same board
+    AP_SharedCommand shared_command;
+    struct {
+        uint8_t guided_type;        // guided ap_shared_command_type being followed
+        uint32_t guided_ms;         // time the last guided command was accepted
+        bool avoid_override;        // avoidance_maneuver() left to the commands
+        uint32_t avoid_ms;          // time the last avoidance command was accepted
+    } shared_command_state;
+#endif
+
     // use this to prevent recursion during sensor init
     bool in_mavlink_delay;
 
@@ -600,6 +650,17 @@ private:
     void barometer_accumulate(void);
     void perf_update(void);
     void fast_loop();
+    void rate_thread_init();
+    void rate_thread_update();
+    void rate_thread_update_loop_rate(uint32_t now_us);
+    void rate_thread_check();
+    void rate_thread_start();
+    void rate_thread_stop();
+    void rate_thread_pause();
+    void rate_thread_resume();
+    void rate_thread_lock();
+    bool rate_thread_trylock();
+    void rate_thread_unlock();
     void rc_loop();
     void throttle_loop();
     void update_mount();
@@ -678,6 +739,7 @@ private:
     void Log_Write_Nav_Tuning();
     void Log_Write_Control_Tuning();
     void Log_Write_Performance();
+    void Log_Write_Latency();
     void Log_Write_Attitude();
     void Log_Write_Rate();
     void Log_Write_MotBatt();
@@ -711,6 +773,12 @@ private:
     void userhook_SlowLoop();
     void userhook_SuperSlowLoop();
     void update_home_from_EKF();
+    void shared_state_init();
+    void shared_state_update();
+    void shared_command_init();
+    void shared_command_update();
+    bool shared_command_handle(const struct ap_shared_command &cmd);
+    void shared_command_check_timeout();
     void set_home_to_current_location_inflight();
     bool set_home_to_current_location();
     bool set_home_to_current_location_and_lock();
@@ -357,6 +357,35 @@ void Copter::Log_Write_Performance()
     DataFlash.WriteBlock(&pkt, sizeof(pkt));
 }
 
+#define LOG_LATENCY_FIELDS(F0, F)           \
+    F0(uint64_t, time_us, Q, TimeUS)        \
+    F(uint8_t,   stage,   B, Stage)         \
+    F(uint32_t,  count,   I, N)             \
+    F(uint16_t,  p50,     H, P50)           \
+    F(uint16_t,  p95,     H, P95)           \
+    F(uint16_t,  p99,     H, P99)           \
+    F(uint32_t,  max,     I, Max)
+LOG_MESSAGE_STRUCT(log_Latency, LOG_LATENCY_FIELDS);
+
+// Write the IMU sample to end of stage latency percentiles of each
+// stage of the fast loop
+void Copter::Log_Write_Latency()
+{
+    for (uint8_t s = 0; s < LatencyTrace::STAGE_MAX; s++) {
+        struct LatencyTrace::stats stats;
+        latency_trace.get_stats((enum LatencyTrace::stage)s, stats);
+        DataFlash_Message<log_Latency> pkt(DataFlash, LOG_LATENCY_MSG);
+        pkt->time_us = AP_HAL::micros64();
+        pkt->stage   = s;
+        pkt->count   = stats.count;
+        pkt->p50     = stats.p50;
+        pkt->p95     = stats.p95;
+        pkt->p99     = stats.p99;
+        pkt->max     = stats.max;
+        pkt.write();
+    }
+}
+
 // Write an attitude packet
 void Copter::Log_Write_Attitude()
 {
@@ -376,45 +405,44 @@ void Copter::Log_Write_Attitude()
     DataFlash.Log_Write_POS(ahrs);
 }
 
-struct PACKED log_Rate {
-    LOG_PACKET_HEADER;
-    uint64_t time_us;
-    float   control_roll;
-    float   roll;
-    float   roll_out;
-    float   control_pitch;
-    float   pitch;
-    float   pitch_out;
-    float   control_yaw;
-    float   yaw;
-    float   yaw_out;
-    float   control_accel;
-    float   accel;
-    float   accel_out;
-};
+#define LOG_RATE_FIELDS(F0, F)                  \
+    F0(uint64_t, time_us,       Q, TimeUS)      \
+    F(float,     control_roll,  f, RDes)        \
+    F(float,     roll,          f, R)           \
+    F(float,     roll_out,      f, ROut)        \
+    F(float,     control_pitch, f, PDes)        \
+    F(float,     pitch,         f, P)           \
+    F(float,     pitch_out,     f, POut)        \
+    F(float,     control_yaw,   f, YDes)        \
+    F(float,     yaw,           f, Y)           \
+    F(float,     yaw_out,       f, YOut)        \
+    F(float,     control_accel, f, ADes)        \
+    F(float,     accel,         f, A)           \
+    F(float,     accel_out,     f, AOut)
+LOG_MESSAGE_STRUCT(log_Rate, LOG_RATE_FIELDS);
 
 // Write an rate packet
 void Copter::Log_Write_Rate()
 {
     const Vector3f &rate_targets = attitude_control.rate_bf_targets();
     const Vector3f &accel_target = pos_control.get_accel_target();
-    struct log_Rate pkt_rate = {
-        LOG_PACKET_HEADER_INIT(LOG_RATE_MSG),
-        time_us         : AP_HAL::micros64(),
-        control_roll    : (float)rate_targets.x,
-        roll            : (float)(ahrs.get_gyro().x * AC_ATTITUDE_CONTROL_DEGX100),
-        roll_out        : motors.get_roll(),
-        control_pitch   : (float)rate_targets.y,
-        pitch           : (float)(ahrs.get_gyro().y * AC_ATTITUDE_CONTROL_DEGX100),
-        pitch_out       : motors.get_pitch(),
-        control_yaw     : (float)rate_targets.z,
-        yaw             : (float)(ahrs.get_gyro().z * AC_ATTITUDE_CONTROL_DEGX100),
-        yaw_out         : motors.get_yaw(),
-        control_accel   : (float)accel_target.z,
-        accel           : (float)(-(ahrs.get_accel_ef_blended().z + GRAVITY_MSS) * 100.0f),
-        accel_out       : motors.get_throttle()
-    };
-    DataFlash.WriteBlock(&pkt_rate, sizeof(pkt_rate));
+    const Vector3f &gyro = ahrs.get_gyro();
+    const float accel = -(ahrs.get_accel_ef_blended().z + GRAVITY_MSS) * 100.0f;
+    DataFlash_Message<log_Rate> pkt_rate(DataFlash, LOG_RATE_MSG);
+    pkt_rate->time_us       = AP_HAL::micros64();
+    pkt_rate->control_roll  = rate_targets.x;
+    pkt_rate->roll          = gyro.x * AC_ATTITUDE_CONTROL_DEGX100;
+    pkt_rate->roll_out      = motors.get_roll();
+    pkt_rate->control_pitch = rate_targets.y;
+    pkt_rate->pitch         = gyro.y * AC_ATTITUDE_CONTROL_DEGX100;
+    pkt_rate->pitch_out     = motors.get_pitch();
+    pkt_rate->control_yaw   = rate_targets.z;
+    pkt_rate->yaw           = gyro.z * AC_ATTITUDE_CONTROL_DEGX100;
+    pkt_rate->yaw_out       = motors.get_yaw();
+    pkt_rate->control_accel = accel_target.z;
+    pkt_rate->accel         = accel;
+    pkt_rate->accel_out     = motors.get_throttle();
+    pkt_rate.write();
 }
 
 struct PACKED log_MotBatt {
@@ -831,8 +859,8 @@ const struct LogStructure Copter::log_structure[] = {
       "CTUN", "Qhhfffecchh", "TimeUS,ThrIn,AngBst,ThrOut,DAlt,Alt,BarAlt,DSAlt,SAlt,DCRt,CRt" },
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),
       "PM",  "QHHIhBH",    "TimeUS,NLon,NLoop,MaxT,PMT,I2CErr,INSErr" },
-    { LOG_RATE_MSG, sizeof(log_Rate),
-      "RATE", "Qffffffffffff",  "TimeUS,RDes,R,ROut,PDes,P,POut,YDes,Y,YOut,ADes,A,AOut" },
+    LOG_MESSAGE_STRUCTURE(log_Latency, LOG_LATENCY_MSG, "LATN", LOG_LATENCY_FIELDS),
+    LOG_MESSAGE_STRUCTURE(log_Rate, LOG_RATE_MSG, "RATE", LOG_RATE_FIELDS),
     { LOG_MOTBATT_MSG, sizeof(log_MotBatt),
       "MOTB", "Qffff",  "TimeUS,LiftMax,BatVolt,BatRes,ThLimit" },
     { LOG_STARTUP_MSG, sizeof(log_Startup),
@@ -939,6 +967,7 @@ void Copter::Log_Write_Current() {}
 void Copter::Log_Write_Nav_Tuning() {}
 void Copter::Log_Write_Control_Tuning() {}
 void Copter::Log_Write_Performance() {}
+void Copter::Log_Write_Latency() {}
 void Copter::Log_Write_Attitude(void) {}
 void Copter::Log_Write_Rate() {}
 void Copter::Log_Write_MotBatt() {}
@@ -128,6 +128,11 @@ uint8_t Copter::mavlink_compassmot(mavlink_channel_t chan)
         interference_pct[i] = 0.0f;
     }
 
+#if RATE_THREAD == ENABLED
+    // this loop drives the motors itself
+    rate_thread_pause();
+#endif
+
     // enable motors and pass through throttle
     init_rc_out();
     enable_motor_output();
@@ -237,6 +242,10 @@ uint8_t Copter::mavlink_compassmot(mavlink_channel_t chan)
     motors.output_min();
     motors.armed(false);
 
+#if RATE_THREAD == ENABLED
+    rate_thread_resume();
+#endif
+
     // set and save motor compensation
     if (updated) {
         compass.motor_compensation_type(comp_type);
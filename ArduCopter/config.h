@@ -115,6 +115,28 @@
   # define AUTOTUNE_ENABLED                     DISABLED
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+// Rate loop thread
+//
+// run the rate controllers and motor outputs on a high priority thread
+// woken by each gyro sample, on boards whose HAL supports it, rather
+// than in fast_loop. Multicopters only
+#ifndef RATE_THREAD
+ # define RATE_THREAD   DISABLED
+#endif
+#if FRAME_CONFIG == HELI_FRAME
+ # undef RATE_THREAD
+ # define RATE_THREAD   DISABLED
+#endif
+// gyro samples arriving faster than this are skipped
+#ifndef RATE_THREAD_MAX_HZ
+ # define RATE_THREAD_MAX_HZ        2000
+#endif
+// fast_loop takes back the rate controllers if the thread stops for this long
+#ifndef RATE_THREAD_TIMEOUT_MS
+ # define RATE_THREAD_TIMEOUT_MS    50
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////
 // Y6 defaults
 #if FRAME_CONFIG == Y6_FRAME
@@ -328,6 +350,39 @@
 # define ADSB_ENABLED ENABLED
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+// Shared memory state export
+//
+// publish AHRS, navigation and RUAS detection state every fast loop to
+// processes on the same board, such as a companion computer stack.
+// Only available on Linux boards and SITL
+#ifndef SHARED_STATE
+ # define SHARED_STATE DISABLED
+#endif
+
+// guided and RUAS avoidance targets from processes on the same board.
+// Lets any local process steer the vehicle, so it must be asked for.
+// Needs the state export, whose timestamps commands are checked against
+#ifndef SHARED_COMMAND
+ # define SHARED_COMMAND DISABLED
+#endif
+#if SHARED_STATE == DISABLED
+ # undef SHARED_COMMAND
+ # define SHARED_COMMAND DISABLED
+#endif
+#ifndef SHARED_COMMAND_TIMEOUT_MS
+ # define SHARED_COMMAND_TIMEOUT_MS     250     // stop following commands after this long without a new one
+#endif
+#ifndef SHARED_COMMAND_MAX_AGE_US
+ # define SHARED_COMMAND_MAX_AGE_US     50000   // reject commands calculated from state older than this
+#endif
+#ifndef SHARED_COMMAND_SPEED_MAX_CMS
+ # define SHARED_COMMAND_SPEED_MAX_CMS  2000    // reject velocity targets faster than this
+#endif
+#ifndef SHARED_COMMAND_RANGE_MAX_CM
+ # define SHARED_COMMAND_RANGE_MAX_CM   100000  // reject position targets further than this from the vehicle
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 // Nav-Guided - allows external nav computer to control vehicle
 #ifndef NAV_GUIDED
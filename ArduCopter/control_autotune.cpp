@@ -796,6 +796,7 @@ void Copter::autotune_backup_gains_and_initialise()
 //  called by autotune_stop and autotune_failed functions
 void Copter::autotune_load_orig_gains()
 {
+    rate_thread_lock();
     attitude_control.bf_feedforward(orig_bf_feedforward);
     if (autotune_roll_enabled()) {
         if (!is_zero(orig_roll_rp)) {
@@ -825,11 +826,13 @@ void Copter::autotune_load_orig_gains()
             attitude_control.set_accel_yaw_max(orig_yaw_accel);
         }
     }
+    rate_thread_unlock();
 }
 
 // autotune_load_tuned_gains - load tuned gains
 void Copter::autotune_load_tuned_gains()
 {
+    rate_thread_lock();
     if (!attitude_control.get_bf_feedforward()) {
         attitude_control.bf_feedforward(true);
         attitude_control.set_accel_roll_max(0.0f);
@@ -863,12 +866,14 @@ void Copter::autotune_load_tuned_gains()
             attitude_control.set_accel_yaw_max(tune_yaw_accel);
         }
     }
+    rate_thread_unlock();
 }
 
 // autotune_load_intra_test_gains - gains used between tests
 //  called during testing mode's update-gains step to set gains ahead of return-to-level step
 void Copter::autotune_load_intra_test_gains()
 {
+    rate_thread_lock();
     // we are restarting tuning so reset gains to tuning-start gains (i.e. low I term)
     // sanity check the gains
     attitude_control.bf_feedforward(true);
@@ -891,12 +896,14 @@ void Copter::autotune_load_intra_test_gains()
         g.pid_rate_yaw.filt_hz(orig_yaw_rLPF);
         g.p_stabilize_yaw.kP(orig_yaw_sp);
     }
+    rate_thread_unlock();
 }
 
 // autotune_load_twitch_gains - load the to-be-tested gains for a single axis
 // called by autotune_attitude_control() just before it beings testing a gain (i.e. just before it twitches)
 void Copter::autotune_load_twitch_gains()
 {
+    rate_thread_lock();
     switch (autotune_state.axis) {
         case AUTOTUNE_AXIS_ROLL:
             g.pid_rate_roll.kP(tune_roll_rp);
@@ -918,12 +925,14 @@ void Copter::autotune_load_twitch_gains()
             g.p_stabilize_yaw.kP(tune_yaw_sp);
             break;
     }
+    rate_thread_unlock();
 }
 
 // autotune_save_tuning_gains - save the final tuned gains for each axis
 // save discovered gains to eeprom if autotuner is enabled (i.e. switch is in the high position)
 void Copter::autotune_save_tuning_gains()
 {
+    rate_thread_lock();
     // if we successfully completed tuning
     if (autotune_state.mode == AUTOTUNE_MODE_SUCCESS) {
 
@@ -1004,6 +1013,7 @@ void Copter::autotune_save_tuning_gains()
         // reset Autotune so that gains are not saved again and autotune can be run again.
         autotune_state.mode = AUTOTUNE_MODE_UNINITIALISED;
     }
+    rate_thread_unlock();
 }
 
 // autotune_update_gcs - send message to ground station
@@ -32,7 +32,9 @@ void Copter::stabilize_run()
         attitude_control.set_throttle_out_unstabilized(0,true,g.throttle_filt);
         // slow start if landed
         if (ap.land_complete) {
+            rate_thread_lock();
             motors.slow_start(true);
+            rate_thread_unlock();
         }
         return;
     }
@@ -29,7 +29,9 @@ void Copter::throw_exit()
 {
     // If exiting throw mode before commencing flight, restore the throttle interlock to the value last set by the switch
     if (!throw_flight_commenced) {
+        rate_thread_lock();
         motors.set_interlock(throw_early_exit_interlock);
+        rate_thread_unlock();
     }
 }
 
@@ -56,11 +58,13 @@ void Copter::throw_run()
         throw_early_exit_interlock = true;
 
         // prevent motors from rotating before the throw is detected unless enabled by the user
+        rate_thread_lock();
         if (g.throw_motor_start == 1) {
             motors.set_interlock(true);
         } else {
             motors.set_interlock(false);
         }
+        rate_thread_unlock();
 
         // status to let system know flight control has not started which means the interlock setting needs to restored if we exit to another flight mode
         // this is necessary because throw mode uses the interlock to achieve a post arm motor start.
@@ -71,11 +75,13 @@ void Copter::throw_run()
         throw_state = Throw_Detecting;
 
         // prevent motors from rotating before the throw is detected unless enabled by the user
+        rate_thread_lock();
         if (g.throw_motor_start == 1) {
             motors.set_interlock(true);
         } else {
             motors.set_interlock(false);
         }
+        rate_thread_unlock();
 
     } else if (throw_state == Throw_Detecting && throw_detected()){
         gcs_send_text(MAV_SEVERITY_INFO,"throw detected - uprighting");
@@ -85,7 +91,9 @@ void Copter::throw_run()
         AP_Notify::flags.waiting_for_throw = false;
 
         // reset the interlock
+        rate_thread_lock();
         motors.set_interlock(true);
+        rate_thread_unlock();
 
         // status to let system know flight control has started which means the entry interlock setting will not restored if we exit to another flight mode
         throw_flight_commenced = true;
@@ -128,7 +136,9 @@ void Copter::throw_run()
 
         // demand zero throttle (motors will be stopped anyway) and continually reset the attitude controller
         attitude_control.set_throttle_out_unstabilized(0,true,g.throttle_filt);
+        rate_thread_lock();
         motors.slow_start(true);
+        rate_thread_unlock();
 
         break;
 
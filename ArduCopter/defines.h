@@ -272,6 +272,7 @@ enum ThrowModeState {
 #define LOG_GUIDEDTARGET_MSG            0x22
 #define LOG_DETECTION_MSG               0x23    //RUAS
 #define LOG_AVOIDANCE_MSG               0x24    //RUAS
+#define LOG_LATENCY_MSG                 0x25
 
 #define MASK_LOG_ATTITUDE_FAST          (1<<0)
 #define MASK_LOG_ATTITUDE_MED           (1<<1)
@@ -293,6 +294,7 @@ enum ThrowModeState {
 #define MASK_LOG_MOTBATT                (1UL<<17)
 #define MASK_LOG_IMU_FAST               (1UL<<18)
 #define MASK_LOG_IMU_RAW                (1UL<<19)
+#define MASK_LOG_LATENCY                (1UL<<20)
 #define MASK_LOG_ANY                    0xFFFF
 
 // DATA - event logging
@@ -374,6 +376,7 @@ enum ThrowModeState {
 #define ERROR_SUBSYSTEM_BARO                18
 #define ERROR_SUBSYSTEM_CPU                 19
 #define ERROR_SUBSYSTEM_FAILSAFE_ADSB       20
+#define ERROR_SUBSYSTEM_RATE_THREAD         21
 // general error codes
 #define ERROR_CODE_ERROR_RESOLVED           0
 #define ERROR_CODE_FAILED_TO_INITIALISE     1
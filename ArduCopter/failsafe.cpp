@@ -55,19 +55,25 @@ void Copter::failsafe_check()
         // disarm the motors.
         in_failsafe = true;
         // reduce motors to minimum (we do not immediately disarm because we want to log the failure)
-        if (motors.armed()) {
+        if (motors.armed() && rate_thread_trylock()) {
             motors.output_min();
+            rate_thread_unlock();
         }
         // log an error
         Log_Write_Error(ERROR_SUBSYSTEM_CPU,ERROR_CODE_FAILSAFE_OCCURRED);
     }
 
     if (failsafe_enabled && in_failsafe && tnow - failsafe_last_timestamp > 1000000) {
-        // disarm motors every second
+        // disarm motors every second. If the rate loop thread is
+        // mid output try again on the next tick
+        if (!rate_thread_trylock()) {
+            return;
+        }
         failsafe_last_timestamp = tnow;
         if(motors.armed()) {
             motors.armed(false);
             motors.output();
         }
+        rate_thread_unlock();
     }
 }
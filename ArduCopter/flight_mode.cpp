@@ -370,6 +370,14 @@ void Copter::avoidance_maneuver()
   float avoidance_accel_pitch;        // acceleration in pitch for avoidance
   float response;
 
+#if SHARED_COMMAND == ENABLED
+  if (shared_command_state.avoid_override) {
+    // the manoeuvre comes from an offboard planner
+    Log_Write_Avoidance(do_avoid_maneuver, avoidance_roll_angle_cd, avoidance_pitch_angle_cd, do_track_maneuver, trafic_angle * g.acro_yaw_p);
+    return;
+  }
+#endif
+
 
   if(abs(_trafic_angle) < 70 && _trafic_distance > 50 && _trafic_distance < 1000 ) {
     do_track_maneuver = true;
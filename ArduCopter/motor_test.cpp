@@ -112,6 +112,10 @@ uint8_t Copter::mavlink_motor_test_start(mavlink_channel_t chan, uint8_t motor_s
 
             // enable and arm motors
             if (!motors.armed()) {
+#if RATE_THREAD == ENABLED
+                // the test drives the motors from fast_loop
+                rate_thread_pause();
+#endif
                 init_rc_out();
                 enable_motor_output();
                 motors.armed(true);
@@ -154,6 +158,10 @@ void Copter::motor_test_stop()
     // disarm motors
     motors.armed(false);
 
+#if RATE_THREAD == ENABLED
+    rate_thread_resume();
+#endif
+
     // reset timeout
     motor_test_start_ms = 0;
     motor_test_timeout_ms = 0;
@@ -184,11 +184,11 @@ bool Copter::init_arm_motors(bool arming_from_gcs)
     // short delay to allow reading of rc inputs
     delay(30);
 
-    // enable output to motors
+    // enable output to motors and finally actually arm them
+    rate_thread_lock();
     enable_motor_output();
-
-    // finally actually arm the motors
     motors.armed(true);
+    rate_thread_unlock();
 
     // log arming to dataflash
     Log_Write_Event(DATA_ARMED);
@@ -240,7 +240,9 @@ void Copter::init_disarm_motors()
     Log_Write_Event(DATA_DISARMED);
 
     // send disarm command to motors
+    rate_thread_lock();
     motors.armed(false);
+    rate_thread_unlock();
 
     // reset the mission
     mission.reset();
@@ -23,7 +23,9 @@ void Copter::read_barometer(void)
     baro_alt = barometer.get_altitude() * 100.0f;
     baro_climbrate = barometer.get_climb_rate() * 100.0f;
 
+    rate_thread_lock();
     motors.set_air_density_ratio(barometer.get_air_density_ratio());
+    rate_thread_unlock();
 }
 
 #if CONFIG_SONAR == ENABLED
@@ -148,12 +150,14 @@ void Copter::read_battery(void)
     }
 
     // update motors with voltage and current
+    rate_thread_lock();
     if (battery.get_type() != AP_BattMonitor::BattMonitor_TYPE_NONE) {
         motors.set_voltage(battery.voltage());
     }
     if (battery.has_current()) {
         motors.set_current(battery.current_amps());
     }
+    rate_thread_unlock();
 
     // check for low voltage or current if the low voltage check hasn't already been triggered
     // we only check when we're not powered by USB to avoid false alarms during bench tests
@@ -0,0 +1,151 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+#include "Copter.h"
+
+#if SHARED_COMMAND == ENABLED
+
+/*
+  guided and RUAS avoidance targets from companion processes on the
+  same board through AP_SharedCommand. This is the shared memory
+  equivalent of SET_POSITION_TARGET_LOCAL_NED, without the link
+  latency, for offboard control loops running at 100Hz and above
+ */
+
+void Copter::shared_command_init()
+{
+    char name[AP_SHARED_OBJECT_NAME_MAX];
+    snprintf(name, sizeof(name), AP_SHARED_COMMAND_NAME "_%u", (unsigned)g.sysid_this_mav);
+    if (shared_command.init(name)) {
+        hal.console->printf("Shared command input at %s\n", name);
+    }
+}
+
+// shared_command_update - act on any new command and stop following
+// commands that have stopped arriving. Called every fast loop
+void Copter::shared_command_update()
+{
+    struct ap_shared_command cmd;
+    if (shared_command.read(cmd)) {
+        if (shared_command_handle(cmd)) {
+            shared_command.accept(cmd);
+        } else {
+            shared_command.reject();
+        }
+    }
+
+    shared_command_check_timeout();
+}
+
+// shared_command_handle - validate a command and pass it on. Returns
+// false if it was not used
+bool Copter::shared_command_handle(const struct ap_shared_command &cmd)
+{
+    // must have been calculated from recent state of this boot
+    const uint64_t now_us = AP_HAL::micros64();
+    if (cmd.state_time_us > now_us || now_us - cmd.state_time_us > SHARED_COMMAND_MAX_AGE_US) {
+        return false;
+    }
+
+    if (cmd.type == AP_SHARED_COMMAND_AVOIDANCE) {
+        // only AUTO_RUAS flies the avoidance manoeuvre
+        if (control_mode != AUTO_RUAS) {
+            return false;
+        }
+        if (isnan(cmd.avoidance_roll_cd) || isnan(cmd.avoidance_pitch_cd) ||
+            fabsf(cmd.avoidance_roll_cd) > aparm.angle_max ||
+            fabsf(cmd.avoidance_pitch_cd) > aparm.angle_max) {
+            return false;
+        }
+        avoidance_roll_angle_cd = cmd.avoidance_roll_cd;
+        avoidance_pitch_angle_cd = cmd.avoidance_pitch_cd;
+        do_avoid_maneuver = cmd.do_avoid_maneuver;
+        do_track_maneuver = cmd.do_track_maneuver;
+        shared_command_state.avoid_override = true;
+        shared_command_state.avoid_ms = millis();
+        return true;
+    }
+
+    // same modes as SET_POSITION_TARGET_LOCAL_NED
+    if ((control_mode != GUIDED) && !((control_mode == AUTO || control_mode == AUTO_RUAS) && auto_mode == Auto_NavGuided)) {
+        return false;
+    }
+
+    const bool use_pos = (cmd.type == AP_SHARED_COMMAND_POSITION || cmd.type == AP_SHARED_COMMAND_POSVEL);
+    const bool use_vel = (cmd.type == AP_SHARED_COMMAND_VELOCITY || cmd.type == AP_SHARED_COMMAND_POSVEL);
+    if (!use_pos && !use_vel) {
+        return false;
+    }
+    if (cmd.frame > AP_SHARED_COMMAND_FRAME_BODY_OFFSET_NED) {
+        return false;
+    }
+
+    // convert to cm, NEU
+    Vector3f pos_vector(cmd.pos[0] * 100.0f, cmd.pos[1] * 100.0f, -cmd.pos[2] * 100.0f);
+    Vector3f vel_vector(cmd.vel[0] * 100.0f, cmd.vel[1] * 100.0f, -cmd.vel[2] * 100.0f);
+    if ((use_pos && pos_vector.is_nan()) || (use_vel && vel_vector.is_nan())) {
+        return false;
+    }
+    if (use_vel && vel_vector.length() > SHARED_COMMAND_SPEED_MAX_CMS) {
+        return false;
+    }
+
+    if (cmd.frame == AP_SHARED_COMMAND_FRAME_BODY_OFFSET_NED) {
+        rotate_body_frame_to_NE(pos_vector.x, pos_vector.y);
+        rotate_body_frame_to_NE(vel_vector.x, vel_vector.y);
+    }
+    if (use_pos) {
+        if (cmd.frame == AP_SHARED_COMMAND_FRAME_LOCAL_NED) {
+            // convert from alt-above-home to alt-above-ekf-origin
+            pos_vector.z = pv_alt_above_origin(pos_vector.z);
+        } else {
+            pos_vector += inertial_nav.get_position();
+        }
+        if ((pos_vector - inertial_nav.get_position()).length() > SHARED_COMMAND_RANGE_MAX_CM) {
+            return false;
+        }
+    }
+
+    switch (cmd.type) {
+    case AP_SHARED_COMMAND_POSITION:
+        guided_set_destination(pos_vector);
+        break;
+    case AP_SHARED_COMMAND_VELOCITY:
+        guided_set_velocity(vel_vector);
+        break;
+    case AP_SHARED_COMMAND_POSVEL:
+        guided_set_destination_posvel(pos_vector, vel_vector);
+        break;
+    }
+    shared_command_state.guided_type = cmd.type;
+    shared_command_state.guided_ms = millis();
+    return true;
+}
+
+// shared_command_check_timeout - check whether the writer has gone quiet or,
+// for avoidance, the vehicle has left AUTO_RUAS. If so hand avoidance back
+// to the onboard manoeuvre and bring velocity control to a stop. A
+// position target is left in place as the vehicle holds it anyway
+void Copter::shared_command_check_timeout()
+{
+    const uint32_t now = millis();
+
+    if (shared_command_state.avoid_override &&
+        (control_mode != AUTO_RUAS || now - shared_command_state.avoid_ms > SHARED_COMMAND_TIMEOUT_MS)) {
+        shared_command_state.avoid_override = false;
+        do_avoid_maneuver = false;
+        do_track_maneuver = false;
+        gcs_send_text(MAV_SEVERITY_WARNING, "Offboard avoidance timeout");
+    }
+
+    if (shared_command_state.guided_type != AP_SHARED_COMMAND_NONE &&
+        now - shared_command_state.guided_ms > SHARED_COMMAND_TIMEOUT_MS) {
+        if (shared_command_state.guided_type != AP_SHARED_COMMAND_POSITION &&
+            (control_mode == GUIDED || ((control_mode == AUTO || control_mode == AUTO_RUAS) && auto_mode == Auto_NavGuided))) {
+            guided_set_velocity(Vector3f());
+        }
+        shared_command_state.guided_type = AP_SHARED_COMMAND_NONE;
+        gcs_send_text(MAV_SEVERITY_WARNING, "Offboard guided timeout");
+    }
+}
+
+#endif // SHARED_COMMAND
@@ -0,0 +1,76 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+#include "Copter.h"
+
+#if SHARED_STATE == ENABLED
+
+/*
+  export of fast loop state to companion processes on the same board
+  through AP_SharedState
+ */
+
+static void copy_vector(float dest[3], const Vector3f &v)
+{
+    dest[0] = v.x;
+    dest[1] = v.y;
+    dest[2] = v.z;
+}
+
+void Copter::shared_state_init()
+{
+    char name[AP_SHARED_OBJECT_NAME_MAX];
+    snprintf(name, sizeof(name), AP_SHARED_STATE_NAME "_%u", (unsigned)g.sysid_this_mav);
+    if (shared_state.init(name)) {
+        hal.console->printf("Shared state export at %s\n", name);
+    }
+}
+
+// shared_state_update - publish the state of this fast loop. Called at
+// the end of fast_loop so targets are the ones just calculated
+void Copter::shared_state_update()
+{
+    if (!shared_state.enabled()) {
+        return;
+    }
+
+    struct ap_shared_state s;
+    memset(&s, 0, sizeof(s));
+
+    s.time_us = AP_HAL::micros64();
+    s.control_mode = control_mode;
+    s.armed = motors.armed();
+    s.land_complete = ap.land_complete;
+    s.home_state = ap.home_state;
+
+    s.filter_status = inertial_nav.get_filter_status().value;
+
+    s.attitude[0] = ahrs.roll;
+    s.attitude[1] = ahrs.pitch;
+    s.attitude[2] = ahrs.yaw;
+    copy_vector(s.gyro, ahrs.get_gyro());
+    copy_vector(s.accel_ef, ahrs.get_accel_ef_blended());
+
+    s.lat = inertial_nav.get_latitude();
+    s.lng = inertial_nav.get_longitude();
+    copy_vector(s.position, inertial_nav.get_position());
+    copy_vector(s.velocity, inertial_nav.get_velocity());
+
+    copy_vector(s.pos_target, pos_control.get_pos_target());
+    copy_vector(s.vel_target, pos_control.get_vel_target());
+    copy_vector(s.accel_target, pos_control.get_accel_target());
+    copy_vector(s.att_target, attitude_control.get_att_target_euler_cd());
+
+    copy_vector(s.rel_d, rel_d);
+    copy_vector(s.rel_v, rel_v);
+    copy_vector(s.rel_d_filt, _rel_d);
+    copy_vector(s.rel_v_filt, _rel_v);
+    s.detect_health = detect_health;
+    s.avoidance_roll_cd = avoidance_roll_angle_cd;
+    s.avoidance_pitch_cd = avoidance_pitch_angle_cd;
+    s.do_avoid_maneuver = do_avoid_maneuver;
+    s.do_track_maneuver = do_track_maneuver;
+
+    shared_state.publish(s);
+}
+
+#endif // SHARED_STATE
@@ -565,7 +565,9 @@ void Copter::do_aux_switch_function(int8_t ch_function, uint8_t ch_flag)
         case AUXSW_MOTOR_INTERLOCK:
             // Turn on when above LOW, because channel will also be used for speed
             // control signal in tradheli
+            rate_thread_lock();
             motors.set_interlock(ch_flag == AUX_SWITCH_HIGH || ch_flag == AUX_SWITCH_MIDDLE);
+            rate_thread_unlock();
 
             // remember the current value of the motor interlock so that this condition can be restored if we exit the throw mode early
             throw_early_exit_interlock = motors.get_interlock();
@@ -57,10 +57,12 @@ void Copter::run_cli(AP_HAL::UARTDriver *port)
     failsafe_disable();
 
     // cut the engines
+    rate_thread_lock();
     if(motors.armed()) {
         motors.armed(false);
         motors.output();
     }
+    rate_thread_unlock();
 
     while (1) {
         main_menu.run();
@@ -285,6 +287,18 @@ void Copter::init_ardupilot()
     ins.set_raw_logging(should_log(MASK_LOG_IMU_RAW));
     ins.set_dataflash(&DataFlash);
 
+#if RATE_THREAD == ENABLED
+    // move the rate controllers onto their own thread if the board can
+    rate_thread_init();
+#endif
+
+#if SHARED_STATE == ENABLED
+    shared_state_init();
+#endif
+#if SHARED_COMMAND == ENABLED
+    shared_command_init();
+#endif
+
     cliSerial->print("\nReady to FLY ");
 
     // flag that initialisation has completed
@@ -24,6 +24,9 @@ void Copter::tuning() {
 
     Log_Write_Parameter_Tuning(g.radio_tuning, tuning_value, g.rc_6.control_in, g.radio_tuning_low, g.radio_tuning_high);
 
+    // the rate gains and motors are used by the rate loop thread
+    rate_thread_lock();
+
     switch(g.radio_tuning) {
 
     // Roll, Pitch tuning
@@ -212,4 +215,6 @@ void Copter::tuning() {
          g.pid_rate_yaw.filt_hz(tuning_value);
          break;
     }
+
+    rate_thread_unlock();
 }
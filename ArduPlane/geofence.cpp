@@ -39,6 +39,8 @@ static struct GeofenceState {
     int32_t guided_lng;
     /* point 0 is the return point */
     Vector2l *boundary;
+    /* index of boundary[1..], built on load */
+    PolygonIndex *boundary_index;
 } *geofence_state;
 
 
@@ -124,6 +126,9 @@ void Plane::geofence_load(void)
         geofence_state->boundary[i] = get_fence_point_with_index(i);
     }
     geofence_state->num_points = i;
+    if (geofence_state->boundary_index != NULL) {
+        geofence_state->boundary_index->clear();
+    }
 
     if (!Polygon_complete(&geofence_state->boundary[1], geofence_state->num_points-1)) {
         // first point and last point must be the same
@@ -134,6 +139,16 @@ void Plane::geofence_load(void)
         goto failed;
     }
 
+    // index the boundary for the checks in geofence_check(). Large
+    // fences are slow to test point by point, but small ones work
+    // fine without the index if there is no memory for it
+    if (geofence_state->boundary_index == NULL) {
+        geofence_state->boundary_index = new PolygonIndex;
+    }
+    if (geofence_state->boundary_index != NULL) {
+        geofence_state->boundary_index->build(&geofence_state->boundary[1], geofence_state->num_points-1);
+    }
+
     geofence_state->boundary_uptodate = true;
     geofence_state->fence_triggered = false;
 
@@ -325,7 +340,11 @@ void Plane::geofence_check(bool altitude_check_only)
         Vector2l location;
         location.x = loc.lat;
         location.y = loc.lng;
-        outside = Polygon_outside(location, &geofence_state->boundary[1], geofence_state->num_points-1);
+        if (geofence_state->boundary_index != NULL && geofence_state->boundary_index->built()) {
+            outside = geofence_state->boundary_index->outside(location);
+        } else {
+            outside = Polygon_outside(location, &geofence_state->boundary[1], geofence_state->num_points-1);
+        }
         if (outside) {
             breach_type = FENCE_BREACH_BOUNDARY;
         }
@@ -44,6 +44,7 @@ void MsgHandler::init_field_types()
     add_field_type('M', sizeof(uint8_t));
     add_field_type('N', sizeof(char[16]));
     add_field_type('Z', sizeof(char[64]));
+    add_field_type('a', sizeof(int16_t[32]));
     add_field_type('q', sizeof(int64_t));
     add_field_type('Q', sizeof(uint64_t));
 }
@@ -116,6 +116,10 @@ class sitl(Board):
         env.LIB += [
             'm',
         ]
+        if sys.platform.startswith('linux'):
+            env.LIB += [
+                'rt',
+            ]
         env.LINKFLAGS += ['-pthread',]
         env.AP_LIBRARIES += [
             'AP_HAL_SITL',
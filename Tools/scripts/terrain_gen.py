@@ -0,0 +1,217 @@
+#!/usr/bin/env python
+'''
+pre-build AP_Terrain degree files (NxxExxx.DAT) for a region
+
+This fills every grid_block of the degree files covering the given
+area from SRTM data, so a vehicle flying in that area finds all
+terrain data on disk (or in its memory mapped degree files) and never
+needs to request terrain from the GCS. Copy the resulting files into
+the board's terrain directory, eg. /var/APM/terrain on Linux boards.
+
+The block layout, SW corner positions and file offsets must match
+libraries/AP_Terrain exactly, so the float32 arithmetic of the
+vehicle code is reproduced here.
+'''
+
+import sys, os, math, struct
+
+from optparse import OptionParser
+parser = OptionParser("terrain_gen.py [options]")
+parser.add_option("--lat", type='float', default=None, help="center latitude")
+parser.add_option("--lon", type='float', default=None, help="center longitude")
+parser.add_option("--radius", type='float', default=50, help="radius in km")
+parser.add_option("--spacing", type='int', default=100, help="grid spacing in meters (TERRAIN_SPACING)")
+parser.add_option("--directory", default="terrain", help="output directory")
+parser.add_option("--offline", action='store_true', default=False, help="only use already downloaded SRTM tiles")
+
+(opts, args) = parser.parse_args()
+
+if opts.lat is None or opts.lon is None:
+    print("Usage: terrain_gen.py --lat LAT --lon LON [options]")
+    sys.exit(1)
+
+try:
+    from MAVProxy.modules.mavproxy_map import srtm
+except ImportError:
+    print("terrain_gen.py needs the MAVProxy SRTM module, install MAVProxy")
+    sys.exit(1)
+
+# these must match AP_Terrain.h
+TERRAIN_GRID_MAVLINK_SIZE = 4
+TERRAIN_GRID_BLOCK_MUL_X = 7
+TERRAIN_GRID_BLOCK_MUL_Y = 8
+TERRAIN_GRID_BLOCK_SPACING_X = (TERRAIN_GRID_BLOCK_MUL_X-1)*TERRAIN_GRID_MAVLINK_SIZE
+TERRAIN_GRID_BLOCK_SPACING_Y = (TERRAIN_GRID_BLOCK_MUL_Y-1)*TERRAIN_GRID_MAVLINK_SIZE
+TERRAIN_GRID_BLOCK_SIZE_X = TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X
+TERRAIN_GRID_BLOCK_SIZE_Y = TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y
+TERRAIN_GRID_FORMAT_VERSION = 1
+IO_BLOCK_SIZE = 2048
+
+# these must match AP_Math/location.cpp
+LOCATION_SCALING_FACTOR = 0.011131884502145034
+LOCATION_SCALING_FACTOR_INV = 89.83204953368922
+
+
+def f32(v):
+    '''round to a C float'''
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def trunc32(v):
+    '''C conversion of a float to int32_t'''
+    return int(v)
+
+
+def longitude_scale(lat):
+    '''as longitude_scale() for HAL_CPU_CLASS_150 and above'''
+    x = f32(f32(lat) * f32(1.0e-7))
+    scale = f32(math.cos(f32(x * (math.pi / 180.0))))
+    return min(max(scale, f32(0.01)), 1.0)
+
+
+def location_offset(lat, lon, ofs_north, ofs_east):
+    '''as location_offset(), returns new (lat, lon)'''
+    if ofs_north == 0 and ofs_east == 0:
+        return (lat, lon)
+    dlat = trunc32(f32(ofs_north * f32(LOCATION_SCALING_FACTOR_INV)))
+    dlng = trunc32(f32(f32(ofs_east * f32(LOCATION_SCALING_FACTOR_INV)) / longitude_scale(lat)))
+    return (lat + dlat, lon + dlng)
+
+
+def location_diff(lat1, lon1, lat2, lon2):
+    '''as location_diff(), returns (north, east)'''
+    north = f32(f32(lat2 - lat1) * f32(LOCATION_SCALING_FACTOR))
+    east = f32(f32(f32(lon2 - lon1) * f32(LOCATION_SCALING_FACTOR)) * longitude_scale(lat1))
+    return (north, east)
+
+
+def east_blocks(lat_degrees, lon_degrees, spacing):
+    '''as AP_Terrain::east_blocks()'''
+    lat1 = lat_degrees*10*1000*1000
+    lon1 = lon_degrees*10*1000*1000
+    (lat2, lon2) = location_offset(lat1, (lon_degrees+1)*10*1000*1000,
+                                   0, f32(2*spacing*TERRAIN_GRID_BLOCK_SIZE_Y))
+    (north, east) = location_diff(lat1, lon1, lat2, lon2)
+    return int(f32(east / f32(spacing*TERRAIN_GRID_BLOCK_SIZE_Y)))
+
+
+def crc16_ccitt(buf):
+    '''as crc16_ccitt() with an initial crc of 0'''
+    crc = 0
+    for b in bytearray(buf):
+        crc ^= b << 8
+        for i in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def pack_block(bitmap, lat, lon, crc, spacing, heights, grid_idx_x, grid_idx_y, lat_degrees, lon_degrees):
+    '''pack a struct grid_block'''
+    return (struct.pack('<QiiHHH', bitmap, lat, lon, crc, TERRAIN_GRID_FORMAT_VERSION, spacing) +
+            struct.pack('<%uh' % len(heights), *heights) +
+            struct.pack('<HHhb', grid_idx_x, grid_idx_y, lon_degrees, lat_degrees))
+
+
+def get_height(downloader, lat, lon):
+    '''get SRTM height in meters at a position in degrees'''
+    tile = downloader.getTile(int(math.floor(lat)), int(math.floor(lon)))
+    while tile == 0:
+        if opts.offline:
+            raise RuntimeError("no SRTM tile for %.2f %.2f" % (lat, lon))
+        # tile is being downloaded
+        import time
+        time.sleep(0.2)
+        tile = downloader.getTile(int(math.floor(lat)), int(math.floor(lon)))
+    alt = tile.getAltitudeFromLatLon(lat, lon)
+    if alt is None:
+        alt = 0
+    return int(round(alt))
+
+
+def make_block(downloader, lat_degrees, lon_degrees, grid_idx_x, grid_idx_y, spacing):
+    '''create a full grid_block, returns (lat, lon, bytes)'''
+    ref_lat = lat_degrees*10*1000*1000
+    ref_lon = lon_degrees*10*1000*1000
+    (lat, lon) = location_offset(ref_lat, ref_lon,
+                                 f32(grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * f32(spacing)),
+                                 f32(grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * f32(spacing)))
+    heights = []
+    for x in range(TERRAIN_GRID_BLOCK_SIZE_X):
+        for y in range(TERRAIN_GRID_BLOCK_SIZE_Y):
+            (plat, plon) = location_offset(lat, lon, f32(x*spacing), f32(y*spacing))
+            heights.append(get_height(downloader, plat*1.0e-7, plon*1.0e-7))
+    bitmap = (1 << (TERRAIN_GRID_BLOCK_MUL_X*TERRAIN_GRID_BLOCK_MUL_Y)) - 1
+    block = pack_block(bitmap, lat, lon, 0, spacing, heights, grid_idx_x, grid_idx_y, lat_degrees, lon_degrees)
+    crc = crc16_ccitt(block)
+    block = pack_block(bitmap, lat, lon, crc, spacing, heights, grid_idx_x, grid_idx_y, lat_degrees, lon_degrees)
+    return (lat, lon, block + b'\0' * (IO_BLOCK_SIZE - len(block)))
+
+
+def degree_file_name(lat_degrees, lon_degrees):
+    '''name of a degree file, as AP_Terrain::open_file()'''
+    return "%c%02u%c%03u.DAT" % ('S' if lat_degrees < 0 else 'N', abs(lat_degrees),
+                                 'W' if lon_degrees < 0 else 'E', abs(lon_degrees))
+
+
+def build_degree(downloader, lat_degrees, lon_degrees, min_lat, max_lat, min_lon, max_lon, spacing):
+    '''fill all blocks of one degree file that overlap the region'''
+    path = os.path.join(opts.directory, degree_file_name(lat_degrees, lon_degrees))
+    if os.path.exists(path):
+        f = open(path, 'r+b')
+    else:
+        f = open(path, 'w+b')
+    east = east_blocks(lat_degrees, lon_degrees, spacing)
+    block_lat_span = TERRAIN_GRID_BLOCK_SIZE_X * spacing / (LOCATION_SCALING_FACTOR * 1.0e7)
+    count = 0
+    grid_idx_x = 0
+    while True:
+        (lat, lon) = location_offset(lat_degrees*10*1000*1000, lon_degrees*10*1000*1000,
+                                     f32(grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * f32(spacing)), 0)
+        if lat >= (lat_degrees+1)*10*1000*1000 or lat*1.0e-7 > max_lat:
+            break
+        if lat*1.0e-7 + block_lat_span < min_lat:
+            grid_idx_x += 1
+            continue
+        grid_idx_y = 0
+        while True:
+            (lat, lon) = location_offset(lat_degrees*10*1000*1000, lon_degrees*10*1000*1000,
+                                         f32(grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * f32(spacing)),
+                                         f32(grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * f32(spacing)))
+            if lon >= (lon_degrees+1)*10*1000*1000 or lon*1.0e-7 > max_lon:
+                break
+            block_lon_span = block_lat_span * TERRAIN_GRID_BLOCK_SIZE_Y / TERRAIN_GRID_BLOCK_SIZE_X / longitude_scale(lat)
+            if lon*1.0e-7 + block_lon_span >= min_lon:
+                (blat, blon, block) = make_block(downloader, lat_degrees, lon_degrees, grid_idx_x, grid_idx_y, spacing)
+                f.seek((east * grid_idx_x + grid_idx_y) * IO_BLOCK_SIZE)
+                f.write(block)
+                count += 1
+            grid_idx_y += 1
+        grid_idx_x += 1
+    f.close()
+    print("%s: %u blocks" % (path, count))
+
+
+def build_region():
+    '''build all degree files covering the region'''
+    if not os.path.exists(opts.directory):
+        os.makedirs(opts.directory)
+
+    downloader = srtm.SRTMDownloader(offline=(1 if opts.offline else 0))
+    downloader.loadFileList()
+
+    radius_deg = opts.radius * 1000.0 / (LOCATION_SCALING_FACTOR * 1.0e7)
+    min_lat = opts.lat - radius_deg
+    max_lat = opts.lat + radius_deg
+    lon_radius = radius_deg / max(math.cos(math.radians(opts.lat)), 0.01)
+    min_lon = opts.lon - lon_radius
+    max_lon = opts.lon + lon_radius
+
+    for lat_degrees in range(int(math.floor(min_lat)), int(math.floor(max_lat))+1):
+        for lon_degrees in range(int(math.floor(min_lon)), int(math.floor(max_lon))+1):
+            build_degree(downloader, lat_degrees, lon_degrees,
+                         min_lat, max_lat, min_lon, max_lon, opts.spacing)
+
+build_region()
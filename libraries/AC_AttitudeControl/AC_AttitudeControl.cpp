@@ -77,15 +77,40 @@ void AC_AttitudeControl::set_dt(float delta_sec)
     _pid_rate_yaw.set_dt(_dt);
 }
 
+void AC_AttitudeControl::set_rate_dt(float delta_sec)
+{
+    _pid_rate_roll.set_dt(delta_sec);
+    _pid_rate_pitch.set_dt(delta_sec);
+    _pid_rate_yaw.set_dt(delta_sec);
+}
+
+void AC_AttitudeControl::apply_rate_thread_request(const rate_thread_request& request)
+{
+    if (request.relax_count != _rate_relax_applied) {
+        _pid_rate_roll.reset_I();
+        _pid_rate_pitch.reset_I();
+        _pid_rate_yaw.reset_I();
+        _rate_relax_applied = request.relax_count;
+    }
+    _motors.set_stabilizing(request.stabilizing);
+    _motors.set_throttle_filter_cutoff(request.throttle_filter_cutoff);
+    _motors.set_throttle(request.throttle);
+}
+
 void AC_AttitudeControl::relax_bf_rate_controller()
 {
     // Set reference angular velocity used in angular velocity controller equal
     // to the input angular velocity and reset the angular velocity integrators.
     // This zeros the output of the angular velocity controller.
     _ang_vel_target_rads = _ahrs.get_gyro();
-    _pid_rate_roll.reset_I();
-    _pid_rate_pitch.reset_I();
-    _pid_rate_yaw.reset_I();
+    if (_rate_thread_requests) {
+        // the rate loop thread resets its integrators when it sees the count change
+        _rate_thread_request.relax_count++;
+    } else {
+        _pid_rate_roll.reset_I();
+        _pid_rate_pitch.reset_I();
+        _pid_rate_yaw.reset_I();
+    }
 
     // Write euler derivatives derived from vehicle angular velocity to
     // _att_target_euler_rate_rads. This resets the state of the input shapers.
@@ -382,9 +407,14 @@ void AC_AttitudeControl::attitude_controller_run_quat(const Quaternion& att_targ
 
 void AC_AttitudeControl::rate_controller_run()
 {
-    _motors.set_roll(rate_bf_to_motor_roll(_ang_vel_target_rads.x));
-    _motors.set_pitch(rate_bf_to_motor_pitch(_ang_vel_target_rads.y));
-    _motors.set_yaw(rate_bf_to_motor_yaw(_ang_vel_target_rads.z));
+    rate_controller_run_gyro(_ang_vel_target_rads, _ahrs.get_gyro());
+}
+
+void AC_AttitudeControl::rate_controller_run_gyro(const Vector3f& ang_vel_target_rads, const Vector3f& gyro_rads)
+{
+    _motors.set_roll(rate_bf_to_motor_roll(ang_vel_target_rads.x, gyro_rads.x));
+    _motors.set_pitch(rate_bf_to_motor_pitch(ang_vel_target_rads.y, gyro_rads.y));
+    _motors.set_yaw(rate_bf_to_motor_yaw(ang_vel_target_rads.z, gyro_rads.z));
 }
 
 void AC_AttitudeControl::euler_rate_to_ang_vel(const Vector3f& euler_rad, const Vector3f& euler_rate_rads, Vector3f& ang_vel_rads)
@@ -497,9 +527,8 @@ void AC_AttitudeControl::update_ang_vel_target_from_att_error()
     _ang_vel_target_rads.y += -_att_error_rot_vec_rad.x * _ahrs.get_gyro().z;
 }
 
-float AC_AttitudeControl::rate_bf_to_motor_roll(float rate_target_rads)
+float AC_AttitudeControl::rate_bf_to_motor_roll(float rate_target_rads, float current_rate_rads)
 {
-    float current_rate_rads = _ahrs.get_gyro().x;
     float rate_error_rads = rate_target_rads - current_rate_rads;
 
     // For legacy reasons, we convert to centi-degrees before inputting to the PID
@@ -520,9 +549,8 @@ float AC_AttitudeControl::rate_bf_to_motor_roll(float rate_target_rads)
     return constrain_float(output, -AC_ATTITUDE_RATE_RP_CONTROLLER_OUT_MAX, AC_ATTITUDE_RATE_RP_CONTROLLER_OUT_MAX);
 }
 
-float AC_AttitudeControl::rate_bf_to_motor_pitch(float rate_target_rads)
+float AC_AttitudeControl::rate_bf_to_motor_pitch(float rate_target_rads, float current_rate_rads)
 {
-    float current_rate_rads = _ahrs.get_gyro().y;
     float rate_error_rads = rate_target_rads - current_rate_rads;
 
     // For legacy reasons, we convert to centi-degrees before inputting to the PID
@@ -543,9 +571,8 @@ float AC_AttitudeControl::rate_bf_to_motor_pitch(float rate_target_rads)
     return constrain_float(output, -AC_ATTITUDE_RATE_RP_CONTROLLER_OUT_MAX, AC_ATTITUDE_RATE_RP_CONTROLLER_OUT_MAX);
 }
 
-float AC_AttitudeControl::rate_bf_to_motor_yaw(float rate_target_rads)
+float AC_AttitudeControl::rate_bf_to_motor_yaw(float rate_target_rads, float current_rate_rads)
 {
-    float current_rate_rads = _ahrs.get_gyro().z;
     float rate_error_rads = rate_target_rads - current_rate_rads;
 
     // For legacy reasons, we convert to centi-degrees before inputting to the PID
@@ -589,15 +616,21 @@ void AC_AttitudeControl::accel_limiting(bool enable_limits)
 void AC_AttitudeControl::set_throttle_out(float throttle_in, bool apply_angle_boost, float filter_cutoff)
 {
     _throttle_in_filt.apply(throttle_in, _dt);
-    _motors.set_stabilizing(true);
-    _motors.set_throttle_filter_cutoff(filter_cutoff);
     if (apply_angle_boost) {
-        _motors.set_throttle(get_boosted_throttle(throttle_in));
+        throttle_in = get_boosted_throttle(throttle_in);
     }else{
-        _motors.set_throttle(throttle_in);
         // Clear angle_boost for logging purposes
         _angle_boost = 0;
     }
+    if (_rate_thread_requests) {
+        _rate_thread_request.stabilizing = true;
+        _rate_thread_request.throttle_filter_cutoff = filter_cutoff;
+        _rate_thread_request.throttle = throttle_in;
+        return;
+    }
+    _motors.set_stabilizing(true);
+    _motors.set_throttle_filter_cutoff(filter_cutoff);
+    _motors.set_throttle(throttle_in);
 }
 
 void AC_AttitudeControl::set_throttle_out_unstabilized(float throttle_in, bool reset_attitude_control, float filter_cutoff)
@@ -607,10 +640,16 @@ void AC_AttitudeControl::set_throttle_out_unstabilized(float throttle_in, bool r
         relax_bf_rate_controller();
         set_yaw_target_to_current_heading();
     }
+    _angle_boost = 0;
+    if (_rate_thread_requests) {
+        _rate_thread_request.stabilizing = false;
+        _rate_thread_request.throttle_filter_cutoff = filter_cutoff;
+        _rate_thread_request.throttle = throttle_in;
+        return;
+    }
     _motors.set_throttle_filter_cutoff(filter_cutoff);
     _motors.set_stabilizing(false);
     _motors.set_throttle(throttle_in);
-    _angle_boost = 0;
 }
 
 float AC_AttitudeControl::sqrt_controller(float error, float p, float second_ord_lim)
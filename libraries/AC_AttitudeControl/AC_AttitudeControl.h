@@ -55,6 +55,9 @@ public:
         _dt(AC_ATTITUDE_400HZ_DT),
         _angle_boost(0),
         _att_ctrl_use_accel_limit(true),
+        _rate_thread_requests(false),
+        _rate_thread_request(),
+        _rate_relax_applied(0),
         _throttle_in_filt(AC_ATTITUDE_CONTROL_ALTHOLD_LEANANGLE_FILT_HZ),
         _ahrs(ahrs),
         _aparm(aparm),
@@ -75,6 +78,27 @@ public:
     // Set_dt - sets time delta in seconds for all controllers (i.e. 100hz = 0.01, 400hz = 0.0025)
     void set_dt(float delta_sec);
 
+    // Sets time delta in seconds for the angular velocity controllers only, for when they run faster than the attitude controller
+    void set_rate_dt(float delta_sec);
+
+    // Throttle and rate controller relax requests held for a rate loop running on another thread
+    struct rate_thread_request {
+        float throttle;
+        float throttle_filter_cutoff;
+        bool stabilizing;
+        uint8_t relax_count;
+    };
+
+    // While enabled, throttle outputs and rate controller relaxes are held in a request for the rate loop
+    // thread to pass to apply_rate_thread_request(), rather than written to the motors and rate PIDs
+    void set_rate_thread_requests(bool enable) { _rate_thread_requests = enable; }
+
+    // Gets the request held since the rate loop thread was last updated
+    const rate_thread_request& get_rate_thread_request() const { return _rate_thread_request; }
+
+    // Applies a request to the motors and rate PIDs. Called by the rate loop thread, or when the rate loop is taken back from it
+    void apply_rate_thread_request(const rate_thread_request& request);
+
     // Gets the roll acceleration limit in centidegrees/s/s
     float get_accel_roll_max() { return _accel_roll_max; }
 
@@ -132,6 +156,10 @@ public:
     // Run angular velocity controller and send outputs to the motors
     virtual void rate_controller_run();
 
+    // Run angular velocity controller on a target and drift corrected gyro sample supplied by the caller and send outputs to the motors
+    // Used to run the rate loop on its own thread at the gyro rate. Not for helicopters, which override rate_controller_run()
+    void rate_controller_run_gyro(const Vector3f& ang_vel_target_rads, const Vector3f& gyro_rads);
+
     // Convert a 321-intrinsic euler angle derivative to an angular velocity vector
     void euler_rate_to_ang_vel(const Vector3f& euler_rad, const Vector3f& euler_rate_rads, Vector3f& ang_vel_rads);
 
@@ -180,6 +208,9 @@ public:
     // Return reference angular velocity used in the angular velocity controller
     Vector3f rate_bf_targets() const { return _ang_vel_target_rads*degrees(100.0f); }
 
+    // Return the angular velocity target in radians/s, as used by the rate controllers
+    const Vector3f& get_ang_vel_target_rads() const { return _ang_vel_target_rads; }
+
     // Enable or disable body-frame feed forward
     void bf_feedforward(bool enable_or_disable) { _rate_bf_ff_enabled = enable_or_disable; }
 
@@ -254,13 +285,13 @@ protected:
     void update_ang_vel_target_from_att_error();
 
     // Run the roll angular velocity PID controller and return the output
-    float rate_bf_to_motor_roll(float rate_target_rads);
+    float rate_bf_to_motor_roll(float rate_target_rads, float current_rate_rads);
 
     // Run the pitch angular velocity PID controller and return the output
-    float rate_bf_to_motor_pitch(float rate_target_rads);
+    float rate_bf_to_motor_pitch(float rate_target_rads, float current_rate_rads);
 
     // Run the yaw angular velocity PID controller and return the output
-    virtual float rate_bf_to_motor_yaw(float rate_target_rads);
+    virtual float rate_bf_to_motor_yaw(float rate_target_rads, float current_rate_rads);
 
     // Compute a throttle value that is adjusted for the tilt angle of the vehicle
     virtual float get_boosted_throttle(float throttle_in) = 0;
@@ -337,6 +368,13 @@ protected:
     // Specifies whether the attitude controller should use the acceleration limit
     bool                _att_ctrl_use_accel_limit;
 
+    // Throttle and relax requests are held for the rate loop thread, see set_rate_thread_requests()
+    bool                _rate_thread_requests;
+    rate_thread_request _rate_thread_request;
+
+    // relax_count of the last request applied by the rate loop thread
+    uint8_t             _rate_relax_applied;
+
     // Filtered throttle input - used to limit lean angle when throttle is saturated
     LowPassFilterFloat  _throttle_in_filt;
 
@@ -337,35 +337,41 @@ void AccelCalibrator::run_fit(uint8_t max_iterations, float& fitness)
     while(num_iterations < max_iterations) {
         float last_fitness = fitness;
 
-        float JTJ[ACCEL_CAL_MAX_NUM_PARAMS*ACCEL_CAL_MAX_NUM_PARAMS] {};
+        const uint8_t num_params = get_num_params();
+        MatrixN<float,ACCEL_CAL_MAX_NUM_PARAMS,ACCEL_CAL_MAX_NUM_PARAMS> JTJ;
         VectorP JTFI;
 
         for(uint16_t k = 0; k<_samples_collected; k++) {
             Vector3f sample;
             get_sample(k, sample);
 
-            VectorN<float,ACCEL_CAL_MAX_NUM_PARAMS> jacob;
+            VectorP jacob;
 
             calc_jacob(sample, fit_param.s, jacob);
-
-            for(uint8_t i = 0; i < get_num_params(); i++) {
-                // compute JTJ
-                for(uint8_t j = 0; j < get_num_params(); j++) {
-                    JTJ[i*get_num_params()+j] += jacob[i] * jacob[j];
-                }
-                // compute JTFI
-                JTFI[i] += jacob[i] * calc_residual(sample, fit_param.s);
+            // parameters past num_params are not fitted
+            for(uint8_t i = num_params; i < ACCEL_CAL_MAX_NUM_PARAMS; i++) {
+                jacob[i] = 0.0f;
             }
+
+            // compute JTJ, upper triangle only as it is symmetric
+            JTJ.add_upper_outer(jacob);
+            // compute JTFI
+            JTFI += jacob * calc_residual(sample, fit_param.s);
         }
 
-        if (!inverse(JTJ, JTJ, get_num_params())) {
+        // give the unfitted parameters a unit diagonal so the fixed
+        // size solve leaves them unchanged
+        for(uint8_t i = num_params; i < ACCEL_CAL_MAX_NUM_PARAMS; i++) {
+            JTJ[i][i] = 1.0f;
+        }
+
+        VectorP step;
+        if (!JTJ.cholesky_solve(JTFI, step)) {
             return;
         }
 
-        for(uint8_t row=0; row < get_num_params(); row++) {
-            for(uint8_t col=0; col < get_num_params(); col++) {
-                fit_param.a[row] -= JTFI[col] * JTJ[row*get_num_params()+col];
-            }
+        for(uint8_t row=0; row < num_params; row++) {
+            fit_param.a[row] -= step[row];
         }
 
         fitness = calc_mean_squared_residuals(fit_param.s);
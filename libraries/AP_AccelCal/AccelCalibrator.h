@@ -16,6 +16,7 @@
 #define __ACCELCALIBRATOR_H__
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
+#include <AP_Math/matrixN.h>
 
 #define ACCEL_CAL_MAX_NUM_PARAMS 9
 #define ACCEL_CAL_TOLERANCE 0.1
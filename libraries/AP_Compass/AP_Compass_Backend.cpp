@@ -28,15 +28,14 @@ AP_Compass_Backend::AP_Compass_Backend(Compass &compass) :
 void AP_Compass_Backend::rotate_field(Vector3f &mag, uint8_t instance)
 {
     Compass::mag_state &state = _compass._state[instance];
-    mag.rotate(MAG_BOARD_ORIENTATION);
 
-    if (!state.external) {
-        // and add in AHRS_ORIENTATION setting if not an external compass
-        mag.rotate(_compass._board_orientation);
-    } else {
-        // add user selectable orientation
-        mag.rotate((enum Rotation)state.orientation.get());
-    }
+    // MAG_BOARD_ORIENTATION, then the AHRS_ORIENTATION setting if not
+    // an external compass, or the user selectable orientation if it
+    // is. The matrix is only rebuilt when one of them changes
+    const enum Rotation orientation = state.external ?
+        (enum Rotation)state.orientation.get() : _compass._board_orientation;
+    state.rotation.set(MAG_BOARD_ORIENTATION, orientation);
+    state.rotation.rotate(mag);
 }
 
 void AP_Compass_Backend::publish_raw_field(const Vector3f &mag, uint32_t time_us, uint8_t instance)
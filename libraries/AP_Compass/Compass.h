@@ -401,6 +401,9 @@ private:
         bool        updated_unfiltered_field;
         Vector3f    raw_field;
         Vector3f    unfiltered_field;
+
+        // combined rotation of the field, see rotate_field()
+        RotationCache rotation;
     } _state[COMPASS_MAX_INSTANCES];
 
     CompassCalibrator _calibrator[COMPASS_MAX_INSTANCES];
@@ -56,6 +56,13 @@
  *
  * The fitting algorithm used is Levenberg-Marquardt. See also:
  * http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm
+ *
+ * On boards with COMPASS_CAL_BACKGROUND_FIT the iterations of each fit step
+ * run on the IO thread rather than in update(). update() hands the step over
+ * once the buffer is full and makes the state transition when the IO thread
+ * reports it complete; each calibrator has its own IO process, so several
+ * compasses are fitted side by side. If the HAL had no room left for the IO
+ * process the fit runs in update() as on other boards.
  */
 
 #include "CompassCalibrator.h"
@@ -71,6 +78,12 @@ CompassCalibrator::CompassCalibrator():
 _tolerance(COMPASS_CAL_DEFAULT_TOLERANCE),
 _sample_buffer(NULL)
 {
+#if COMPASS_CAL_BACKGROUND_FIT
+    _fit_sem = nullptr;
+    _fit_pending = false;
+    _io_running = false;
+    _status_deferred = false;
+#endif
     clear();
 }
 
@@ -79,14 +92,33 @@ void CompassCalibrator::clear() {
 }
 
 void CompassCalibrator::start(bool retry, bool autosave, float delay) {
+#if COMPASS_CAL_BACKGROUND_FIT
+    // a deferred status change is to a stopped state, so a new start
+    // replaces it
+    if(running() && !_status_deferred) {
+        return;
+    }
+#else
     if(running()) {
         return;
     }
+#endif
     _autosave = autosave;
     _attempt = 1;
     _retry = retry;
     _delay_start_sec = delay;
     _start_time_ms = AP_HAL::millis();
+#if COMPASS_CAL_BACKGROUND_FIT
+    if (_fit_sem == nullptr) {
+        _fit_sem = hal.util->new_semaphore();
+        if (_fit_sem != nullptr) {
+            // the HAL drops this when its table of IO processes is
+            // full, in which case io_update() never runs and update()
+            // keeps fitting in the foreground
+            hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&CompassCalibrator::io_update, void));
+        }
+    }
+#endif
     set_status(COMPASS_CAL_WAITING_TO_START);
 }
 
@@ -145,35 +177,51 @@ void CompassCalibrator::new_sample(const Vector3f& sample) {
 void CompassCalibrator::update(bool &failure) {
     failure = false;
 
+#if COMPASS_CAL_BACKGROUND_FIT
+    if (_status_deferred) {
+        // retry the status change now the IO thread may be done
+        _status_deferred = false;
+        set_status(_deferred_status);
+        if (_status_deferred) {
+            return;
+        }
+    }
+#endif
+
     if(!fitting()) {
         return;
     }
 
+#if COMPASS_CAL_BACKGROUND_FIT
+    if (_fit_pending) {
+        // the IO thread is still fitting
+        return;
+    }
+#endif
+
+    if (!fit_step_complete()) {
+#if COMPASS_CAL_BACKGROUND_FIT
+        if (_fit_sem != nullptr && _io_running) {
+            start_background_fit();
+            return;
+        }
+#endif
+        run_fit_step();
+        return;
+    }
+
     if(_status == COMPASS_CAL_RUNNING_STEP_ONE) {
-        if (_fit_step >= 10) {
-            if(is_equal(_fitness,_initial_fitness) || isnan(_fitness)) {           //if true, means that fitness is diverging instead of converging
-                set_status(COMPASS_CAL_FAILED);
-                failure = true;
-            }
-            set_status(COMPASS_CAL_RUNNING_STEP_TWO);
-        } else {
-            run_sphere_fit();
-            _fit_step++;
+        if(is_equal(_fitness,_initial_fitness) || isnan(_fitness)) {           //if true, means that fitness is diverging instead of converging
+            set_status(COMPASS_CAL_FAILED);
+            failure = true;
         }
+        set_status(COMPASS_CAL_RUNNING_STEP_TWO);
     } else if(_status == COMPASS_CAL_RUNNING_STEP_TWO) {
-        if (_fit_step >= 35) {
-            if(fit_acceptable()) {
-                set_status(COMPASS_CAL_SUCCESS);
-            } else {
-                set_status(COMPASS_CAL_FAILED);
-                failure = true;
-            }
-        } else if (_fit_step < 15) {
-            run_sphere_fit();
-            _fit_step++;
+        if(fit_acceptable()) {
+            set_status(COMPASS_CAL_SUCCESS);
         } else {
-            run_ellipsoid_fit();
-            _fit_step++;
+            set_status(COMPASS_CAL_FAILED);
+            failure = true;
         }
     }
 }
@@ -189,6 +237,62 @@ bool CompassCalibrator::fitting() const {
     return running() && _samples_collected == COMPASS_CAL_NUM_SAMPLES;
 }
 
+void CompassCalibrator::run_fit_step() {
+    // step one is a sphere fit, step two refines the sphere before
+    // fitting the full ellipsoid
+    if (_status == COMPASS_CAL_RUNNING_STEP_ONE || _fit_step < 15) {
+        run_sphere_fit();
+    } else {
+        run_ellipsoid_fit();
+    }
+    _fit_step++;
+}
+
+bool CompassCalibrator::fit_step_complete() const {
+    if (_status == COMPASS_CAL_RUNNING_STEP_ONE) {
+        return _fit_step >= 10;
+    }
+    return _fit_step >= 35;
+}
+
+#if COMPASS_CAL_BACKGROUND_FIT
+void CompassCalibrator::start_background_fit() {
+    _fit_pending = true;
+}
+
+bool CompassCalibrator::stop_background_fit() {
+    if (_fit_sem == nullptr || !_fit_pending) {
+        return true;
+    }
+    // the IO thread stops after the current iteration either way
+    _fit_pending = false;
+    // it holds the semaphore for one iteration; don't wait for that
+    if (!_fit_sem->take_nonblocking()) {
+        return false;
+    }
+    _fit_sem->give();
+    return true;
+}
+
+/*
+  run one iteration of a pending fit. Called from the IO thread
+ */
+void CompassCalibrator::io_update() {
+    _io_running = true;
+    if (!_fit_pending || !_fit_sem->take_nonblocking()) {
+        return;
+    }
+    // re-check now we hold the semaphore, the fit may have been stopped
+    if (_fit_pending) {
+        run_fit_step();
+        if (fit_step_complete()) {
+            _fit_pending = false;
+        }
+    }
+    _fit_sem->give();
+}
+#endif
+
 void CompassCalibrator::initialize_fit() {
     //initialize _fitness before starting a fit
     if (_samples_collected != 0) {
@@ -218,6 +322,18 @@ bool CompassCalibrator::set_status(compass_cal_status_t status) {
         return true;
     }
 
+#if COMPASS_CAL_BACKGROUND_FIT
+    // any state change invalidates a fit in progress. If the IO thread
+    // is still using the fit state, make the change from update() once
+    // it has finished the iteration
+    if (!stop_background_fit()) {
+        _deferred_status = status;
+        _status_deferred = true;
+        return true;
+    }
+    _status_deferred = false;
+#endif
+
     switch(status) {
         case COMPASS_CAL_NOT_STARTED:
             reset_state();
@@ -452,53 +568,45 @@ void CompassCalibrator::run_sphere_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS];
+    MatrixN<float,COMPASS_CAL_NUM_SPHERE_PARAMS,COMPASS_CAL_NUM_SPHERE_PARAMS> JTJ;
+    VectorN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> JTFI;
 
-    memset(&JTJ,0,sizeof(JTJ));
-    memset(&JTJ2,0,sizeof(JTJ2));
-    memset(&JTFI,0,sizeof(JTFI));
     // Gauss Newton Part common for all kind of extensions including LM
+    // JTJ is symmetric, so accumulate the upper triangle only
     for(uint16_t k = 0; k<_samples_collected; k++) {
         Vector3f sample = _sample_buffer[k].get();
 
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
+        VectorN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> sphere_jacob;
 
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
+        calc_sphere_jacob(sample, fit1_params, &sphere_jacob[0]);
+        const float residual = calc_residual(sample, fit1_params);
 
-        for(uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for(uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
+        // compute JTJ
+        JTJ.add_upper_outer(sphere_jacob);
+        // compute JTFI
+        JTFI += sphere_jacob * residual;
     }
 
-
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for(uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda/lma_damping;
-    }
-
-    if(!inverse(JTJ, JTJ, 4)) {
+    MatrixN<float,COMPASS_CAL_NUM_SPHERE_PARAMS,COMPASS_CAL_NUM_SPHERE_PARAMS> JTJ2 = JTJ;   //a backup JTJ for LM
+    JTJ.add_diagonal(_sphere_lambda);
+    JTJ2.add_diagonal(_sphere_lambda/lma_damping);
+
+    // the damped JTJ is positive definite, so solve for the steps
+    // directly rather than inverting it
+    VectorN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> step1, step2;
+    if(!JTJ.cholesky_solve(JTFI, step1)) {
         return;
     }
 
-    if(!inverse(JTJ2, JTJ2, 4)) {
+    if(!JTJ2.cholesky_solve(JTFI, step2)) {
         return;
     }
 
     for(uint8_t row=0; row < COMPASS_CAL_NUM_SPHERE_PARAMS; row++) {
-        for(uint8_t col=0; col < COMPASS_CAL_NUM_SPHERE_PARAMS; col++) {
-            fit1_params.get_sphere_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-            fit2_params.get_sphere_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-        }
+        fit1_params.get_sphere_params()[row] -= step1[row];
+        fit2_params.get_sphere_params()[row] -= step2[row];
     }
 
     fit1 = calc_mean_squared_residuals(fit1_params);
@@ -560,61 +668,50 @@ void CompassCalibrator::run_ellipsoid_fit()
 
     const float lma_damping = 10.0f;
 
-
     float fitness = _fitness;
     float fit1, fit2;
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
+    MatrixN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> JTJ;
+    VectorN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> JTFI;
 
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-
-    memset(&JTJ,0,sizeof(JTJ));
-    memset(&JTJ2,0,sizeof(JTJ2));
-    memset(&JTFI,0,sizeof(JTFI));
     // Gauss Newton Part common for all kind of extensions including LM
+    // JTJ is symmetric, so accumulate the upper triangle only
     for(uint16_t k = 0; k<_samples_collected; k++) {
         Vector3f sample = _sample_buffer[k].get();
 
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        VectorN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> ellipsoid_jacob;
 
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
+        calc_ellipsoid_jacob(sample, fit1_params, &ellipsoid_jacob[0]);
+        const float residual = calc_residual(sample, fit1_params);
 
-        for(uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for(uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
+        // compute JTJ
+        JTJ.add_upper_outer(ellipsoid_jacob);
+        // compute JTFI
+        JTFI += ellipsoid_jacob * residual;
     }
 
-
-
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for(uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
-    }
-
-    if(!inverse(JTJ, JTJ, 9)) {
+    MatrixN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> JTJ2 = JTJ;   //a backup JTJ for LM
+    JTJ.add_diagonal(_ellipsoid_lambda);
+    JTJ2.add_diagonal(_ellipsoid_lambda/lma_damping);
+
+    // the damped JTJ is positive definite, so solve for the steps
+    // directly rather than inverting it
+    VectorN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> step1, step2;
+    if(!JTJ.cholesky_solve(JTFI, step1)) {
         return;
     }
 
-    if(!inverse(JTJ2, JTJ2, 9)) {
+    if(!JTJ2.cholesky_solve(JTFI, step2)) {
         return;
     }
 
     for(uint8_t row=0; row < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; row++) {
-        for(uint8_t col=0; col < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; col++) {
-            fit1_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-            fit2_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-        }
+        fit1_params.get_ellipsoid_params()[row] -= step1[row];
+        fit2_params.get_ellipsoid_params()[row] -= step2[row];
     }
 
     fit1 = calc_mean_squared_residuals(fit1_params);
@@ -629,7 +726,7 @@ void CompassCalibrator::run_ellipsoid_fit()
     } else if(fit1 < _fitness){
         fitness = fit1;
     }
-    //--------------------Levenberg-part-ends-here--------------------------------//
+    //--------------------Levenberg-Marquardt-part-ends-here--------------------------------//
 
     if(fitness < _fitness) {
         _fitness = fitness;
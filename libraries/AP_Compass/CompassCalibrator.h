@@ -1,8 +1,21 @@
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+
+/*
+  on faster boards the LM fit runs on the IO thread, one iteration per
+  IO tick, so it no longer costs a main loop slot per iteration and
+  more samples can be used
+ */
+#define COMPASS_CAL_BACKGROUND_FIT (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
 
 #define COMPASS_CAL_NUM_SPHERE_PARAMS 4
 #define COMPASS_CAL_NUM_ELLIPSOID_PARAMS 9
+#if COMPASS_CAL_BACKGROUND_FIT
+#define COMPASS_CAL_NUM_SAMPLES 1000
+#else
 #define COMPASS_CAL_NUM_SAMPLES 300
+#endif
 
 //RMS tolerance
 #define COMPASS_CAL_DEFAULT_TOLERANCE 5.0f
@@ -107,6 +120,32 @@ private:
 
     bool fitting() const;
 
+    // run one LM iteration of the current step, and check if the
+    // step has run all of its iterations
+    void run_fit_step();
+    bool fit_step_complete() const;
+
+#if COMPASS_CAL_BACKGROUND_FIT
+    // hand the remaining iterations of the current step to the IO thread
+    void start_background_fit();
+    // take the fit state back from the IO thread. Returns false if the
+    // IO thread is part way through an iteration
+    bool stop_background_fit();
+    void io_update();
+
+    AP_HAL::Semaphore *_fit_sem;
+    // set by the main thread to hand the fit to the IO thread, cleared
+    // by the IO thread when the step is complete. The main thread does
+    // not touch the fit state while this is set
+    volatile bool _fit_pending;
+    // set once io_update() has been called, so the fit is only handed
+    // over if the IO process was registered
+    volatile bool _io_running;
+    // a status change waiting for the IO thread to finish an iteration
+    bool _status_deferred;
+    compass_cal_status_t _deferred_status;
+#endif
+
     // thins out samples between step one and step two
     void thin_samples();
 
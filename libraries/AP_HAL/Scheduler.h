@@ -43,6 +43,17 @@ public:
     // register a low priority IO task
     virtual void     register_io_process(AP_HAL::MemberProc) = 0;
 
+    /*
+      optional high priority rate loop task. It is run on its own
+      thread each time wake_rate_process() is called, normally from
+      the driver of the primary gyro. Wakeups that arrive while it is
+      running are merged. Returns false if the board has no such
+      thread, in which case the caller should run the work from its
+      main loop
+     */
+    virtual bool     register_rate_process(AP_HAL::MemberProc) { return false; }
+    virtual void     wake_rate_process() {}
+
     // suspend and resume both timer and IO processes
     virtual void     suspend_timer_procs() = 0;
     virtual void     resume_timer_procs() = 0;
@@ -0,0 +1,98 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+namespace AP_HAL {
+
+/*
+  lock free passing of the latest value of a small plain struct from
+  one writer thread to any number of reader threads
+
+  The writer updates the two copies in turn, bumping a sequence number
+  before each one. Readers copy whichever slot the writer is not
+  touching and retry only if the writer moved on to that slot during
+  the copy, so neither side ever waits on the other. This makes it
+  safe between threads of different realtime priorities, where a
+  mutex could leave a high priority reader blocked behind a preempted
+  writer.
+ */
+template <typename T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() : _seq(0), _slot() { }
+
+    // publish a new value. Must only be called from one thread
+    void write(const T &value)
+    {
+        _seq++;
+        __sync_synchronize();
+        _slot[0] = value;
+        __sync_synchronize();
+        _seq++;
+        __sync_synchronize();
+        _slot[1] = value;
+    }
+
+    // get the latest complete value. Returns false if nothing has
+    // been written yet
+    bool read(T &value) const
+    {
+        uint32_t seq;
+        do {
+            seq = _seq;
+            __sync_synchronize();
+            if (seq < 2) {
+                return false;
+            }
+            // an odd sequence means slot 0 is being written
+            value = _slot[seq & 1];
+            __sync_synchronize();
+        } while (seq != _seq);
+        return true;
+    }
+
+    // as read(), but give up after max_tries attempts. For readers
+    // that must not be held up by a writer in another process, which
+    // could be stopped in the middle of a write
+    bool read(T &value, uint8_t max_tries) const
+    {
+        for (uint8_t i = 0; i < max_tries; i++) {
+            const uint32_t seq = _seq;
+            __sync_synchronize();
+            if (seq < 2) {
+                return false;
+            }
+            value = _slot[seq & 1];
+            __sync_synchronize();
+            if (seq == _seq) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // number of writes so far, for readers to tell if there is
+    // anything new
+    uint32_t count() const { return _seq / 2; }
+
+private:
+    volatile uint32_t _seq;
+    T _slot[2];
+};
+
+}
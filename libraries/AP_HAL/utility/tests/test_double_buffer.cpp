@@ -0,0 +1,72 @@
+#include <AP_gtest.h>
+
+#include <pthread.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
+
+struct sample {
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+TEST(DoubleBufferTest, ReadLatest)
+{
+    AP_HAL::DoubleBuffer<sample> buf;
+    sample s;
+
+    EXPECT_FALSE(buf.read(s));
+    EXPECT_EQ(0U, buf.count());
+
+    buf.write(sample{1, 2, 3});
+    ASSERT_TRUE(buf.read(s));
+    EXPECT_EQ(1U, s.a);
+    EXPECT_EQ(3U, s.c);
+
+    buf.write(sample{4, 5, 6});
+    ASSERT_TRUE(buf.read(s));
+    EXPECT_EQ(4U, s.a);
+    EXPECT_EQ(6U, s.c);
+    EXPECT_EQ(2U, buf.count());
+}
+
+static AP_HAL::DoubleBuffer<sample> shared_buf;
+static volatile bool writer_done;
+
+static void *writer(void *)
+{
+    for (uint32_t i = 1; i <= 200000; i++) {
+        shared_buf.write(sample{i, i * 3, i * 7});
+    }
+    writer_done = true;
+    return nullptr;
+}
+
+// a reader racing the writer must never see a mix of two writes
+TEST(DoubleBufferTest, NoTornReads)
+{
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, nullptr, writer, nullptr));
+
+    uint32_t last = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    while (!writer_done) {
+        sample s;
+        if (!shared_buf.read(s)) {
+            continue;
+        }
+        if (s.b != s.a * 3 || s.c != s.a * 7) {
+            torn++;
+        }
+        if (s.a < last) {
+            backwards++;
+        }
+        last = s.a;
+    }
+    pthread_join(thread, nullptr);
+
+    EXPECT_EQ(0U, torn);
+    EXPECT_EQ(0U, backwards);
+}
+
+AP_GTEST_MAIN()
@@ -242,6 +242,11 @@ void _usage(void)
     printf("\t-custom terrain path:\n");
     printf("\t                   --terrain-directory /var/APM/terrain\n");
     printf("\t                   -t /var/APM/terrain\n");
+    printf("\t-thread priority and CPUs, repeatable:\n");
+    printf("\t                   --thread main:15:2\n");
+    printf("\t                   -T timer:20:1,3\n");
+    printf("\t                   (main, timer, uart, rcin, tonealarm, io or rate;\n");
+    printf("\t                    priority 0 keeps the default)\n");
 }
 
 void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
@@ -261,11 +266,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
 #endif
         {"log-directory",       true,  0, 'l'},
         {"terrain-directory",   true,  0, 't'},
+        {"thread",              true,  0, 'T'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:l:t:he:S",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:l:t:T:he:S",
                     options);
 
     /*
@@ -302,6 +308,13 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 't':
             utilInstance.set_custom_terrain_directory(gopt.optarg);
             break;
+        case 'T':
+            if (!schedulerInstance.set_thread_config(gopt.optarg)) {
+                printf("Bad thread configuration '%s'\n", gopt.optarg);
+                _usage();
+                exit(1);
+            }
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -337,7 +350,11 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
     scheduler->system_initialized();
     callbacks->setup();
 
+    // one count per main loop, for its jitter
+    AP_HAL::Util::perf_counter_t perf_loop = util->perf_alloc(AP_HAL::Util::PC_INTERVAL, "main-loop");
+
     for (;;) {
+        util->perf_count(perf_loop);
         callbacks->loop();
     }
 }
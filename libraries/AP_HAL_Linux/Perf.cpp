@@ -20,8 +20,13 @@
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX && !defined(PERF_LTTNG)
 
+#include <fcntl.h>
 #include <limits.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <AP_Math/AP_Math.h>
 
@@ -30,9 +35,13 @@
 
 using namespace Linux;
 
+// jitter histogram buckets, see perf_counter_interval_t
+#define PERF_INTERVAL_BUCKETS 16
+
 struct perf_counter_base_t {
     const char *name;
     enum Util::perf_counter_type type;
+    struct perf_counter_base_t *next;
 };
 
 struct perf_counter_count_t {
@@ -52,8 +61,32 @@ struct perf_counter_elapsed_t {
     double m2;
 };
 
+/*
+ * Intervals between calls to perf_count(), e.g. thread wakeups. Besides
+ * the mean and variance, keeps a histogram of the jitter: the distance
+ * of each interval from the mean so far. Bucket 0 counts jitter below
+ * 1us and bucket i jitter in [2^(i-1), 2^i) us, with the last bucket
+ * also counting anything larger.
+ */
+struct perf_counter_interval_t {
+    struct perf_counter_base_t base;
+    uint64_t count;
+    /* Everything below is in nanoseconds */
+    uint64_t last;
+    uint64_t least;
+    uint64_t most;
+    double mean;
+    double m2;
+    uint32_t jitter[PERF_INTERVAL_BUCKETS];
+};
+
 static const AP_HAL::HAL& hal = AP_HAL::get_HAL();
 
+// all counters, newest first, for perf_dump_tick()
+static struct perf_counter_base_t *perf_counters;
+
+static volatile sig_atomic_t perf_dump_requested;
+
 Util::perf_counter_t Util::perf_alloc(perf_counter_type type, const char *name)
 {
     struct perf_counter_base_t *base;
@@ -81,19 +114,26 @@ Util::perf_counter_t Util::perf_alloc(perf_counter_type type, const char *name)
         base = &elapsed->base;
         break;
     }
-    default:
     case PC_INTERVAL: {
-        /*
-         * Not implemented now because it is not used even on PX4 specific
-         * code and by looking at PX4 implementation without perf_reset()
-         * the average is broken.
-         */
-        return nullptr;
+        struct perf_counter_interval_t *interval;
+        interval = (struct perf_counter_interval_t *)calloc(1, sizeof(struct perf_counter_interval_t));
+        if (!interval) {
+            return nullptr;
+        }
+
+        interval->least = ULONG_MAX;
+
+        base = &interval->base;
+        break;
     }
+    default:
+        return nullptr;
     }
 
     base->name = name;
     base->type = type;
+    base->next = perf_counters;
+    perf_counters = base;
     return (perf_counter_t)base;
 }
 
@@ -168,6 +208,45 @@ void Util::perf_end(perf_counter_t perf)
     perf_elapsed->start = 0;
 }
 
+static void perf_count_interval(struct perf_counter_interval_t *perf_interval)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t now = timespec_to_nsec(&ts);
+
+    if (perf_interval->last == 0) {
+        perf_interval->last = now;
+        return;
+    }
+    const uint64_t interval = now - perf_interval->last;
+    perf_interval->last = now;
+
+    perf_interval->count++;
+
+    if (perf_interval->least > interval) {
+        perf_interval->least = interval;
+    }
+
+    if (perf_interval->most < interval) {
+        perf_interval->most = interval;
+    }
+
+    // jitter against the mean of the intervals before this one
+    if (perf_interval->count > 1) {
+        const uint64_t jitter_usec = fabs(interval - perf_interval->mean) / 1000;
+        uint8_t bucket = 0;
+        while (bucket < PERF_INTERVAL_BUCKETS - 1 && jitter_usec >= (1ULL << bucket)) {
+            bucket++;
+        }
+        perf_interval->jitter[bucket]++;
+    }
+
+    /* Same recursive mean and variance as PC_ELAPSED */
+    const double delta_intvl = interval - perf_interval->mean;
+    perf_interval->mean += (delta_intvl / perf_interval->count);
+    perf_interval->m2 += (delta_intvl * (interval - perf_interval->mean));
+}
+
 void Util::perf_count(perf_counter_t perf)
 {
     struct perf_counter_count_t *perf_counter = (struct perf_counter_count_t *)perf;
@@ -176,9 +255,14 @@ void Util::perf_count(perf_counter_t perf)
         return;
     }
 
+    if (perf_counter->base.type == PC_INTERVAL) {
+        perf_count_interval((struct perf_counter_interval_t *)perf);
+        return;
+    }
+
     if (perf_counter->base.type != PC_COUNT) {
         hal.console->printf("perf_count() called over a perf_counter_t(%s) "
-                            "that is not of the PC_COUNT type.\n",
+                            "that is not of the PC_COUNT or PC_INTERVAL type.\n",
                             perf_counter->base.name);
         return;
     }
@@ -186,4 +270,75 @@ void Util::perf_count(perf_counter_t perf)
     perf_counter->count++;
 }
 
+void Util::_perf_dump_signal(int signum)
+{
+    perf_dump_requested = 1;
+}
+
+static void perf_dump(int fd, const struct perf_counter_base_t *base)
+{
+    switch (base->type) {
+    case Util::PC_COUNT: {
+        const struct perf_counter_count_t *c = (const struct perf_counter_count_t *)base;
+        dprintf(fd, "%s: %llu events\n", base->name, (unsigned long long)c->count);
+        break;
+    }
+    case Util::PC_ELAPSED: {
+        const struct perf_counter_elapsed_t *e = (const struct perf_counter_elapsed_t *)base;
+        if (e->count == 0) {
+            dprintf(fd, "%s: no events\n", base->name);
+            break;
+        }
+        dprintf(fd, "%s: %llu events, %lluus avg, min %lluus max %lluus %.3fus rms\n",
+                base->name, (unsigned long long)e->count,
+                (unsigned long long)(e->total / e->count / 1000),
+                (unsigned long long)(e->least / 1000), (unsigned long long)(e->most / 1000),
+                e->count > 1 ? sqrt(e->m2 / (e->count - 1)) / 1000 : 0.0);
+        break;
+    }
+    case Util::PC_INTERVAL: {
+        const struct perf_counter_interval_t *i = (const struct perf_counter_interval_t *)base;
+        if (i->count == 0) {
+            dprintf(fd, "%s: no intervals\n", base->name);
+            break;
+        }
+        dprintf(fd, "%s: %llu intervals, %.1fus avg, min %lluus max %lluus %.3fus rms\n",
+                base->name, (unsigned long long)i->count, i->mean / 1000,
+                (unsigned long long)(i->least / 1000), (unsigned long long)(i->most / 1000),
+                i->count > 1 ? sqrt(i->m2 / (i->count - 1)) / 1000 : 0.0);
+        dprintf(fd, "  jitter <1us:%u", (unsigned)i->jitter[0]);
+        for (uint8_t b = 1; b < PERF_INTERVAL_BUCKETS; b++) {
+            dprintf(fd, " %s%lluus:%u", b == PERF_INTERVAL_BUCKETS - 1 ? ">=" : "<",
+                    b == PERF_INTERVAL_BUCKETS - 1 ? 1ULL << (b - 1) : 1ULL << b,
+                    (unsigned)i->jitter[b]);
+        }
+        dprintf(fd, "\n");
+        break;
+    }
+    }
+}
+
+void Util::perf_dump_tick()
+{
+    if (!perf_dump_requested) {
+        return;
+    }
+    perf_dump_requested = 0;
+
+    char path[PATH_MAX];
+    const char *dir = custom_log_directory ? custom_log_directory : HAL_BOARD_LOG_DIRECTORY;
+    snprintf(path, sizeof(path), "%s/perf.txt", dir);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return;
+    }
+    // counters are updated while we read them, so a line may mix two
+    // updates of the same counter
+    for (const struct perf_counter_base_t *base = perf_counters; base != nullptr; base = base->next) {
+        perf_dump(fd, base);
+    }
+    close(fd);
+}
+
 #endif
@@ -52,12 +52,19 @@ void Perf_Lttng::end()
 
 void Perf_Lttng::count()
 {
-    if (_type != AP_HAL::Util::PC_COUNT) {
+    // LTTng timestamps each event, so intervals come from the trace
+    if (_type != AP_HAL::Util::PC_COUNT && _type != AP_HAL::Util::PC_INTERVAL) {
         return;
     }
     tracepoint(ardupilot, count, _name, ++_count);
 }
 
+void Perf_Lttng::latency(uint32_t sample_us, uint32_t start_us, uint32_t ahrs_us,
+                         uint32_t rate_control_us, uint32_t output_us)
+{
+    tracepoint(ardupilot, latency, sample_us, start_us, ahrs_us, rate_control_us, output_us);
+}
+
 Util::perf_counter_t Util::perf_alloc(perf_counter_type type, const char *name)
 {
     return new Linux::Perf_Lttng(type, name);
@@ -84,4 +91,9 @@ void Util::perf_count(perf_counter_t perf)
     perf_lttng->count();
 }
 
+void Util::perf_dump_tick()
+{
+    // the counters are in the LTTng trace
+}
+
 #endif
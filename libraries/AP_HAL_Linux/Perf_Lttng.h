@@ -25,6 +25,10 @@ public:
     void begin();
     void end();
     void count();
+
+    // sensor to output latency of one main loop, see LatencyTrace
+    static void latency(uint32_t sample_us, uint32_t start_us, uint32_t ahrs_us,
+                        uint32_t rate_control_us, uint32_t output_us);
 private:
     char _name[MAX_TRACEPOINT_NAME_LEN];
     uint64_t _count;
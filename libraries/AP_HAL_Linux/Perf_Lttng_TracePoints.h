@@ -59,6 +59,25 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    ardupilot,
+    latency,
+    TP_ARGS(
+        uint32_t, sample_us_arg,
+        uint32_t, start_us_arg,
+        uint32_t, ahrs_us_arg,
+        uint32_t, rate_control_us_arg,
+        uint32_t, output_us_arg
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, sample_us_field, sample_us_arg)
+        ctf_integer(uint32_t, start_us_field, start_us_arg)
+        ctf_integer(uint32_t, ahrs_us_field, ahrs_us_arg)
+        ctf_integer(uint32_t, rate_control_us_field, rate_control_us_arg)
+        ctf_integer(uint32_t, output_us_field, output_us_arg)
+    )
+)
+
 #endif /* _HELLO_TP_H */
 
 #include <lttng/tracepoint-event.h>
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 
 #define PCA9685_RA_MODE1           0x00
 #define PCA9685_RA_MODE2           0x01
@@ -50,9 +51,14 @@
 #define PCA9685_INTERNAL_CLOCK (1.04f * 25000000.f)
 #define PCA9685_EXTERNAL_CLOCK 24576000.f
 
+/* Priority of the thread writing the pulses via i2c
+ * set to 14, which is the same as the UART and the Bebop output thread
+ */
+#define RCOUT_PCA9685_RTPRIO 14
+
 using namespace Linux;
 
-#define PWM_CHAN_COUNT 16
+#define PWM_CHAN_COUNT PCA9685_CHAN_COUNT
 
 static const AP_HAL::HAL& hal = AP_HAL::get_HAL();
 
@@ -63,11 +69,13 @@ RCOutput_PCA9685::RCOutput_PCA9685(uint8_t addr,
     _i2c_sem(NULL),
     _enable_pin(NULL),
     _frequency(50),
-    _pulses_buffer(new uint16_t[PWM_CHAN_COUNT - channel_offset]),
+    _pulses_buffer(new uint16_t[PWM_CHAN_COUNT - channel_offset]()),
     _addr(addr),
     _external_clock(external_clock),
     _channel_offset(channel_offset),
-    _oe_pin_number(oe_pin_number)
+    _oe_pin_number(oe_pin_number),
+    _frames_sent(0),
+    _active_mask(0)
 {
     if (_external_clock)
         _osc_clock = PCA9685_EXTERNAL_CLOCK;
@@ -100,6 +108,10 @@ void RCOutput_PCA9685::init()
         _enable_pin->mode(HAL_GPIO_OUTPUT);
         _enable_pin->write(0);
     }
+
+    /* From now on push() only hands the pulses over to this thread, so the
+     * caller never waits on the I2C bus */
+    _thread.start("rcout-pca9685", SCHED_FIFO, RCOUT_PCA9685_RTPRIO);
 }
 
 void RCOutput_PCA9685::reset_all_channels()
@@ -181,28 +193,68 @@ void RCOutput_PCA9685::write(uint8_t ch, uint16_t period_us)
         return;
     }
 
+    if (!_write_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+
     _pulses_buffer[ch] = period_us;
-    _pending_write_mask |= (1U << ch);
+    _active_mask |= (1U << ch);
 
     if (!_corking)
-        push();
+        _push_frame();
+
+    _write_sem.give();
 }
 
 void RCOutput_PCA9685::cork()
 {
+    if (!_write_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
     _corking = true;
+    _write_sem.give();
 }
 
 void RCOutput_PCA9685::push()
 {
+    if (!_write_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+
     _corking = false;
+    _push_frame();
 
-    if (_pending_write_mask == 0)
+    _write_sem.give();
+}
+
+void RCOutput_PCA9685::_push_frame()
+{
+    if (_active_mask == 0)
+        return;
+
+    output_frame frame = { };
+    memcpy(frame.pulses, _pulses_buffer,
+           (PWM_CHAN_COUNT - _channel_offset) * sizeof(frame.pulses[0]));
+    frame.mask = _active_mask;
+
+    _frames.write(frame);
+    _thread.wake();
+}
+
+void RCOutput_PCA9685::_output_task()
+{
+    output_frame frame;
+
+    /* Pushes that arrived while the previous burst was on the bus are merged
+     * into the latest one */
+    uint32_t count = _frames.count();
+    if (count == _frames_sent || !_frames.read(frame)) {
         return;
+    }
 
     // Calculate the number of channels for this transfer.
-    uint8_t max_ch = (sizeof(unsigned) * 8) - __builtin_clz(_pending_write_mask);
-    uint8_t min_ch = __builtin_ctz(_pending_write_mask);
+    uint8_t max_ch = (sizeof(unsigned) * 8) - __builtin_clz(frame.mask);
+    uint8_t min_ch = __builtin_ctz(frame.mask);
 
     /*
      * scratch buffer size is always for all the channels, but we write only
@@ -211,7 +263,7 @@ void RCOutput_PCA9685::push()
     uint8_t data[PWM_CHAN_COUNT * 4] = { };
 
     for (unsigned ch = min_ch; ch < max_ch; ch++) {
-        uint16_t period_us = _pulses_buffer[ch];
+        uint16_t period_us = frame.pulses[ch];
         uint16_t length = 0;
 
         if (period_us)
@@ -224,7 +276,7 @@ void RCOutput_PCA9685::push()
         *d++ = length >> 8;
     }
 
-    if (!_i2c_sem->take_nonblocking()) {
+    if (!_i2c_sem->take(10)) {
         return;
     }
 
@@ -235,7 +287,7 @@ void RCOutput_PCA9685::push()
 
     _i2c_sem->give();
 
-    _pending_write_mask = 0;
+    _frames_sent = count;
 }
 
 uint16_t RCOutput_PCA9685::read(uint8_t ch)
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <AP_HAL/utility/DoubleBuffer.h>
+
 #include "AP_HAL_Linux.h"
+#include "Semaphores.h"
+#include "Thread.h"
 
 #define PCA9685_PRIMARY_ADDRESS             0x40 // All address pins low, PCA9685 default
 #define PCA9685_SECONDARY_ADDRESS           0x41
 #define PCA9685_TERTIARY_ADDRESS            0x42
 #define PCA9685_QUATENARY_ADDRESS           0x55
 
+#define PCA9685_CHAN_COUNT 16
+
 class Linux::RCOutput_PCA9685 : public AP_HAL::RCOutput {
     public:
     RCOutput_PCA9685(uint8_t addr, bool external_clock, uint8_t channel_offset,
@@ -39,5 +45,28 @@ private:
     bool _corking = false;
     uint8_t _channel_offset;
     int16_t _oe_pin_number;
-    uint16_t _pending_write_mask;
+
+    // runs on _thread, writes out the latest pushed frame
+    void _output_task();
+
+    // hand the pulses written so far to the output thread. Called
+    // with _write_sem held
+    void _push_frame();
+
+    // pulses of the channels written so far, handed from push() to
+    // the output thread
+    struct output_frame {
+        uint16_t pulses[PCA9685_CHAN_COUNT];
+        uint16_t mask;
+    };
+    AP_HAL::DoubleBuffer<output_frame> _frames;
+    uint32_t _frames_sent;
+    uint16_t _active_mask;
+
+    // write() and push() may be called from the main and rate threads.
+    // This keeps _pulses_buffer, _active_mask and _corking consistent
+    // and makes them the single writer _frames needs
+    Semaphore _write_sem;
+
+    EventThread _thread{FUNCTOR_BIND_MEMBER(&RCOutput_PCA9685::_output_task, void)};
 };
@@ -5,6 +5,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -31,6 +32,7 @@ extern const AP_HAL::HAL& hal;
 
 #define APM_LINUX_TIMER_PRIORITY        15
 #define APM_LINUX_UART_PRIORITY         14
+#define APM_LINUX_RATE_PRIORITY         14
 #define APM_LINUX_RCIN_PRIORITY         13
 #define APM_LINUX_MAIN_PRIORITY         12
 #define APM_LINUX_TONEALARM_PRIORITY    11
@@ -51,6 +53,9 @@ extern const AP_HAL::HAL& hal;
 #define APM_LINUX_IO_RATE               50
 #endif
 
+// stack of the main thread touched at startup
+#define APM_LINUX_MAIN_STACK_PREFAULT   (256 * 1024)
+
 #define SCHED_THREAD(name_, UPPER_NAME_)                        \
     {                                                           \
         .name = "sched-" #name_,                                \
@@ -79,13 +84,29 @@ void Scheduler::init()
         SCHED_THREAD(io, IO),
     };
 
-    mlockall(MCL_CURRENT|MCL_FUTURE);
+    /*
+      lock all current and future pages, and fault in the stack of the
+      main thread now rather than on the first deep call in flight.
+      The other threads prefault their own stacks as they start
+     */
+    if (mlockall(MCL_CURRENT|MCL_FUTURE) == -1) {
+        printf("WARNING: mlockall failed, memory may be paged out: %s\n", strerror(errno));
+    }
+    Thread::prefault_stack(APM_LINUX_MAIN_STACK_PREFAULT);
 
     if (geteuid() != 0) {
         printf("WARNING: running as non-root. Will not use realtime scheduling\n");
     }
 
+    if (sched_getaffinity(0, sizeof(_default_cpus), &_default_cpus) == -1) {
+        CPU_ZERO(&_default_cpus);
+    }
+
+    const thread_config *main_config = _find_thread_config("main");
     struct sched_param param = { .sched_priority = APM_LINUX_MAIN_PRIORITY };
+    if (main_config != nullptr && main_config->prio != 0) {
+        param.sched_priority = main_config->prio;
+    }
     sched_setscheduler(0, SCHED_FIFO, &param);
 
     /* set barrier to N + 1 threads: worker threads + main */
@@ -96,8 +117,123 @@ void Scheduler::init()
         const struct sched_table *t = &sched_table[i];
 
         t->thread->set_rate(t->rate);
-        t->thread->start(t->name, t->policy, t->prio);
+        _start_thread(*t->thread, t->name, t->policy, t->prio);
+    }
+
+    // pin the main thread last, as new threads inherit its affinity
+    if (main_config != nullptr && main_config->has_cpus &&
+        sched_setaffinity(0, sizeof(main_config->cpus), &main_config->cpus) == -1) {
+        printf("WARNING: failed to set CPU affinity of main thread: %s\n", strerror(errno));
+    }
+}
+
+/*
+  parse a CPU list like "1" or "0,2-3"
+ */
+static bool parse_cpu_list(const char *s, cpu_set_t &cpus)
+{
+    CPU_ZERO(&cpus);
+
+    while (*s != '\0') {
+        char *end;
+        long first = strtol(s, &end, 10);
+        if (end == s) {
+            return false;
+        }
+        long last = first;
+        if (*end == '-') {
+            s = end + 1;
+            last = strtol(s, &end, 10);
+            if (end == s) {
+                return false;
+            }
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return false;
+        }
+        s = end;
+    }
+
+    return CPU_COUNT(&cpus) > 0;
+}
+
+bool Scheduler::set_thread_config(const char *arg)
+{
+    if (_num_thread_configs >= LINUX_SCHEDULER_MAX_THREAD_CONFIGS) {
+        printf("Too many thread configurations\n");
+        return false;
+    }
+
+    thread_config &config = _thread_config[_num_thread_configs];
+    memset(&config, 0, sizeof(config));
+
+    const char *colon = strchr(arg, ':');
+    if (colon == nullptr || colon == arg || (size_t)(colon - arg) >= sizeof(config.name)) {
+        return false;
+    }
+    memcpy(config.name, arg, colon - arg);
+
+    char *end;
+    long prio = strtol(colon + 1, &end, 10);
+    if (end == colon + 1 || prio < 0 || prio > sched_get_priority_max(SCHED_FIFO)) {
+        return false;
+    }
+    config.prio = prio;
+
+    if (*end == ':') {
+        if (!parse_cpu_list(end + 1, config.cpus)) {
+            return false;
+        }
+        config.has_cpus = true;
+    } else if (*end != '\0') {
+        return false;
+    }
+
+    _num_thread_configs++;
+    return true;
+}
+
+const Scheduler::thread_config *Scheduler::_find_thread_config(const char *name) const
+{
+    // the last one given wins
+    for (int8_t i = _num_thread_configs - 1; i >= 0; i--) {
+        if (strcmp(_thread_config[i].name, name) == 0) {
+            return &_thread_config[i];
+        }
     }
+    return nullptr;
+}
+
+bool Scheduler::_start_thread(Thread &thread, const char *name, int policy, int prio)
+{
+    // "sched-timer" is configured as "timer"
+    const char *short_name = strncmp(name, "sched-", 6) == 0 ? name + 6 : name;
+    const thread_config *config = _find_thread_config(short_name);
+
+    if (config != nullptr && config->prio != 0) {
+        prio = config->prio;
+    }
+    if (!thread.start(name, policy, prio)) {
+        return false;
+    }
+
+    // set even without a configuration of its own, so the thread does
+    // not inherit the CPUs of a pinned main thread
+    if (config != nullptr && config->has_cpus) {
+        thread.set_cpu_affinity(config->cpus);
+    } else if (CPU_COUNT(&_default_cpus) > 0) {
+        thread.set_cpu_affinity(_default_cpus);
+    }
+
+    return true;
 }
 
 void Scheduler::microsleep(uint32_t usec)
@@ -236,6 +372,27 @@ void Scheduler::register_io_process(AP_HAL::MemberProc proc)
     }
 }
 
+bool Scheduler::register_rate_process(AP_HAL::MemberProc proc)
+{
+    if (_rate_thread_started) {
+        return _rate_proc == proc;
+    }
+
+    _rate_proc = proc;
+    if (!_start_thread(_rate_thread, "sched-rate", SCHED_FIFO, APM_LINUX_RATE_PRIORITY)) {
+        return false;
+    }
+    _rate_thread_started = true;
+    return true;
+}
+
+void Scheduler::wake_rate_process()
+{
+    if (_rate_thread_started) {
+        _rate_thread.wake();
+    }
+}
+
 void Scheduler::register_timer_failsafe(AP_HAL::Proc failsafe, uint32_t period_us)
 {
     _failsafe = failsafe;
@@ -368,6 +525,15 @@ void Scheduler::_tonealarm_task()
     Util::from(hal.util)->_toneAlarm_timer_tick();
 }
 
+/*
+  runs once per primary gyro sample, on a thread above the main loop
+  and below the timer thread that reads the sensors
+ */
+void Scheduler::_rate_task()
+{
+    _rate_proc();
+}
+
 void Scheduler::_io_task()
 {
     // process any pending storage writes
@@ -375,6 +541,9 @@ void Scheduler::_io_task()
 
     // run registered IO processes
     _run_io();
+
+    // write out the perf counters if asked to
+    Util::from(hal.util)->perf_dump_tick();
 }
 
 bool Scheduler::in_timerprocess()
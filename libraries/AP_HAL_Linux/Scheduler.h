@@ -9,6 +9,7 @@
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
 #define LINUX_SCHEDULER_MAX_IO_PROCS 10
+#define LINUX_SCHEDULER_MAX_THREAD_CONFIGS 8
 
 class Linux::Scheduler : public AP_HAL::Scheduler {
 public:
@@ -27,6 +28,8 @@ public:
     void     register_timer_process(AP_HAL::MemberProc);
     bool     register_timer_process(AP_HAL::MemberProc, uint8_t);
     void     register_io_process(AP_HAL::MemberProc);
+    bool     register_rate_process(AP_HAL::MemberProc);
+    void     wake_rate_process();
     void     suspend_timer_procs();
     void     resume_timer_procs();
 
@@ -44,6 +47,15 @@ public:
 
     void microsleep(uint32_t usec);
 
+    /*
+     * Override the priority and CPU affinity of a thread, from a
+     * "name:priority[:cpus]" command line argument such as "timer:20:1"
+     * or "main:15:2-3". name is main or a scheduler thread without the
+     * "sched-" prefix; cpus is a list like "0,2-3". A priority of 0
+     * keeps the default. Must be called before init().
+     */
+    bool set_thread_config(const char *arg);
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -60,6 +72,22 @@ private:
 
     void _wait_all_threads();
 
+    struct thread_config {
+        char name[16];
+        int prio;
+        bool has_cpus;
+        cpu_set_t cpus;
+    };
+    const thread_config *_find_thread_config(const char *name) const;
+    bool _start_thread(Thread &thread, const char *name, int policy, int prio);
+
+    thread_config _thread_config[LINUX_SCHEDULER_MAX_THREAD_CONFIGS];
+    uint8_t _num_thread_configs;
+
+    // CPUs of the process at startup, for threads without an affinity
+    // of their own once the main thread has been pinned
+    cpu_set_t _default_cpus;
+
     AP_HAL::Proc _delay_cb;
     uint16_t _min_delay_cb_ms;
 
@@ -91,11 +119,17 @@ private:
     SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
     SchedulerThread _tonealarm_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_tonealarm_task, void), *this};
 
+    // started on demand by register_rate_process()
+    AP_HAL::MemberProc _rate_proc;
+    EventThread _rate_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rate_task, void)};
+    volatile bool _rate_thread_started;
+
     void _timer_task();
     void _io_task();
     void _rcin_task();
     void _uart_task();
     void _tonealarm_task();
+    void _rate_task();
 
     void _run_io();
     void _run_uarts();
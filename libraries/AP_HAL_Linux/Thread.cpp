@@ -17,6 +17,7 @@
  */
 #include "Thread.h"
 
+#include <alloca.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -27,12 +28,17 @@
 
 extern const AP_HAL::HAL &hal;
 
+// stack touched by each thread as it starts
+#define THREAD_PREFAULT_STACK_SIZE (64 * 1024)
+
 namespace Linux {
 
 
 void *Thread::_run_trampoline(void *arg)
 {
     Thread *thread = static_cast<Thread *>(arg);
+
+    prefault_stack(THREAD_PREFAULT_STACK_SIZE);
     thread->_run();
 
     return nullptr;
@@ -84,6 +90,7 @@ bool Thread::start(const char *name, int policy, int prio)
 
     if (name) {
         pthread_setname_np(_ctx, name);
+        _perf_wakeup = hal.util->perf_alloc(AP_HAL::Util::PC_INTERVAL, name);
     }
 
     _started = true;
@@ -96,6 +103,38 @@ bool Thread::is_current_thread()
     return pthread_equal(pthread_self(), _ctx);
 }
 
+bool Thread::set_cpu_affinity(const cpu_set_t &cpus)
+{
+    if (!_started) {
+        return false;
+    }
+
+    int r = pthread_setaffinity_np(_ctx, sizeof(cpus), &cpus);
+    if (r != 0) {
+        hal.console->printf("Failed to set CPU affinity: %s\n", strerror(r));
+        return false;
+    }
+
+    return true;
+}
+
+void Thread::prefault_stack(size_t size)
+{
+    volatile uint8_t *stack = (volatile uint8_t *)alloca(size);
+    const long page_size = sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < size; i += page_size) {
+        stack[i] = 0;
+    }
+}
+
+void Thread::_count_wakeup()
+{
+    if (_perf_wakeup) {
+        hal.util->perf_count(_perf_wakeup);
+    }
+}
+
 bool PeriodicThread::set_rate(uint32_t rate_hz)
 {
     if (_started || rate_hz == 0) {
@@ -121,6 +160,46 @@ bool PeriodicThread::_run()
         }
         next_run_usec += _period_usec;
 
+        _count_wakeup();
+        _task();
+    }
+
+    return true;
+}
+
+EventThread::EventThread(Thread::task_t t)
+    : Thread(t)
+    , _pending(false)
+{
+    pthread_mutexattr_t attr;
+
+    // the waker and the task run at different realtime priorities
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    pthread_cond_init(&_cond, nullptr);
+}
+
+void EventThread::wake()
+{
+    pthread_mutex_lock(&_mutex);
+    _pending = true;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool EventThread::_run()
+{
+    while (true) {
+        pthread_mutex_lock(&_mutex);
+        while (!_pending) {
+            pthread_cond_wait(&_cond, &_mutex);
+        }
+        _pending = false;
+        pthread_mutex_unlock(&_mutex);
+
+        _count_wakeup();
         _task();
     }
 
@@ -19,8 +19,10 @@
 
 #include <pthread.h>
 #include <inttypes.h>
+#include <sched.h>
 #include <stdlib.h>
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_HAL/utility/functor.h>
 
 #include "AP_HAL_Linux_Namespace.h"
@@ -42,9 +44,22 @@ public:
 
     bool is_current_thread();
 
+    // restrict the thread to the given CPUs. Only valid once started
+    bool set_cpu_affinity(const cpu_set_t &cpus);
+
+    /*
+     * Touch size bytes of the calling thread's stack so that its pages
+     * are faulted in, and locked if mlockall() is in effect, before a
+     * deadline depends on them.
+     */
+    static void prefault_stack(size_t size);
+
 protected:
     static void *_run_trampoline(void *arg);
 
+    // one count per wakeup, for the jitter of the thread
+    void _count_wakeup();
+
     /*
      * Run the task assigned in the constructor. May be overriden in case it's
      * preferred to use Thread as an interface or when user wants to aggregate
@@ -55,6 +70,7 @@ protected:
     task_t _task;
     bool _started;
     pthread_t _ctx;
+    AP_HAL::Util::perf_counter_t _perf_wakeup;
 };
 
 class PeriodicThread : public Thread {
@@ -71,4 +87,22 @@ protected:
     uint64_t _period_usec;
 };
 
+/*
+ * Thread that runs its task each time it is woken. Wakeups that arrive
+ * while the task is running are merged into a single further run
+ */
+class EventThread : public Thread {
+public:
+    EventThread(Thread::task_t t);
+
+    void wake();
+
+protected:
+    bool _run() override;
+
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    bool _pending;
+};
+
 }
@@ -8,6 +8,7 @@
 #include <errno.h>
 #include <time.h>
 #include <fcntl.h>
+#include <signal.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -37,6 +38,11 @@ void Util::init(int argc, char * const *argv) {
 #else
     _heat = new Linux::Heat();
 #endif // #ifdef
+
+#ifndef PERF_LTTNG
+    // kill -USR1 writes out the perf counters, see perf_dump_tick()
+    signal(SIGUSR1, &Util::_perf_dump_signal);
+#endif
 }
 
 void Util::set_imu_temp(float current)
@@ -68,12 +68,21 @@ public:
     void perf_end(perf_counter_t perf) override;
     void perf_count(perf_counter_t perf) override;
 
+    /*
+     * Write all perf counters to perf.txt in the log directory if that
+     * was requested with SIGUSR1 since the last call. Called from the
+     * IO thread.
+     */
+    void perf_dump_tick();
+
     // create a new semaphore
     AP_HAL::Semaphore *new_semaphore(void) override { return new Linux::Semaphore; }
 
     int get_hw_arm32();
 
 private:
+    static void _perf_dump_signal(int signum);
+
     static Linux::ToneAlarm _toneAlarm;
     Linux::Heat *_heat;
     int saved_argc;
@@ -322,6 +322,56 @@ const AP_Param::GroupInfo AP_InertialSensor::var_info[] = {
     // @User: Advanced
     // @Values: 1:IMU 1,2:IMU 2,3:IMU 3
     AP_GROUPINFO("ACC_BODYFIX", 26, AP_InertialSensor, _acc_body_aligned, 2),
+
+    // @Param: NOTCH_FREQ
+    // @DisplayName: Gyro notch filter center frequency
+    // @Description: Center frequency of a notch filter applied to the gyros after the low pass filter, to remove motor or rotor noise. A value of zero disables the notch
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("NOTCH_FREQ", 27, AP_InertialSensor, _gyro_notch_freq_hz, 0),
+
+    // @Param: NOTCH_BW
+    // @DisplayName: Gyro notch filter bandwidth
+    // @Description: Bandwidth of the gyro notch filter. Must be less than twice the center frequency
+    // @Units: Hz
+    // @Range: 5 500
+    // @User: Advanced
+    AP_GROUPINFO("NOTCH_BW", 28, AP_InertialSensor, _gyro_notch_bw_hz, 20),
+
+    // @Param: NOTCH_ATT
+    // @DisplayName: Gyro notch filter attenuation
+    // @Description: Attenuation of the gyro notch filter at its center frequency
+    // @Units: dB
+    // @Range: 5 50
+    // @User: Advanced
+    AP_GROUPINFO("NOTCH_ATT", 29, AP_InertialSensor, _gyro_notch_att_db, 30),
+
+#if GYRO_FFT_ENABLED
+    // @Param: FFT_ENABLE
+    // @DisplayName: Enable gyro spectrum analyser
+    // @Description: Runs an FFT over the primary gyro on the IO thread and reports the strongest noise frequency on each axis in the GFFT log message and the GYRO_FFT debug vector. This option takes effect on the next reboot
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("FFT_ENABLE", 30, AP_InertialSensor, _fft_enable, 0),
+#endif
+
+#if INS_BATCH_SAMPLER_ENABLED
+    // @Param: BAT_CNT
+    // @DisplayName: Raw sample batch size
+    // @Description: Number of raw samples captured at the full sensor rate per batch. Batches are written to the ISBH and ISBD log messages when the logger has spare bandwidth, cycling through the accel and gyro of each IMU in INS_BAT_MASK. Zero disables batch sampling. This option takes effect on the next reboot
+    // @Range: 0 16384
+    // @Increment: 32
+    // @User: Advanced
+    AP_GROUPINFO("BAT_CNT", 31, AP_InertialSensor, _batch_sample_count, 0),
+
+    // @Param: BAT_MASK
+    // @DisplayName: Raw sample batch IMU mask
+    // @Description: Bitmask of the IMUs captured by batch sampling. This option takes effect on the next reboot
+    // @Bitmask: 0:IMU1,1:IMU2,2:IMU3
+    // @User: Advanced
+    AP_GROUPINFO("BAT_MASK", 32, AP_InertialSensor, _batch_instance_mask, 1),
+#endif
     /*
       NOTE: parameter indexes have gaps above. When adding new
       parameters check for conflicts carefully
@@ -349,6 +399,12 @@ AP_InertialSensor::AP_InertialSensor() :
     _accel_cal_requires_reboot(false),
     _startup_error_counts_set(false),
     _startup_ms(0)
+#if INS_BATCH_SAMPLER_ENABLED
+    , _batch_sampler(nullptr)
+#endif
+#if GYRO_FFT_ENABLED
+    , _gyro_fft(nullptr)
+#endif
 {
     if (_s_instance) {
         AP_HAL::panic("Too many inertial sensors");
@@ -376,6 +432,7 @@ AP_InertialSensor::AP_InertialSensor() :
         _delta_angle_acc_dt[i] = 0;
         _last_delta_angle[i].zero();
         _last_raw_gyro[i].zero();
+        _last_gyro_arrival_us[i] = 0;
 
         _accel_startup_error_count[i] = 0;
         _gyro_startup_error_count[i] = 0;
@@ -475,6 +532,29 @@ AP_InertialSensor::init(uint16_t sample_rate)
         _start_backends();
     }
 
+#if INS_BATCH_SAMPLER_ENABLED
+    if (_batch_sample_count > 0 && _batch_sampler == nullptr) {
+        _batch_sampler = new BatchSampler();
+        if (_batch_sampler != nullptr &&
+            !_batch_sampler->init(_batch_sample_count, _batch_instance_mask)) {
+            hal.console->printf("INS: failed to allocate sample batch\n");
+            delete _batch_sampler;
+            _batch_sampler = nullptr;
+        }
+    }
+#endif
+
+#if GYRO_FFT_ENABLED
+    if (_fft_enable && _gyro_fft == nullptr && _gyro_count > 0) {
+        _gyro_fft = new GyroFFT();
+        if (_gyro_fft != nullptr && !_gyro_fft->init()) {
+            hal.console->printf("INS: not enough memory for gyro FFT\n");
+            delete _gyro_fft;
+            _gyro_fft = nullptr;
+        }
+    }
+#endif
+
     // initialise accel scale if need be. This is needed as we can't
     // give non-zero default values for vectors in AP_Param
     for (uint8_t i=0; i<get_accel_count(); i++) {
@@ -784,6 +864,7 @@ AP_InertialSensor::_init_gyro()
     */
     enum Rotation saved_orientation = _board_orientation;
     _board_orientation = ROTATION_NONE;
+    _board_rotation.set(ROTATION_NONE);
 
     // remove existing gyro offsets
     for (uint8_t k=0; k<num_gyros; k++) {
@@ -884,6 +965,7 @@ AP_InertialSensor::_init_gyro()
 
     // restore orientation
     _board_orientation = saved_orientation;
+    _board_rotation.set(saved_orientation);
 
     // record calibration complete
     _calibrating = false;
@@ -996,6 +1078,12 @@ void AP_InertialSensor::update(void)
         }
     }
 
+#if INS_BATCH_SAMPLER_ENABLED
+    if (_batch_sampler != nullptr) {
+        _batch_sampler->periodic(_dataflash);
+    }
+#endif
+
     _have_sample = false;
 }
 
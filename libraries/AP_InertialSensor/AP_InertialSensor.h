@@ -21,9 +21,14 @@
 
 #include <AP_AccelCal/AP_AccelCal.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
 #include <AP_Math/AP_Math.h>
 #include <Filter/LowPassFilter2p.h>
 #include <Filter/LowPassFilter.h>
+#include <Filter/BiquadFilterBank.h>
+
+#include "BatchSampler.h"
+#include "GyroFFT.h"
 
 class AP_InertialSensor_Backend;
 class AuxiliaryBus;
@@ -167,6 +172,7 @@ public:
     // set overall board orientation
     void set_board_orientation(enum Rotation orientation) {
         _board_orientation = orientation;
+        _board_rotation.set(orientation);
     }
 
     // return the selected sample rate
@@ -181,6 +187,18 @@ public:
     uint8_t get_primary_accel(void) const { return _primary_accel; }
     uint8_t get_primary_gyro(void) const { return _primary_gyro; }
 
+    // time in microseconds the latest raw sample of the primary gyro
+    // arrived, for latency measurement
+    uint32_t get_last_gyro_arrival_us(void) const { return _last_gyro_arrival_us[_primary_gyro]; }
+
+    // latest filtered raw sample of the primary gyro, without the
+    // AHRS drift correction. Safe to call from any thread; returns
+    // false until the first sample
+    bool get_rate_gyro(Vector3f &gyro) const { return _rate_gyro.read(gyro); }
+
+    // raw sample rate of the primary gyro, zero if unknown
+    uint16_t get_gyro_rate_hz(void) const { return _gyro_raw_sample_rates[_primary_gyro]; }
+
     // enable HIL mode
     void set_hil_mode(void) { _hil_mode = true; }
 
@@ -206,6 +224,11 @@ public:
     // retrieve and clear accelerometer clipping count
     uint32_t get_accel_clip_count(uint8_t instance) const;
 
+#if GYRO_FFT_ENABLED
+    // spectrum of the primary gyro, nullptr if disabled
+    const GyroFFT *get_gyro_fft(void) const { return _gyro_fft; }
+#endif
+
     // check for vibration movement. True when all axis show nearly zero movement
     bool is_still();
 
@@ -292,9 +315,9 @@ private:
     // time accumulator for delta velocity accumulator
     float _delta_velocity_acc_dt[INS_MAX_INSTANCES];
 
-    // Low Pass filters for gyro and accel
-    LowPassFilter2pVector3f _accel_filter[INS_MAX_INSTANCES];
-    LowPassFilter2pVector3f _gyro_filter[INS_MAX_INSTANCES];
+    // Low Pass filters for gyro and accel, plus notch on the gyros
+    BiquadFilterBank<INS_MAX_INSTANCES> _accel_filter;
+    BiquadFilterBank<INS_MAX_INSTANCES> _gyro_filter;
     Vector3f _accel_filtered[INS_MAX_INSTANCES];
     Vector3f _gyro_filtered[INS_MAX_INSTANCES];
     bool _new_accel_data[INS_MAX_INSTANCES];
@@ -310,6 +333,11 @@ private:
     Vector3f _delta_angle_acc[INS_MAX_INSTANCES];
     Vector3f _last_delta_angle[INS_MAX_INSTANCES];
     Vector3f _last_raw_gyro[INS_MAX_INSTANCES];
+    // when the latest raw sample arrived, written by the backends
+    volatile uint32_t _last_gyro_arrival_us[INS_MAX_INSTANCES];
+
+    // primary gyro samples for a rate loop running on its own thread
+    AP_HAL::DoubleBuffer<Vector3f> _rate_gyro;
 
     // product id
     AP_Int16 _product_id;
@@ -334,11 +362,31 @@ private:
     AP_Int8     _gyro_filter_cutoff;
     AP_Int8     _gyro_cal_timing;
 
+    // gyro notch filter, a zero frequency disables it
+    AP_Int16    _gyro_notch_freq_hz;
+    AP_Int16    _gyro_notch_bw_hz;
+    AP_Int8     _gyro_notch_att_db;
+
+#if INS_BATCH_SAMPLER_ENABLED
+    // burst capture of raw samples to DataFlash
+    AP_Int16    _batch_sample_count;
+    AP_Int8     _batch_instance_mask;
+    BatchSampler *_batch_sampler;
+#endif
+
+#if GYRO_FFT_ENABLED
+    // onboard gyro spectrum analyser
+    AP_Int8     _fft_enable;
+    GyroFFT    *_gyro_fft;
+#endif
+
     // use for attitude, velocity, position estimates
     AP_Int8     _use[INS_MAX_INSTANCES];
 
     // board orientation from AHRS
     enum Rotation _board_orientation;
+    // _board_orientation as a matrix, applied to every sample
+    RotationCache _board_rotation;
 
     // calibrated_ok flags
     bool _gyro_cal_ok[INS_MAX_INSTANCES];
@@ -30,14 +30,14 @@ void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vect
     accel.z *= accel_scale.z;
 
     // rotate to body frame
-    accel.rotate(_imu._board_orientation);
+    _imu._board_rotation.rotate(accel);
 }
 
 void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) 
 {
     // gyro calibration is always assumed to have been done in sensor frame
     gyro -= _imu._gyro_offset[instance];
-    gyro.rotate(_imu._board_orientation);
+    _imu._board_rotation.rotate(gyro);
 }
 
 /*
@@ -94,12 +94,31 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
     _imu._last_delta_angle[instance] = delta_angle;
     _imu._last_raw_gyro[instance] = gyro;
 
-    _imu._gyro_filtered[instance] = _imu._gyro_filter[instance].apply(gyro);
+    _imu._gyro_filtered[instance] = _imu._gyro_filter.apply(instance, gyro);
     if (_imu._gyro_filtered[instance].is_nan() || _imu._gyro_filtered[instance].is_inf()) {
-        _imu._gyro_filter[instance].reset();
+        _imu._gyro_filter.reset(instance);
+    } else if (instance == _imu._primary_gyro) {
+        // hand the sample straight to the rate loop thread, if the
+        // vehicle runs one
+        _imu._rate_gyro.write(_imu._gyro_filtered[instance]);
+        hal.scheduler->wake_rate_process();
     }
 
     _imu._new_gyro_data[instance] = true;
+    _imu._last_gyro_arrival_us[instance] = AP_HAL::micros();
+
+#if INS_BATCH_SAMPLER_ENABLED
+    if (_imu._batch_sampler != nullptr) {
+        _imu._batch_sampler->sample(instance, BatchSampler::SENSOR_GYRO, gyro, sample_us,
+                                    _imu._gyro_raw_sample_rates[instance]);
+    }
+#endif
+
+#if GYRO_FFT_ENABLED
+    if (_imu._gyro_fft != nullptr && instance == _imu._primary_gyro) {
+        _imu._gyro_fft->sample(gyro, _imu._gyro_raw_sample_rates[instance]);
+    }
+#endif
 
     DataFlash_Class *dataflash = get_dataflash();
     if (dataflash != NULL) {
@@ -138,7 +157,7 @@ void AP_InertialSensor_Backend::_publish_accel(uint8_t instance, const Vector3f
         Vector3f cal_sample = _imu._delta_velocity[instance];
 
         //remove rotation
-        cal_sample.rotate_inverse(_imu._board_orientation);
+        _imu._board_rotation.rotate_inverse(cal_sample);
 
         // remove scale factors
         const Vector3f &accel_scale = _imu._accel_scale[instance].get();
@@ -171,13 +190,20 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
     _imu._delta_velocity_acc[instance] += accel * dt;
     _imu._delta_velocity_acc_dt[instance] += dt;
 
-    _imu._accel_filtered[instance] = _imu._accel_filter[instance].apply(accel);
+    _imu._accel_filtered[instance] = _imu._accel_filter.apply(instance, accel);
     if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
-        _imu._accel_filter[instance].reset();
+        _imu._accel_filter.reset(instance);
     }
 
     _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
 
+#if INS_BATCH_SAMPLER_ENABLED
+    if (_imu._batch_sampler != nullptr) {
+        _imu._batch_sampler->sample(instance, BatchSampler::SENSOR_ACCEL, accel, sample_us,
+                                    _imu._accel_raw_sample_rates[instance]);
+    }
+#endif
+
     _imu._new_accel_data[instance] = true;
 
     DataFlash_Class *dataflash = get_dataflash();
@@ -242,10 +268,21 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
 
     // possibly update filter frequency
     if (_last_gyro_filter_hz[instance] != _gyro_filter_cutoff()) {
-        _imu._gyro_filter[instance].set_cutoff_frequency(_gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
+        _imu._gyro_filter.set_lowpass(instance, _gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
         _last_gyro_filter_hz[instance] = _gyro_filter_cutoff();
     }
 
+    // possibly update notch filter
+    if (_last_gyro_notch_freq_hz[instance] != _gyro_notch_freq_hz() ||
+        _last_gyro_notch_bw_hz[instance] != _gyro_notch_bw_hz() ||
+        _last_gyro_notch_att_db[instance] != _gyro_notch_att_db()) {
+        _imu._gyro_filter.set_notch(instance, _gyro_raw_sample_rate(instance),
+                                    _gyro_notch_freq_hz(), _gyro_notch_bw_hz(), _gyro_notch_att_db());
+        _last_gyro_notch_freq_hz[instance] = _gyro_notch_freq_hz();
+        _last_gyro_notch_bw_hz[instance] = _gyro_notch_bw_hz();
+        _last_gyro_notch_att_db[instance] = _gyro_notch_att_db();
+    }
+
     hal.scheduler->resume_timer_procs();
 }
 
@@ -263,7 +300,7 @@ void AP_InertialSensor_Backend::update_accel(uint8_t instance)
     
     // possibly update filter frequency
     if (_last_accel_filter_hz[instance] != _accel_filter_cutoff()) {
-        _imu._accel_filter[instance].set_cutoff_frequency(_accel_raw_sample_rate(instance), _accel_filter_cutoff());
+        _imu._accel_filter.set_lowpass(instance, _accel_raw_sample_rate(instance), _accel_filter_cutoff());
         _last_accel_filter_hz[instance] = _accel_filter_cutoff();
     }
 
@@ -131,6 +131,11 @@ protected:
     // return the default filter frequency in Hz for the sample rate
     uint8_t _gyro_filter_cutoff(void) const { return _imu._gyro_filter_cutoff; }
 
+    // return the gyro notch filter settings
+    int16_t _gyro_notch_freq_hz(void) const { return _imu._gyro_notch_freq_hz; }
+    int16_t _gyro_notch_bw_hz(void) const { return _imu._gyro_notch_bw_hz; }
+    int8_t _gyro_notch_att_db(void) const { return _imu._gyro_notch_att_db; }
+
     // return the requested sample rate in Hz
     uint16_t get_sample_rate_hz(void) const;
 
@@ -148,6 +153,9 @@ protected:
     // support for updating filter at runtime
     int8_t _last_accel_filter_hz[INS_MAX_INSTANCES];
     int8_t _last_gyro_filter_hz[INS_MAX_INSTANCES];
+    int16_t _last_gyro_notch_freq_hz[INS_MAX_INSTANCES] {};
+    int16_t _last_gyro_notch_bw_hz[INS_MAX_INSTANCES] {};
+    int8_t _last_gyro_notch_att_db[INS_MAX_INSTANCES] {};
 
     // note that each backend is also expected to have a static detect()
     // function which instantiates an instance of the backend sensor
@@ -198,6 +198,14 @@ extern const AP_HAL::HAL& hal;
 #endif
 #define MAX_DATA_READ (MPU6000_MAX_FIFO_SAMPLES * MPU6000_SAMPLE_SIZE)
 
+/*
+ * With SMPLRT_DIV at 0 and the DLPF disabled every 8kHz gyro sample goes
+ * through the 1024 byte FIFO, which then holds 9ms of data
+ */
+#define MPU6000_FAST_SAMPLE_RATE 8000
+#define MPU6000_FAST_SAMPLE_PERIOD_US (1000000UL / MPU6000_FAST_SAMPLE_RATE)
+#define MPU6000_FIFO_SIZE 1024
+
 #define int16_val(v, idx) ((int16_t)(((uint16_t)v[2*idx] << 8) | v[2*idx+1]))
 #define uint16_val(v, idx)(((uint16_t)v[2*idx] << 8) | v[2*idx+1])
 
@@ -232,6 +240,7 @@ AP_InertialSensor_MPU6000::AP_InertialSensor_MPU6000(AP_InertialSensor &imu,
 AP_InertialSensor_MPU6000::~AP_InertialSensor_MPU6000()
 {
     delete _auxiliary_bus;
+    delete[] _fifo_buffer;
 }
 
 AP_InertialSensor_Backend *AP_InertialSensor_MPU6000::probe(AP_InertialSensor &imu,
@@ -283,9 +292,12 @@ bool AP_InertialSensor_MPU6000::_init()
 
 void AP_InertialSensor_MPU6000::_fifo_reset()
 {
-    _register_write(MPUREG_USER_CTRL, 0);
-    _register_write(MPUREG_USER_CTRL, BIT_USER_CTRL_FIFO_RESET);
-    _register_write(MPUREG_USER_CTRL, BIT_USER_CTRL_FIFO_EN);
+    uint8_t user_ctrl = _register_read(MPUREG_USER_CTRL) & ~BIT_USER_CTRL_FIFO_EN;
+
+    // keep the I2C interface and master bits as they are
+    _register_write(MPUREG_USER_CTRL, user_ctrl);
+    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_RESET);
+    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_EN);
 }
 
 void AP_InertialSensor_MPU6000::_fifo_enable()
@@ -303,6 +315,14 @@ bool AP_InertialSensor_MPU6000::_has_auxiliary_bus()
 
 void AP_InertialSensor_MPU6000::start()
 {
+    _fast_sampling = MPU6000_FAST_SAMPLING && _bus_type == BUS_TYPE_SPI;
+    if (_fast_sampling) {
+        _fifo_buffer = new uint8_t[MPU6000_FIFO_SIZE];
+        if (_fifo_buffer == nullptr) {
+            _fast_sampling = false;
+        }
+    }
+
     hal.scheduler->suspend_timer_procs();
 
     if (!_dev->get_semaphore()->take(100)) {
@@ -316,7 +336,7 @@ void AP_InertialSensor_MPU6000::start()
     _register_write(MPUREG_PWR_MGMT_2, 0x00);
     hal.scheduler->delay(1);
 
-    if (_use_fifo) {
+    if (_use_fifo || _fast_sampling) {
         _fifo_enable();
     }
 
@@ -327,8 +347,9 @@ void AP_InertialSensor_MPU6000::start()
     // In this configuration, the gyro sample rate is 8kHz
     // Therefore the sample rate value is 8kHz/(SMPLRT_DIV + 1)
     // So we have to set it to 7 to have a 1kHz sampling
-    // rate on the gyro
-    _register_write(MPUREG_SMPLRT_DIV, 7);
+    // rate on the gyro. When fast sampling we keep every gyro
+    // sample and the 1kHz accel is repeated in the FIFO
+    _register_write(MPUREG_SMPLRT_DIV, _fast_sampling ? 0 : 7);
     hal.scheduler->delay(1);
 
     // Gyro scale 2000º/s
@@ -368,8 +389,10 @@ void AP_InertialSensor_MPU6000::start()
     _dev->get_semaphore()->give();
 
     // grab the used instances
-    _gyro_instance = _imu.register_gyro(1000);
-    _accel_instance = _imu.register_accel(1000);
+    const uint16_t raw_sample_rate = _fast_sampling ? MPU6000_FAST_SAMPLE_RATE : 1000;
+    _gyro_instance = _imu.register_gyro(raw_sample_rate);
+    _accel_instance = _imu.register_accel(raw_sample_rate);
+    _temp_filter.set_cutoff_frequency(raw_sample_rate, 1);
 
     hal.scheduler->resume_timer_procs();
 
@@ -431,7 +454,7 @@ void AP_InertialSensor_MPU6000::_poll_data()
         return;
     }
 
-    if (_use_fifo) {
+    if (_use_fifo || _fast_sampling) {
         _read_fifo();
     } else if (_data_ready()) {
         _read_sample();
@@ -440,12 +463,19 @@ void AP_InertialSensor_MPU6000::_poll_data()
     _dev->get_semaphore()->give();
 }
 
-void AP_InertialSensor_MPU6000::_accumulate(uint8_t *samples, uint8_t n_samples)
+void AP_InertialSensor_MPU6000::_accumulate(uint8_t *samples, uint16_t n_samples,
+                                            uint64_t last_sample_us)
 {
-    for (uint8_t i = 0; i < n_samples; i++) {
+    for (uint16_t i = 0; i < n_samples; i++) {
         uint8_t *data = samples + MPU6000_SAMPLE_SIZE * i;
         Vector3f accel, gyro;
         float temp;
+        uint64_t sample_us = 0;
+
+        /* older samples in a burst are one sample period apart */
+        if (last_sample_us != 0) {
+            sample_us = last_sample_us - (n_samples - 1 - i) * MPU6000_FAST_SAMPLE_PERIOD_US;
+        }
 
         accel = Vector3f(int16_val(data, 1),
                          int16_val(data, 0),
@@ -475,8 +505,8 @@ void AP_InertialSensor_MPU6000::_accumulate(uint8_t *samples, uint8_t n_samples)
         _rotate_and_correct_accel(_accel_instance, accel);
         _rotate_and_correct_gyro(_gyro_instance, gyro);
 
-        _notify_new_accel_raw_sample(_accel_instance, accel);
-        _notify_new_gyro_raw_sample(_gyro_instance, gyro);
+        _notify_new_accel_raw_sample(_accel_instance, accel, sample_us);
+        _notify_new_gyro_raw_sample(_gyro_instance, gyro, sample_us);
 
         _temp_filtered = _temp_filter.apply(temp);
     }
@@ -484,17 +514,23 @@ void AP_InertialSensor_MPU6000::_accumulate(uint8_t *samples, uint8_t n_samples)
 
 void AP_InertialSensor_MPU6000::_read_fifo()
 {
-    uint8_t n_samples;
+    uint16_t n_samples;
     uint16_t bytes_read;
     uint8_t rx[MAX_DATA_READ];
 
     static_assert(MAX_DATA_READ <= 100, "Too big to keep on stack");
 
+    /* when fast sampling the whole FIFO is drained in one burst */
+    uint8_t *buf = _fast_sampling ? _fifo_buffer : rx;
+    const uint16_t max_samples = _fast_sampling ?
+        (MPU6000_FIFO_SIZE / MPU6000_SAMPLE_SIZE) - 1 : MPU6000_MAX_FIFO_SAMPLES;
+
     if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
         hal.console->printf("MPU60x0: error in fifo read\n");
         return;
     }
 
+    const uint64_t now = AP_HAL::micros64();
     bytes_read = uint16_val(rx, 0);
     n_samples = bytes_read / MPU6000_SAMPLE_SIZE;
 
@@ -503,22 +539,23 @@ void AP_InertialSensor_MPU6000::_read_fifo()
         return;
     }
 
-    if (n_samples > MPU6000_MAX_FIFO_SAMPLES) {
+    if (n_samples > max_samples) {
         hal.console->printf("bytes_read = %u, n_samples %u > %u, dropping samples\n",
-                            bytes_read, n_samples, MPU6000_MAX_FIFO_SAMPLES);
+                            bytes_read, n_samples, max_samples);
 
         /* Too many samples, do a FIFO RESET */
         _fifo_reset();
         return;
     }
 
-    if (!_block_read(MPUREG_FIFO_R_W, rx, n_samples * MPU6000_SAMPLE_SIZE)) {
+    if (!_block_read(MPUREG_FIFO_R_W, buf, n_samples * MPU6000_SAMPLE_SIZE)) {
         hal.console->printf("MPU60x0: error in fifo read %u bytes\n",
                             n_samples * MPU6000_SAMPLE_SIZE);
         return;
     }
 
-    _accumulate(rx, n_samples);
+    /* the newest sample was taken just before the FIFO count was read */
+    _accumulate(buf, n_samples, _fast_sampling ? now : 0);
 }
 
 void AP_InertialSensor_MPU6000::_read_sample()
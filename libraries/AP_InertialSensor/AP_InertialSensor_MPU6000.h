@@ -19,6 +19,12 @@
 // enable debug to see a register dump on startup
 #define MPU6000_DEBUG 0
 
+// on fast boards drain the FIFO in bursts and deliver every sample at the
+// full 8kHz gyro rate. Only used on SPI, I2C can't keep up with the data rate
+#ifndef MPU6000_FAST_SAMPLING
+#define MPU6000_FAST_SAMPLING (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
+#endif
+
 class AP_MPU6000_AuxiliaryBus;
 class AP_MPU6000_AuxiliaryBusSlave;
 
@@ -94,7 +100,7 @@ private:
     void _register_write(uint8_t reg, uint8_t val );
     void _register_write_check(uint8_t reg, uint8_t val);
 
-    void _accumulate(uint8_t *samples, uint8_t n_samples);
+    void _accumulate(uint8_t *samples, uint16_t n_samples, uint64_t last_sample_us = 0);
 
     // instance numbers of accel and gyro data
     uint8_t _gyro_instance;
@@ -104,6 +110,12 @@ private:
     const bool _use_fifo;
     const enum bus_type _bus_type;
 
+    // true when reading the FIFO at the full gyro rate
+    bool _fast_sampling;
+
+    // burst buffer for the FIFO contents, only allocated when fast sampling
+    uint8_t *_fifo_buffer = nullptr;
+
     uint16_t _error_count;
 
     float _temp_filtered;
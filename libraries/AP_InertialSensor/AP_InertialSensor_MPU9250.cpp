@@ -76,6 +76,11 @@ extern const AP_HAL::HAL &hal;
 #define MPUREG_ZRMOT_THR                                0x21    // detection threshold for Zero Motion interrupt generation.
 #define MPUREG_ZRMOT_DUR                                0x22    // duration counter threshold for Zero Motion interrupt generation. The duration counter ticks at 16 Hz, therefore ZRMOT_DUR has a unit of 1 LSB = 64 ms.
 #define MPUREG_FIFO_EN                                  0x23
+#       define BIT_TEMP_FIFO_EN                         0x80
+#       define BIT_XG_FIFO_EN                           0x40
+#       define BIT_YG_FIFO_EN                           0x20
+#       define BIT_ZG_FIFO_EN                           0x10
+#       define BIT_ACCEL_FIFO_EN                        0x08
 #define MPUREG_INT_PIN_CFG                              0x37
 #       define BIT_INT_RD_CLEAR                                 0x10    // clear the interrupt when any read occurs
 #       define BIT_LATCH_INT_EN                                 0x20    // latch data ready pin
@@ -184,6 +189,15 @@ extern const AP_HAL::HAL &hal;
 #define MPU9250_MAX_FIFO_SAMPLES 3
 #define MAX_DATA_READ (MPU9250_MAX_FIFO_SAMPLES * MPU9250_SAMPLE_SIZE)
 
+/*
+ * With the DLPF bypassed the gyro is sampled at 8kHz and SMPLRT_DIV is
+ * ignored. In fast sampling mode every one of these samples goes through
+ * the 512 byte FIFO, which holds 4.5ms of data at that rate
+ */
+#define MPU9250_FAST_SAMPLE_RATE 8000
+#define MPU9250_FAST_SAMPLE_PERIOD_US (1000000UL / MPU9250_FAST_SAMPLE_RATE)
+#define MPU9250_FIFO_SIZE 512
+
 #define int16_val(v, idx) ((int16_t)(((uint16_t)v[2*idx] << 8) | v[2*idx+1]))
 #define uint16_val(v, idx)(((uint16_t)v[2*idx] << 8) | v[2*idx+1])
 
@@ -231,6 +245,7 @@ AP_InertialSensor_MPU9250::AP_InertialSensor_MPU9250(AP_InertialSensor &imu,
 AP_InertialSensor_MPU9250::~AP_InertialSensor_MPU9250()
 {
     delete _auxiliary_bus;
+    delete[] _fifo_buffer;
 }
 
 AP_InertialSensor_Backend *AP_InertialSensor_MPU9250::probe(AP_InertialSensor &imu,
@@ -280,8 +295,34 @@ bool AP_InertialSensor_MPU9250::_has_auxiliary_bus()
     return _bus_type != BUS_TYPE_I2C;
 }
 
+void AP_InertialSensor_MPU9250::_fifo_reset()
+{
+    uint8_t user_ctrl = _register_read(MPUREG_USER_CTRL) & ~BIT_USER_CTRL_FIFO_EN;
+
+    // keep the I2C interface and master bits as they are
+    _register_write(MPUREG_USER_CTRL, user_ctrl);
+    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_RESET);
+    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_EN);
+}
+
+void AP_InertialSensor_MPU9250::_fifo_enable()
+{
+    _register_write(MPUREG_FIFO_EN, BIT_XG_FIFO_EN | BIT_YG_FIFO_EN |
+                    BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN | BIT_TEMP_FIFO_EN);
+    _fifo_reset();
+    hal.scheduler->delay(1);
+}
+
 void AP_InertialSensor_MPU9250::start()
 {
+    _fast_sampling = MPU9250_FAST_SAMPLING && _bus_type == BUS_TYPE_SPI;
+    if (_fast_sampling) {
+        _fifo_buffer = new uint8_t[MPU9250_FIFO_SIZE];
+        if (_fifo_buffer == nullptr) {
+            _fast_sampling = false;
+        }
+    }
+
     hal.scheduler->suspend_timer_procs();
 
     if (!_dev->get_semaphore()->take(100)) {
@@ -312,6 +353,12 @@ void AP_InertialSensor_MPU9250::start()
     // RM-MPU-9250A-00.pdf, pg. 15, select accel full scale 16g
     _register_write(MPUREG_ACCEL_CONFIG,3<<3);
 
+    if (_fast_sampling) {
+        // the accel updates at 4kHz at most, so it is repeated in
+        // the FIFO at the gyro rate
+        _fifo_enable();
+    }
+
     // configure interrupt to fire when new data arrives
     _register_write(MPUREG_INT_ENABLE, BIT_RAW_RDY_EN);
 
@@ -327,8 +374,9 @@ void AP_InertialSensor_MPU9250::start()
     _dev->get_semaphore()->give();
 
     // grab the used instances
-    _gyro_instance = _imu.register_gyro(DEFAULT_SAMPLE_RATE);
-    _accel_instance = _imu.register_accel(DEFAULT_SAMPLE_RATE);
+    const uint16_t raw_sample_rate = _fast_sampling ? MPU9250_FAST_SAMPLE_RATE : DEFAULT_SAMPLE_RATE;
+    _gyro_instance = _imu.register_gyro(raw_sample_rate);
+    _accel_instance = _imu.register_accel(raw_sample_rate);
 
     hal.scheduler->resume_timer_procs();
 
@@ -384,12 +432,16 @@ void AP_InertialSensor_MPU9250::_poll_data()
         return;
     }
 
-    _read_sample();
+    if (_fast_sampling) {
+        _read_fifo();
+    } else {
+        _read_sample();
+    }
 
     _dev->get_semaphore()->give();
 }
 
-void AP_InertialSensor_MPU9250::_accumulate(uint8_t *rx)
+void AP_InertialSensor_MPU9250::_accumulate(uint8_t *rx, uint64_t sample_us)
 {
     Vector3f accel, gyro;
 
@@ -399,7 +451,7 @@ void AP_InertialSensor_MPU9250::_accumulate(uint8_t *rx)
     accel *= MPU9250_ACCEL_SCALE_1G;
     accel.rotate(_default_rotation);
     _rotate_and_correct_accel(_accel_instance, accel);
-    _notify_new_accel_raw_sample(_accel_instance, accel);
+    _notify_new_accel_raw_sample(_accel_instance, accel, sample_us);
 
     gyro = Vector3f(int16_val(rx, 5),
                     int16_val(rx, 4),
@@ -407,7 +459,51 @@ void AP_InertialSensor_MPU9250::_accumulate(uint8_t *rx)
     gyro *= GYRO_SCALE;
     gyro.rotate(_default_rotation);
     _rotate_and_correct_gyro(_gyro_instance, gyro);
-    _notify_new_gyro_raw_sample(_gyro_instance, gyro);
+    _notify_new_gyro_raw_sample(_gyro_instance, gyro, sample_us);
+}
+
+/*
+ * drain the FIFO in a single burst and pass every sample on with its own
+ * timestamp
+ */
+void AP_InertialSensor_MPU9250::_read_fifo()
+{
+    uint8_t rx[2];
+
+    if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
+        hal.console->printf("MPU9250: error reading fifo count\n");
+        return;
+    }
+
+    const uint64_t now = AP_HAL::micros64();
+    const uint16_t bytes_read = uint16_val(rx, 0);
+    const uint16_t n_samples = bytes_read / MPU9250_SAMPLE_SIZE;
+
+    if (n_samples == 0) {
+        /* Not enough data in FIFO */
+        return;
+    }
+
+    if (bytes_read > MPU9250_FIFO_SIZE - MPU9250_SAMPLE_SIZE) {
+        /* The FIFO has overflowed or is about to, so sample boundaries
+         * can't be trusted anymore */
+        hal.console->printf("MPU9250: fifo overflow, %u bytes\n", bytes_read);
+        _fifo_reset();
+        return;
+    }
+
+    if (!_block_read(MPUREG_FIFO_R_W, _fifo_buffer, n_samples * MPU9250_SAMPLE_SIZE)) {
+        hal.console->printf("MPU9250: error in fifo read %u bytes\n",
+                            n_samples * MPU9250_SAMPLE_SIZE);
+        return;
+    }
+
+    /* the newest sample was taken just before the FIFO count was read,
+     * older ones are one sample period apart */
+    for (uint16_t i = 0; i < n_samples; i++) {
+        const uint64_t sample_us = now - (n_samples - 1 - i) * MPU9250_FAST_SAMPLE_PERIOD_US;
+        _accumulate(_fifo_buffer + i * MPU9250_SAMPLE_SIZE, sample_us);
+    }
 }
 
 
@@ -20,6 +20,12 @@ class AP_MPU9250_AuxiliaryBusSlave;
 // enable debug to see a register dump on startup
 #define MPU9250_DEBUG 0
 
+// on fast boards drain the FIFO in bursts and deliver every sample at the
+// full 8kHz gyro rate. Only used on SPI, I2C can't keep up with the data rate
+#ifndef MPU9250_FAST_SAMPLING
+#define MPU9250_FAST_SAMPLING (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
+#endif
+
 class AP_InertialSensor_MPU9250 : public AP_InertialSensor_Backend
 {
     friend AP_MPU9250_AuxiliaryBus;
@@ -69,6 +75,12 @@ private:
     void _set_filter_register(uint16_t filter_hz);
     bool _has_auxiliary_bus();
 
+    void _fifo_reset();
+    void _fifo_enable();
+
+    /* Read all samples in the FIFO in one burst (fast sampling) */
+    void _read_fifo();
+
     /* Read a single sample */
     void _read_sample();
 
@@ -86,7 +98,7 @@ private:
     void _register_write(uint8_t reg, uint8_t val );
     void _register_write_check(uint8_t reg, uint8_t val);
 
-    void _accumulate(uint8_t *sample);
+    void _accumulate(uint8_t *sample, uint64_t sample_us = 0);
 
     // instance numbers of accel and gyro data
     uint8_t _gyro_instance;
@@ -99,6 +111,12 @@ private:
     // placed by default on the system
     enum Rotation _default_rotation;
 
+    // true when reading the FIFO at the full gyro rate
+    bool _fast_sampling;
+
+    // burst buffer for the FIFO contents, only allocated when fast sampling
+    uint8_t *_fifo_buffer = nullptr;
+
     AP_HAL::OwnPtr<AP_HAL::Device> _dev;
     AP_MPU9250_AuxiliaryBus *_auxiliary_bus;
 };
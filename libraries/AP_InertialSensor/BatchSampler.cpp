@@ -0,0 +1,198 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatchSampler.h"
+
+#if INS_BATCH_SAMPLER_ENABLED
+
+#include <DataFlash/DataFlash.h>
+
+#include "AP_InertialSensor.h"
+
+// int16 scaling, covering +/-2000deg/s and +/-16g
+#define BATCH_MULTIPLIER_GYRO   ((uint16_t)(INT16_MAX / radians(2000)))
+#define BATCH_MULTIPLIER_ACCEL  ((uint16_t)(INT16_MAX / (16 * GRAVITY_MSS)))
+
+// ISBD messages written per call to periodic()
+#define BATCH_MAX_MSGS_PER_UPDATE 4
+
+// only write while the logger has at least this much buffer free, so
+// batches never displace the normal flight logs
+#define BATCH_MIN_BUFFER_SPACE 1024
+
+// move on if the sensor being captured delivers no samples
+#define BATCH_CAPTURE_TIMEOUT_MS 2000
+
+BatchSampler::BatchSampler() :
+    _data_x(nullptr),
+    _data_y(nullptr),
+    _data_z(nullptr),
+    _samples_per_batch(0),
+    _instance_mask(0),
+    _type(SENSOR_ACCEL),
+    _instance(0),
+    _multiplier(BATCH_MULTIPLIER_ACCEL),
+    _write_offset(0),
+    _first_sample_us(0),
+    _sample_rate_hz(0),
+    _capture_start_ms(0),
+    _read_offset(0),
+    _isb_seqno(0),
+    _header_written(false)
+{
+}
+
+BatchSampler::~BatchSampler()
+{
+    delete[] _data_x;
+    delete[] _data_y;
+    delete[] _data_z;
+}
+
+bool BatchSampler::init(uint16_t samples_per_batch, uint8_t instance_mask)
+{
+    instance_mask &= (1U << INS_MAX_INSTANCES) - 1;
+    if (samples_per_batch == 0 || instance_mask == 0) {
+        return false;
+    }
+
+    // round up to whole messages
+    samples_per_batch = ((samples_per_batch + INS_BATCH_SAMPLES_PER_MSG - 1) /
+                         INS_BATCH_SAMPLES_PER_MSG) * INS_BATCH_SAMPLES_PER_MSG;
+
+    _data_x = new int16_t[samples_per_batch];
+    _data_y = new int16_t[samples_per_batch];
+    _data_z = new int16_t[samples_per_batch];
+    if (_data_x == nullptr || _data_y == nullptr || _data_z == nullptr) {
+        return false;
+    }
+
+    _samples_per_batch = samples_per_batch;
+    _instance_mask = instance_mask;
+
+    // start with the accel of the lowest instance in the mask
+    _instance = 0;
+    while (!(_instance_mask & (1U << _instance))) {
+        _instance++;
+    }
+    _type = SENSOR_ACCEL;
+    _multiplier = BATCH_MULTIPLIER_ACCEL;
+    _capture_start_ms = AP_HAL::millis();
+    _write_offset = 0;
+
+    return true;
+}
+
+void BatchSampler::sample(uint8_t instance, enum sensor_type type, const Vector3f &sample,
+                          uint64_t sample_us, uint16_t sample_rate_hz)
+{
+    const uint16_t offset = _write_offset;
+    if (offset >= _samples_per_batch || instance != _instance || type != _type) {
+        return;
+    }
+    if (offset == 0) {
+        _first_sample_us = sample_us ? sample_us : AP_HAL::micros64();
+        _sample_rate_hz = sample_rate_hz;
+    }
+    _data_x[offset] = constrain_int32(sample.x * _multiplier, INT16_MIN, INT16_MAX);
+    _data_y[offset] = constrain_int32(sample.y * _multiplier, INT16_MIN, INT16_MAX);
+    _data_z[offset] = constrain_int32(sample.z * _multiplier, INT16_MIN, INT16_MAX);
+    _write_offset = offset + 1;
+}
+
+void BatchSampler::_next_sensor(void)
+{
+    if (_type == SENSOR_ACCEL) {
+        _type = SENSOR_GYRO;
+        _multiplier = BATCH_MULTIPLIER_GYRO;
+    } else {
+        _type = SENSOR_ACCEL;
+        _multiplier = BATCH_MULTIPLIER_ACCEL;
+        do {
+            _instance = (_instance + 1) % INS_MAX_INSTANCES;
+        } while (!(_instance_mask & (1U << _instance)));
+    }
+    _read_offset = 0;
+    _header_written = false;
+    _capture_start_ms = AP_HAL::millis();
+
+    // restarting the capture must come last, the timer thread starts
+    // filling the batch as soon as it sees this
+    _write_offset = 0;
+}
+
+void BatchSampler::periodic(DataFlash_Class *dataflash)
+{
+    if (_samples_per_batch == 0) {
+        return;
+    }
+
+    if (_write_offset < _samples_per_batch) {
+        // still capturing. Skip sensors that don't exist or have stopped
+        if (_write_offset == 0 &&
+            AP_HAL::millis() - _capture_start_ms > BATCH_CAPTURE_TIMEOUT_MS) {
+            _next_sensor();
+        }
+        return;
+    }
+
+    // the batch is full, hold it until it can be logged
+    if (dataflash == nullptr || !dataflash->logging_started()) {
+        return;
+    }
+
+    if (!_header_written) {
+        if (dataflash->bufferspace_available() < BATCH_MIN_BUFFER_SPACE) {
+            return;
+        }
+        struct log_ISBH pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_ISBH_MSG),
+            time_us        : AP_HAL::micros64(),
+            seqno          : _isb_seqno,
+            sensor_type    : (uint8_t)_type,
+            instance       : _instance,
+            multiplier     : _multiplier,
+            sample_count   : _samples_per_batch,
+            sample_us      : _first_sample_us,
+            sample_rate_hz : (float)_sample_rate_hz
+        };
+        dataflash->WriteBlock(&pkt, sizeof(pkt));
+        _header_written = true;
+    }
+
+    for (uint8_t i = 0; i < BATCH_MAX_MSGS_PER_UPDATE && _read_offset < _samples_per_batch; i++) {
+        if (dataflash->bufferspace_available() < BATCH_MIN_BUFFER_SPACE) {
+            return;
+        }
+        struct log_ISBD pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_ISBD_MSG),
+            time_us   : AP_HAL::micros64(),
+            isb_seqno : _isb_seqno,
+            seqno     : (uint16_t)(_read_offset / INS_BATCH_SAMPLES_PER_MSG)
+        };
+        memcpy(pkt.x, &_data_x[_read_offset], sizeof(pkt.x));
+        memcpy(pkt.y, &_data_y[_read_offset], sizeof(pkt.y));
+        memcpy(pkt.z, &_data_z[_read_offset], sizeof(pkt.z));
+        dataflash->WriteBlock(&pkt, sizeof(pkt));
+        _read_offset += INS_BATCH_SAMPLES_PER_MSG;
+    }
+
+    if (_read_offset >= _samples_per_batch) {
+        _isb_seqno++;
+        _next_sensor();
+    }
+}
+
+#endif // INS_BATCH_SAMPLER_ENABLED
@@ -0,0 +1,92 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  burst capture of raw IMU samples for offline spectral analysis
+
+  A batch of samples of one sensor is captured at the full backend
+  rate into a preallocated buffer from the timer thread. Once the
+  batch is full, capture stops and the main thread writes it to
+  DataFlash as an ISBH header followed by ISBD blocks, a few blocks
+  per update and only while the logger has spare buffer space. When
+  the batch has been written, capture moves on to the next sensor:
+  accel then gyro of each instance selected in the mask.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#define INS_BATCH_SAMPLER_ENABLED (HAL_CPU_CLASS >= HAL_CPU_CLASS_150)
+
+#if INS_BATCH_SAMPLER_ENABLED
+
+// samples per ISBD message, must match log_ISBD
+#define INS_BATCH_SAMPLES_PER_MSG 32
+
+class DataFlash_Class;
+
+class BatchSampler
+{
+public:
+    enum sensor_type {
+        SENSOR_ACCEL = 0,
+        SENSOR_GYRO  = 1,
+    };
+
+    BatchSampler();
+    ~BatchSampler();
+
+    // allocate a batch of at least samples_per_batch samples, rounded
+    // up to whole ISBD messages
+    bool init(uint16_t samples_per_batch, uint8_t instance_mask);
+
+    // add a raw sample, called from the backends at the raw rate
+    void sample(uint8_t instance, enum sensor_type type, const Vector3f &sample,
+                uint64_t sample_us, uint16_t sample_rate_hz);
+
+    // write out a full batch, called from the main thread
+    void periodic(DataFlash_Class *dataflash);
+
+private:
+    // move capture to the next sensor
+    void _next_sensor(void);
+
+    int16_t *_data_x;
+    int16_t *_data_y;
+    int16_t *_data_z;
+    uint16_t _samples_per_batch;
+    uint8_t _instance_mask;
+
+    // sensor being captured
+    enum sensor_type _type;
+    uint8_t _instance;
+    uint16_t _multiplier;
+
+    // written by the timer thread until the batch is full, then only
+    // reset by the main thread
+    volatile uint16_t _write_offset;
+    uint64_t _first_sample_us;
+    uint16_t _sample_rate_hz;
+    uint32_t _capture_start_ms;
+
+    // main thread state while writing the batch
+    uint16_t _read_offset;
+    uint16_t _isb_seqno;
+    bool _header_written;
+};
+
+#endif // INS_BATCH_SAMPLER_ENABLED
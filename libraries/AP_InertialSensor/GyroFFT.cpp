@@ -0,0 +1,290 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GyroFFT.h"
+
+#if GYRO_FFT_ENABLED
+
+extern const AP_HAL::HAL& hal;
+
+GyroFFT::GyroFFT() :
+    _frames{},
+    _fill_frame(0),
+    _fill_count(0),
+    _frame_ready(false),
+    _raw_rate_hz(0),
+    _decimation(1),
+    _decimation_count(0),
+    _frame_rate_hz(0),
+    _ready_rate_hz(0),
+    _window(nullptr),
+    _cos(nullptr),
+    _sin(nullptr),
+    _bitrev(nullptr),
+    _re(nullptr),
+    _im(nullptr),
+    _frames_analysed(0),
+    _frames_dropped(0)
+{
+}
+
+GyroFFT::~GyroFFT()
+{
+    for (uint8_t f = 0; f < 2; f++) {
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            delete[] _frames[f][axis];
+        }
+    }
+    delete[] _window;
+    delete[] _cos;
+    delete[] _sin;
+    delete[] _bitrev;
+    delete[] _re;
+    delete[] _im;
+}
+
+bool GyroFFT::init(void)
+{
+    for (uint8_t f = 0; f < 2; f++) {
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            _frames[f][axis] = new float[N];
+            if (_frames[f][axis] == nullptr) {
+                return false;
+            }
+        }
+    }
+    _window = new float[N];
+    _cos = new float[M];
+    _sin = new float[M];
+    _bitrev = new uint16_t[M];
+    _re = new float[M + 1];
+    _im = new float[M + 1];
+    if (_window == nullptr || _cos == nullptr || _sin == nullptr ||
+        _bitrev == nullptr || _re == nullptr || _im == nullptr) {
+        return false;
+    }
+
+    // Hann window
+    for (uint16_t i = 0; i < N; i++) {
+        _window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / (N - 1));
+    }
+
+    // twiddles for the N point real transform, every second one is
+    // also a twiddle of the M point complex transform
+    for (uint16_t k = 0; k < M; k++) {
+        _cos[k] = cosf(2.0f * M_PI * k / N);
+        _sin[k] = -sinf(2.0f * M_PI * k / N);
+    }
+
+    uint8_t bits = 0;
+    while ((1U << bits) < M) {
+        bits++;
+    }
+    for (uint16_t i = 0; i < M; i++) {
+        uint16_t r = 0;
+        for (uint8_t b = 0; b < bits; b++) {
+            if (i & (1U << b)) {
+                r |= 1U << (bits - 1 - b);
+            }
+        }
+        _bitrev[i] = r;
+    }
+
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&GyroFFT::_io_update, void));
+
+    return true;
+}
+
+/*
+  decimate and buffer a raw gyro sample. Called from the timer thread
+ */
+void GyroFFT::sample(const Vector3f &gyro, uint16_t sample_rate_hz)
+{
+    if (sample_rate_hz != _raw_rate_hz) {
+        // new or changed source, restart the frame
+        _raw_rate_hz = sample_rate_hz;
+        _decimation = MAX((sample_rate_hz + GYRO_FFT_MAX_RATE_HZ - 1) / GYRO_FFT_MAX_RATE_HZ, 1);
+        _frame_rate_hz = (float)sample_rate_hz / _decimation;
+        _decimation_count = 0;
+        _decimation_sum.zero();
+        _fill_count = 0;
+    }
+
+    _decimation_sum += gyro;
+    if (++_decimation_count < _decimation) {
+        return;
+    }
+    const Vector3f avg = _decimation_sum / _decimation;
+    _decimation_count = 0;
+    _decimation_sum.zero();
+
+    _frames[_fill_frame][0][_fill_count] = avg.x;
+    _frames[_fill_frame][1][_fill_count] = avg.y;
+    _frames[_fill_frame][2][_fill_count] = avg.z;
+    if (++_fill_count < N) {
+        return;
+    }
+    _fill_count = 0;
+
+    if (_frame_ready) {
+        // the IO thread has not finished with the last frame, so
+        // refill this one
+        _frames_dropped++;
+        return;
+    }
+    _ready_rate_hz = _frame_rate_hz;
+    _fill_frame ^= 1;
+    _frame_ready = true;
+}
+
+/*
+  analyse the last complete frame. Called from the IO thread
+ */
+void GyroFFT::_io_update(void)
+{
+    if (!_frame_ready) {
+        return;
+    }
+
+    // the timer thread fills the other frame until we clear _frame_ready
+    const uint8_t frame = _fill_frame ^ 1;
+    Vector3f peak_freq, peak_energy, total_energy;
+
+    _analyse_axis(_frames[frame][0], peak_freq.x, peak_energy.x, total_energy.x);
+    _analyse_axis(_frames[frame][1], peak_freq.y, peak_energy.y, total_energy.y);
+    _analyse_axis(_frames[frame][2], peak_freq.z, peak_energy.z, total_energy.z);
+
+    _peak_freq = peak_freq;
+    _peak_energy = peak_energy;
+    _total_energy = total_energy;
+    _frames_analysed++;
+
+    _frame_ready = false;
+}
+
+void GyroFFT::_analyse_axis(const float *samples, float &peak_freq,
+                            float &peak_energy, float &total_energy)
+{
+    // remove the mean so the vehicle's rotation does not leak into
+    // the low bins, then pack even/odd samples as real/imaginary
+    float mean = 0;
+    for (uint16_t i = 0; i < N; i++) {
+        mean += samples[i];
+    }
+    mean /= N;
+    for (uint16_t i = 0; i < M; i++) {
+        const uint16_t r = _bitrev[i];
+        _re[r] = (samples[2*i] - mean) * _window[2*i];
+        _im[r] = (samples[2*i+1] - mean) * _window[2*i+1];
+    }
+
+    _complex_fft();
+    _re[M] = _re[0];
+    _im[M] = _im[0];
+
+    /*
+      split the M point complex transform into bins 0..M of the N
+      point real transform and find the strongest one. Bins k and M-k
+      are computed together so the work buffers can be reused in place
+     */
+    const float bin_hz = _ready_rate_hz / N;
+    const uint16_t min_bin = MAX((uint16_t)(GYRO_FFT_MIN_FREQ_HZ / bin_hz), 1);
+    // scale so the sum over all bins is the mean square of the signal,
+    // 0.375 is the mean square of the Hann window
+    const float scale = 2.0f / (N * N * 0.375f);
+
+    uint16_t peak_bin = 0;
+    float peak_power = 0;
+    float peak_prev = 0, peak_next = 0;
+    total_energy = 0;
+
+    for (uint16_t k = 0; k <= M/2; k++) {
+        const uint16_t j = M - k;
+        const float zr_k = _re[k], zi_k = _im[k];
+        const float zr_j = _re[j], zi_j = _im[j];
+
+        // even and odd sample spectra
+        const float er = 0.5f * (zr_k + zr_j), ei = 0.5f * (zi_k - zi_j);
+        const float or_ = 0.5f * (zi_k + zi_j), oi = -0.5f * (zr_k - zr_j);
+
+        // X[k] = E[k] + W^k O[k], X[M-k] = conj(E[k]) - W^(M-k) conj(O[k])
+        const float wr = _cos[k], wi = _sin[k];
+        const float xr_k = er + wr * or_ - wi * oi;
+        const float xi_k = ei + wr * oi + wi * or_;
+        const float xr_j = er - (wr * or_ - wi * oi);
+        const float xi_j = -ei + (wr * oi + wi * or_);
+
+        _re[k] = (xr_k * xr_k + xi_k * xi_k) * scale;
+        _re[j] = (xr_j * xr_j + xi_j * xi_j) * scale;
+    }
+
+    // _re[] now holds the power of bins 0..M
+    float prev_power = _re[min_bin-1];
+    for (uint16_t k = min_bin; k < M; k++) {
+        const float power = _re[k];
+        total_energy += power;
+        if (power > peak_power) {
+            peak_power = power;
+            peak_bin = k;
+            peak_prev = prev_power;
+            peak_next = _re[k+1];
+        }
+        prev_power = power;
+    }
+
+    if (peak_bin == 0) {
+        peak_freq = 0;
+        peak_energy = 0;
+        return;
+    }
+
+    // quadratic interpolation of the peak position between bins
+    float offset = 0;
+    const float denom = peak_prev - 2.0f * peak_power + peak_next;
+    if (!is_zero(denom)) {
+        offset = constrain_float(0.5f * (peak_prev - peak_next) / denom, -0.5f, 0.5f);
+    }
+    peak_freq = (peak_bin + offset) * bin_hz;
+    peak_energy = peak_power + peak_prev + peak_next;
+}
+
+/*
+  iterative radix-2 decimation in time FFT over _re/_im, which must
+  already be in bit reversed order
+ */
+void GyroFFT::_complex_fft(void)
+{
+    for (uint16_t len = 2; len <= M; len <<= 1) {
+        const uint16_t half = len / 2;
+        // twiddle step in the N point table
+        const uint16_t step = N / len;
+        for (uint16_t i = 0; i < M; i += len) {
+            for (uint16_t k = 0; k < half; k++) {
+                const float wr = _cos[k * step];
+                const float wi = _sin[k * step];
+                const uint16_t a = i + k;
+                const uint16_t b = a + half;
+                const float tr = _re[b] * wr - _im[b] * wi;
+                const float ti = _re[b] * wi + _im[b] * wr;
+                _re[b] = _re[a] - tr;
+                _im[b] = _im[a] - ti;
+                _re[a] += tr;
+                _im[a] += ti;
+            }
+        }
+    }
+}
+
+#endif // GYRO_FFT_ENABLED
@@ -0,0 +1,111 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  onboard spectrum analyser for the primary gyro
+
+  Raw gyro samples are decimated to at most GYRO_FFT_MAX_RATE_HZ and
+  collected into frames of GYRO_FFT_WINDOW_SIZE samples from the timer
+  thread. Complete frames are handed to the IO thread, which runs a Hann
+  windowed radix-2 real FFT per axis and publishes the frequency and
+  energy of the strongest peak plus the total noise energy.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#define GYRO_FFT_ENABLED (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
+
+#if GYRO_FFT_ENABLED
+
+// must be a power of 2
+#define GYRO_FFT_WINDOW_SIZE 256
+#define GYRO_FFT_MAX_RATE_HZ 2000
+// peaks below this are vehicle motion rather than noise
+#define GYRO_FFT_MIN_FREQ_HZ 20
+
+class GyroFFT
+{
+public:
+    GyroFFT();
+    ~GyroFFT();
+
+    // allocate buffers and start the IO process. Returns false if
+    // there is not enough memory
+    bool init(void);
+
+    // add a raw gyro sample, called from the backends at the raw rate
+    void sample(const Vector3f &gyro, uint16_t sample_rate_hz);
+
+    // true once at least one frame has been analysed
+    bool healthy(void) const { return _frames_analysed != 0; }
+
+    // frequency in Hz of the strongest peak on each axis
+    const Vector3f &get_peak_freq(void) const { return _peak_freq; }
+
+    // power of the strongest peak and total power above
+    // GYRO_FFT_MIN_FREQ_HZ on each axis, in (rad/s)^2
+    const Vector3f &get_peak_energy(void) const { return _peak_energy; }
+    const Vector3f &get_total_energy(void) const { return _total_energy; }
+
+    // number of frames analysed and dropped because the IO thread was busy
+    uint32_t get_frames_analysed(void) const { return _frames_analysed; }
+    uint32_t get_frames_dropped(void) const { return _frames_dropped; }
+
+private:
+    static const uint16_t N = GYRO_FFT_WINDOW_SIZE;
+    static const uint16_t M = GYRO_FFT_WINDOW_SIZE / 2;
+
+    void _io_update(void);
+
+    // transform one axis of the ready frame and find its peak
+    void _analyse_axis(const float *samples, float &peak_freq,
+                       float &peak_energy, float &total_energy);
+
+    // in place complex FFT of M points in _re/_im
+    void _complex_fft(void);
+
+    // filled by the timer thread, two frames of N samples per axis
+    float *_frames[2][3];
+    uint8_t _fill_frame;
+    uint16_t _fill_count;
+    volatile bool _frame_ready;
+
+    // decimation of the raw samples
+    uint16_t _raw_rate_hz;
+    uint8_t _decimation;
+    uint8_t _decimation_count;
+    Vector3f _decimation_sum;
+    float _frame_rate_hz;
+    float _ready_rate_hz;
+
+    // tables and work buffers for the IO thread
+    float *_window;
+    float *_cos;
+    float *_sin;
+    uint16_t *_bitrev;
+    float *_re;
+    float *_im;
+
+    Vector3f _peak_freq;
+    Vector3f _peak_energy;
+    Vector3f _total_energy;
+    uint32_t _frames_analysed;
+    uint32_t _frames_dropped;
+};
+
+#endif // GYRO_FFT_ENABLED
@@ -14,6 +14,7 @@
 #include "vector2.h"
 #include "vector3.h"
 #include "matrix3.h"
+#include "rotation_cache.h"
 #include "quaternion.h"
 #include "polygon.h"
 #include "edc.h"
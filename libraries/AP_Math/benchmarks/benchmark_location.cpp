@@ -0,0 +1,129 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  N/E offsets of a mission sized array of locations from home, with
+  the free functions and with LocationCache
+ */
+
+#define BENCH_NUM_LOCATIONS 64
+
+static Location home;
+static Location locations[BENCH_NUM_LOCATIONS];
+
+static void setup_locations()
+{
+    home = {};
+    home.lat = -353632610;
+    home.lng = 1491652300;
+    for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+        locations[i] = home;
+        locations[i].lat += i * 1000 - 32000;
+        locations[i].lng += i * 3000 - 96000;
+    }
+}
+
+static void BM_LocationDiff(benchmark::State& state)
+{
+    setup_locations();
+    Vector2f ne[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+            ne[i] = location_diff(home, locations[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationCacheNEOffset(benchmark::State& state)
+{
+    setup_locations();
+    const LocationCache cache(home);
+    Vector2f ne[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+            ne[i] = cache.ne_offset(locations[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationCacheNEOffsets(benchmark::State& state)
+{
+    setup_locations();
+    const LocationCache cache(home);
+    Vector2f ne[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        cache.ne_offsets(locations, ne, BENCH_NUM_LOCATIONS);
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationCacheNEOffsetDouble(benchmark::State& state)
+{
+    setup_locations();
+    const LocationCache cache(home);
+    Vector2d ne[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+            ne[i] = cache.ne_offset_double(locations[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationCacheNEOffsetCm(benchmark::State& state)
+{
+    setup_locations();
+    const LocationCache cache(home);
+    Vector2l ne[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+            ne[i] = cache.ne_offset_cm(locations[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_GetDistance(benchmark::State& state)
+{
+    setup_locations();
+    float dist[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+            dist[i] = get_distance(home, locations[i]);
+        }
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_LocationCacheGetDistance(benchmark::State& state)
+{
+    setup_locations();
+    const LocationCache cache(home);
+    float dist[BENCH_NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_NUM_LOCATIONS; i++) {
+            dist[i] = cache.get_distance(locations[i]);
+        }
+        gbenchmark_escape(dist);
+    }
+}
+
+BENCHMARK(BM_LocationDiff);
+BENCHMARK(BM_LocationCacheNEOffset);
+BENCHMARK(BM_LocationCacheNEOffsets);
+BENCHMARK(BM_LocationCacheNEOffsetDouble);
+BENCHMARK(BM_LocationCacheNEOffsetCm);
+BENCHMARK(BM_GetDistance);
+BENCHMARK(BM_LocationCacheGetDistance);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,176 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+
+/*
+  compare MatrixN with the float* functions in matrix_alg.cpp at the
+  sizes used by the calibrators
+ */
+
+// symmetric positive definite, like the damped normal equations of a fit
+template <uint8_t N>
+static void fill_spd(float *m)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            m[i*N+j] = 1.0f / (1 + i + j);
+        }
+        m[i*N+i] += N;
+    }
+}
+
+template <uint8_t N>
+static void fill_spd(MatrixN<float,N,N> &m)
+{
+    float v[N*N];
+    fill_spd<N>(v);
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            m[i][j] = v[i*N+j];
+        }
+    }
+}
+
+static void BM_MatMul9(benchmark::State& state)
+{
+    float a[81], b[81];
+    fill_spd<9>(a);
+    fill_spd<9>(b);
+
+    while (state.KeepRunning()) {
+        float *c = mat_mul(a, b, 9);
+        gbenchmark_escape(c);
+        delete[] c;
+    }
+}
+
+static void BM_MatrixNMul9(benchmark::State& state)
+{
+    MatrixN<float,9,9> a, b;
+    fill_spd<9>(a);
+    fill_spd<9>(b);
+
+    while (state.KeepRunning()) {
+        MatrixN<float,9,9> c = a * b;
+        gbenchmark_escape(&c);
+    }
+}
+
+static void BM_Inverse9(benchmark::State& state)
+{
+    float a[81], inv[81];
+    fill_spd<9>(a);
+
+    while (state.KeepRunning()) {
+        bool ok = inverse(a, inv, 9);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(inv);
+    }
+}
+
+static void BM_MatrixNInverse9(benchmark::State& state)
+{
+    MatrixN<float,9,9> a, inv;
+    fill_spd<9>(a);
+
+    while (state.KeepRunning()) {
+        bool ok = a.inverse(inv);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&inv);
+    }
+}
+
+// what the calibrators used to do: invert, then multiply
+static void BM_InverseSolve9(benchmark::State& state)
+{
+    float a[81], inv[81], b[9], x[9];
+    fill_spd<9>(a);
+    for (uint8_t i = 0; i < 9; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        bool ok = inverse(a, inv, 9);
+        for (uint8_t i = 0; i < 9; i++) {
+            x[i] = 0;
+            for (uint8_t j = 0; j < 9; j++) {
+                x[i] += inv[i*9+j] * b[j];
+            }
+        }
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(x);
+    }
+}
+
+static void BM_MatrixNSolve9(benchmark::State& state)
+{
+    MatrixN<float,9,9> a;
+    VectorN<float,9> b, x;
+    fill_spd<9>(a);
+    for (uint8_t i = 0; i < 9; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        bool ok = a.solve(b, x);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&x);
+    }
+}
+
+static void BM_MatrixNCholeskySolve9(benchmark::State& state)
+{
+    MatrixN<float,9,9> a;
+    VectorN<float,9> b, x;
+    fill_spd<9>(a);
+    for (uint8_t i = 0; i < 9; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        bool ok = a.cholesky_solve(b, x);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&x);
+    }
+}
+
+static void BM_Inverse4(benchmark::State& state)
+{
+    float a[16], inv[16];
+    fill_spd<4>(a);
+
+    while (state.KeepRunning()) {
+        bool ok = inverse(a, inv, 4);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(inv);
+    }
+}
+
+static void BM_MatrixNCholeskySolve4(benchmark::State& state)
+{
+    MatrixN<float,4,4> a;
+    VectorN<float,4> b, x;
+    fill_spd<4>(a);
+    for (uint8_t i = 0; i < 4; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        bool ok = a.cholesky_solve(b, x);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&x);
+    }
+}
+
+BENCHMARK(BM_MatMul9);
+BENCHMARK(BM_MatrixNMul9);
+BENCHMARK(BM_Inverse9);
+BENCHMARK(BM_MatrixNInverse9);
+BENCHMARK(BM_InverseSolve9);
+BENCHMARK(BM_MatrixNSolve9);
+BENCHMARK(BM_MatrixNCholeskySolve9);
+BENCHMARK(BM_Inverse4);
+BENCHMARK(BM_MatrixNCholeskySolve4);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,87 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  point in polygon and distance to boundary queries on a fence with
+  hundreds of vertices, with Polygon_outside() and with PolygonIndex
+ */
+
+#define BENCH_NUM_POINTS 301
+#define BENCH_NUM_QUERIES 64
+
+static Vector2l fence[BENCH_NUM_POINTS];
+static Vector2l queries[BENCH_NUM_QUERIES];
+
+static void setup_fence()
+{
+    for (unsigned i = 0; i < BENCH_NUM_POINTS-1; i++) {
+        const float angle = i * (2 * M_PI / (BENCH_NUM_POINTS-1));
+        const float radius = (i % 2) ? 380000 : 420000;
+        fence[i].x = -353632610 + radius * cosf(angle);
+        fence[i].y = 1491652300 + radius * sinf(angle);
+    }
+    fence[BENCH_NUM_POINTS-1] = fence[0];
+    for (unsigned i = 0; i < BENCH_NUM_QUERIES; i++) {
+        queries[i].x = -353632610 + (int32_t)(i * 15731) % 900000 - 450000;
+        queries[i].y = 1491652300 + (int32_t)(i * 27449) % 900000 - 450000;
+    }
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    setup_fence();
+
+    while (state.KeepRunning()) {
+        for (unsigned i = 0; i < BENCH_NUM_QUERIES; i++) {
+            bool outside = Polygon_outside(queries[i], fence, BENCH_NUM_POINTS);
+            gbenchmark_escape(&outside);
+        }
+    }
+}
+
+static void BM_PolygonIndexOutside(benchmark::State& state)
+{
+    setup_fence();
+    PolygonIndex index;
+    index.build(fence, BENCH_NUM_POINTS);
+
+    while (state.KeepRunning()) {
+        for (unsigned i = 0; i < BENCH_NUM_QUERIES; i++) {
+            bool outside = index.outside(queries[i]);
+            gbenchmark_escape(&outside);
+        }
+    }
+}
+
+static void BM_PolygonIndexDistance(benchmark::State& state)
+{
+    setup_fence();
+    PolygonIndex index;
+    index.build(fence, BENCH_NUM_POINTS);
+
+    while (state.KeepRunning()) {
+        for (unsigned i = 0; i < BENCH_NUM_QUERIES; i++) {
+            float distance = index.distance_to_boundary(queries[i]);
+            gbenchmark_escape(&distance);
+        }
+    }
+}
+
+static void BM_PolygonIndexBuild(benchmark::State& state)
+{
+    setup_fence();
+
+    while (state.KeepRunning()) {
+        PolygonIndex index;
+        bool ok = index.build(fence, BENCH_NUM_POINTS);
+        gbenchmark_escape(&ok);
+    }
+}
+
+BENCHMARK(BM_PolygonOutside);
+BENCHMARK(BM_PolygonIndexOutside);
+BENCHMARK(BM_PolygonIndexDistance);
+BENCHMARK(BM_PolygonIndexBuild);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,66 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  rotating a buffer of sensor samples by a board orientation with
+  Vector3::rotate() and with RotationCache
+ */
+
+#define BENCH_NUM_SAMPLES 32
+
+static void setup_samples(Vector3f *v)
+{
+    for (uint8_t i = 0; i < BENCH_NUM_SAMPLES; i++) {
+        v[i] = Vector3f(0.1f * i, -0.2f * i, 9.8f + 0.01f * i);
+    }
+}
+
+static void BM_Vector3Rotate(benchmark::State& state)
+{
+    Vector3f v[BENCH_NUM_SAMPLES];
+    setup_samples(v);
+    enum Rotation rotation = (enum Rotation)state.range_x();
+    gbenchmark_escape(&rotation);
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_NUM_SAMPLES; i++) {
+            v[i].rotate(rotation);
+        }
+        gbenchmark_escape(v);
+    }
+}
+
+static void BM_RotationCacheRotate(benchmark::State& state)
+{
+    Vector3f v[BENCH_NUM_SAMPLES];
+    setup_samples(v);
+    RotationCache cache;
+    cache.set((enum Rotation)state.range_x());
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_NUM_SAMPLES; i++) {
+            cache.rotate(v[i]);
+        }
+        gbenchmark_escape(v);
+    }
+}
+
+static void BM_RotationCacheRotateMany(benchmark::State& state)
+{
+    Vector3f v[BENCH_NUM_SAMPLES];
+    setup_samples(v);
+    RotationCache cache;
+    cache.set((enum Rotation)state.range_x());
+
+    while (state.KeepRunning()) {
+        cache.rotate(v, BENCH_NUM_SAMPLES);
+        gbenchmark_escape(v);
+    }
+}
+
+BENCHMARK(BM_Vector3Rotate)->Arg(ROTATION_YAW_90)->Arg(ROTATION_ROLL_90_PITCH_180_YAW_90);
+BENCHMARK(BM_RotationCacheRotate)->Arg(ROTATION_YAW_90)->Arg(ROTATION_ROLL_90_PITCH_180_YAW_90);
+BENCHMARK(BM_RotationCacheRotateMany)->Arg(ROTATION_YAW_90)->Arg(ROTATION_ROLL_90_PITCH_180_YAW_90);
+
+BENCHMARK_MAIN()
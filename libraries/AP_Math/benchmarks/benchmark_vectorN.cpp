@@ -0,0 +1,85 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/vectorN.h>
+
+/*
+  a + b*k - c on a vector the size of the EKF state, as an expression,
+  as the step by step temporaries the member operators used to make,
+  and as a hand written loop
+ */
+
+#define BENCH_VECTOR_SIZE 24
+
+typedef VectorN<float,BENCH_VECTOR_SIZE> BenchVector;
+
+static void fill(BenchVector &a, BenchVector &b, BenchVector &c)
+{
+    for (uint8_t i = 0; i < BENCH_VECTOR_SIZE; i++) {
+        a[i] = i;
+        b[i] = 0.5f * i;
+        c[i] = BENCH_VECTOR_SIZE - i;
+    }
+}
+
+static void BM_VectorNExpression(benchmark::State& state)
+{
+    BenchVector a, b, c;
+    fill(a, b, c);
+    float k = 0.1f;
+    gbenchmark_escape(&k);
+
+    while (state.KeepRunning()) {
+        BenchVector r = a + b*k - c;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_VectorNTemporaries(benchmark::State& state)
+{
+    BenchVector a, b, c;
+    fill(a, b, c);
+    float k = 0.1f;
+    gbenchmark_escape(&k);
+
+    while (state.KeepRunning()) {
+        BenchVector bk;
+        bk = b;
+        bk *= k;
+        gbenchmark_escape(&bk);
+        BenchVector sum;
+        sum = a;
+        sum += bk;
+        gbenchmark_escape(&sum);
+        BenchVector r;
+        r = sum;
+        r -= c;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_VectorNLoop(benchmark::State& state)
+{
+    float a[BENCH_VECTOR_SIZE], b[BENCH_VECTOR_SIZE], c[BENCH_VECTOR_SIZE];
+    for (uint8_t i = 0; i < BENCH_VECTOR_SIZE; i++) {
+        a[i] = i;
+        b[i] = 0.5f * i;
+        c[i] = BENCH_VECTOR_SIZE - i;
+    }
+    float k = 0.1f;
+    gbenchmark_escape(&k);
+
+    while (state.KeepRunning()) {
+        float r[BENCH_VECTOR_SIZE];
+        for (uint8_t i = 0; i < BENCH_VECTOR_SIZE; i++) {
+            r[i] = a[i] + b[i]*k - c[i];
+        }
+        gbenchmark_escape(r);
+    }
+}
+
+BENCHMARK(BM_VectorNExpression);
+BENCHMARK(BM_VectorNTemporaries);
+BENCHMARK(BM_VectorNLoop);
+
+BENCHMARK_MAIN()
@@ -30,6 +30,10 @@
 #define LOCATION_SCALING_FACTOR 0.011131884502145034f
 // inverse of LOCATION_SCALING_FACTOR
 #define LOCATION_SCALING_FACTOR_INV 89.83204953368922f
+// LOCATION_SCALING_FACTOR in double precision
+#define LOCATION_SCALING_FACTOR_DOUBLE 0.011131884502145034
+// LOCATION_SCALING_FACTOR in centimeters, Q24
+#define LOCATION_SCALING_FACTOR_CM_Q24 18676203
 
 float longitude_scale(const struct Location &loc)
 {
@@ -149,6 +153,83 @@ Vector2f location_diff(const struct Location &loc1, const struct Location &loc2)
                     (loc2.lng - loc1.lng) * LOCATION_SCALING_FACTOR * longitude_scale(loc1));
 }
 
+LocationCache::LocationCache()
+{
+    Location origin {};
+    set_origin(origin);
+}
+
+LocationCache::LocationCache(const struct Location &origin)
+{
+    set_origin(origin);
+}
+
+void LocationCache::set_origin(const struct Location &origin)
+{
+    _origin = origin;
+    _lng_scale = longitude_scale(origin);
+    // same limit as longitude_scale(), without rounding to float
+    _lng_scale_double = cos(origin.lat * 1.0e-7 * DEG_TO_RAD_DOUBLE);
+    if (_lng_scale_double < 0.01) {
+        _lng_scale_double = 0.01;
+    }
+    _lng_cm_q24 = LOCATION_SCALING_FACTOR_CM_Q24 * _lng_scale_double + 0.5;
+}
+
+Vector2f LocationCache::ne_offset(const struct Location &loc) const
+{
+    return Vector2f((loc.lat - _origin.lat) * LOCATION_SCALING_FACTOR,
+                    (loc.lng - _origin.lng) * LOCATION_SCALING_FACTOR * _lng_scale);
+}
+
+Vector2d LocationCache::ne_offset_double(const struct Location &loc) const
+{
+    // differences in 64 bit so distant longitudes cannot overflow
+    const int64_t dlat = (int64_t)loc.lat - _origin.lat;
+    const int64_t dlng = (int64_t)loc.lng - _origin.lng;
+    return Vector2d(dlat * LOCATION_SCALING_FACTOR_DOUBLE,
+                    dlng * LOCATION_SCALING_FACTOR_DOUBLE * _lng_scale_double);
+}
+
+Vector2l LocationCache::ne_offset_cm(const struct Location &loc) const
+{
+    const int64_t dlat = (int64_t)loc.lat - _origin.lat;
+    const int64_t dlng = (int64_t)loc.lng - _origin.lng;
+    // round to nearest
+    return Vector2l((dlat * LOCATION_SCALING_FACTOR_CM_Q24 + (1<<23)) >> 24,
+                    (dlng * _lng_cm_q24 + (1<<23)) >> 24);
+}
+
+void LocationCache::ne_offsets(const struct Location *locs, Vector2f *ne, uint16_t count) const
+{
+    const float lng_factor = LOCATION_SCALING_FACTOR * _lng_scale;
+    const int32_t lat0 = _origin.lat;
+    const int32_t lng0 = _origin.lng;
+    for (uint16_t i=0; i<count; i++) {
+        ne[i].x = (locs[i].lat - lat0) * LOCATION_SCALING_FACTOR;
+        ne[i].y = (locs[i].lng - lng0) * lng_factor;
+    }
+}
+
+float LocationCache::get_distance(const struct Location &loc) const
+{
+    return ne_offset(loc).length();
+}
+
+int32_t LocationCache::get_bearing_cd(const struct Location &loc) const
+{
+    const Vector2f ne = ne_offset(loc);
+    int32_t bearing = 9000 + atan2f(-ne.x, ne.y) * 5729.57795f;
+    if (bearing < 0) bearing += 36000;
+    return bearing;
+}
+
+void LocationCache::offset(struct Location &loc, float ofs_north, float ofs_east) const
+{
+    loc.lat = _origin.lat + (int32_t)(ofs_north * LOCATION_SCALING_FACTOR_INV);
+    loc.lng = _origin.lng + (int32_t)((ofs_east * LOCATION_SCALING_FACTOR_INV) / _lng_scale);
+}
+
 /*
   wrap an angle in centi-degrees to 0..35999
  */
@@ -79,3 +79,55 @@ void        wgsllh2ecef(const Vector3d &llh, Vector3d &ecef);
 // coordinates (lat, lon, height)
 void        wgsecef2llh(const Vector3d &ecef, Vector3d &llh);
 
+
+/*
+  Location maths relative to a fixed reference point, for code that
+  works out many offsets from the same origin (e.g. a fence or mission
+  against home). The longitude scale is computed once in set_origin()
+  rather than with a cosf() in every call, and is always taken at the
+  origin, as in location_diff().
+
+  ne_offset() matches location_diff(). ne_offset_double() avoids float
+  rounding, which reaches meters at long range, and ne_offset_cm()
+  gives centimeters using 64 bit integer maths.
+ */
+class LocationCache
+{
+public:
+    LocationCache();
+    LocationCache(const struct Location &origin);
+
+    // set the reference point and compute its longitude scale
+    void set_origin(const struct Location &origin);
+
+    const struct Location &get_origin() const { return _origin; }
+    float get_longitude_scale() const { return _lng_scale; }
+
+    // distance in meters in the North/East plane from the origin to loc
+    Vector2f ne_offset(const struct Location &loc) const;
+
+    // as ne_offset(), in double precision
+    Vector2d ne_offset_double(const struct Location &loc) const;
+
+    // as ne_offset(), in centimeters using fixed point maths. Offsets
+    // must be within about 21000km to fit
+    Vector2l ne_offset_cm(const struct Location &loc) const;
+
+    // ne_offset() of count locations
+    void ne_offsets(const struct Location *locs, Vector2f *ne, uint16_t count) const;
+
+    // distance in meters and bearing in centi-degrees from the origin to loc
+    float get_distance(const struct Location &loc) const;
+    int32_t get_bearing_cd(const struct Location &loc) const;
+
+    // set the lat/lng of loc to the origin moved by ofs_north and
+    // ofs_east meters. Other fields of loc are unchanged
+    void offset(struct Location &loc, float ofs_north, float ofs_east) const;
+
+private:
+    struct Location _origin;
+    float _lng_scale;
+    double _lng_scale_double;
+    // centimeters per 1e-7 degree of longitude at the origin, Q24
+    int32_t _lng_cm_q24;
+};
@@ -0,0 +1,369 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  fixed size dense matrix with compile time dimensions
+
+  Storage is a row major array inside the object, so matrices live on
+  the stack or inside their owner and no operation allocates. All
+  loops have compile time trip counts and walk rows contiguously, which
+  lets the compiler unroll and vectorise them.
+
+  This replaces the float* functions in matrix_alg.cpp for new code:
+  solve() and cholesky_solve() should be preferred to inverse() when
+  the inverse is only used to multiply a vector.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#if MATH_CHECK_INDEXES
+#include <assert.h>
+#endif
+
+#include "vectorN.h"
+
+template <typename T, uint8_t R, uint8_t C>
+class MatrixN
+{
+public:
+    // all elements zero
+    MatrixN<T,R,C>() {
+        zero();
+    }
+
+    // row access, so elements can be read as m[i][j]
+    inline T *operator[](uint8_t i) {
+#if MATH_CHECK_INDEXES
+        assert(i < R);
+#endif
+        return _v[i];
+    }
+
+    inline const T *operator[](uint8_t i) const {
+#if MATH_CHECK_INDEXES
+        assert(i < R);
+#endif
+        return _v[i];
+    }
+
+    inline T &operator()(uint8_t i, uint8_t j) {
+#if MATH_CHECK_INDEXES
+        assert(i < R && j < C);
+#endif
+        return _v[i][j];
+    }
+
+    inline const T &operator()(uint8_t i, uint8_t j) const {
+#if MATH_CHECK_INDEXES
+        assert(i < R && j < C);
+#endif
+        return _v[i][j];
+    }
+
+    inline void zero() {
+        memset(_v, 0, sizeof(_v));
+    }
+
+    // set to the identity, square matrices only
+    void identity() {
+        static_assert(R == C, "identity needs a square matrix");
+        zero();
+        for (uint8_t i=0; i<R; i++) {
+            _v[i][i] = 1;
+        }
+    }
+
+    MatrixN<T,R,C> operator +(const MatrixN<T,R,C> &m) const {
+        MatrixN<T,R,C> ret = *this;
+        ret += m;
+        return ret;
+    }
+
+    MatrixN<T,R,C> operator -(const MatrixN<T,R,C> &m) const {
+        MatrixN<T,R,C> ret = *this;
+        ret -= m;
+        return ret;
+    }
+
+    MatrixN<T,R,C> &operator +=(const MatrixN<T,R,C> &m) {
+        for (uint8_t i=0; i<R; i++) {
+            for (uint8_t j=0; j<C; j++) {
+                _v[i][j] += m._v[i][j];
+            }
+        }
+        return *this;
+    }
+
+    MatrixN<T,R,C> &operator -=(const MatrixN<T,R,C> &m) {
+        for (uint8_t i=0; i<R; i++) {
+            for (uint8_t j=0; j<C; j++) {
+                _v[i][j] -= m._v[i][j];
+            }
+        }
+        return *this;
+    }
+
+    MatrixN<T,R,C> &operator *=(const T num) {
+        for (uint8_t i=0; i<R; i++) {
+            for (uint8_t j=0; j<C; j++) {
+                _v[i][j] *= num;
+            }
+        }
+        return *this;
+    }
+
+    // matrix product. The k loop is outside the j loop so the inner
+    // loop runs along rows of m, and each row of the result is summed
+    // in a local so the compiler need not assume it aliases m
+    template <uint8_t C2>
+    MatrixN<T,R,C2> operator *(const MatrixN<T,C,C2> &m) const {
+        MatrixN<T,R,C2> ret;
+        for (uint8_t i=0; i<R; i++) {
+            T row[C2] {};
+            for (uint8_t k=0; k<C; k++) {
+                const T a = _v[i][k];
+                const T *mrow = m[k];
+                for (uint8_t j=0; j<C2; j++) {
+                    row[j] += a * mrow[j];
+                }
+            }
+            memcpy(ret[i], row, sizeof(row));
+        }
+        return ret;
+    }
+
+    // matrix times column vector
+    VectorN<T,R> operator *(const VectorN<T,C> &v) const {
+        VectorN<T,R> ret;
+        for (uint8_t i=0; i<R; i++) {
+            T sum = 0;
+            for (uint8_t j=0; j<C; j++) {
+                sum += _v[i][j] * v[j];
+            }
+            ret[i] = sum;
+        }
+        return ret;
+    }
+
+    MatrixN<T,C,R> transposed() const {
+        MatrixN<T,C,R> ret;
+        for (uint8_t i=0; i<R; i++) {
+            for (uint8_t j=0; j<C; j++) {
+                ret[j][i] = _v[i][j];
+            }
+        }
+        return ret;
+    }
+
+    /*
+      add v * v^T to the upper triangle, for accumulating J^T*J one
+      Jacobian row at a time. cholesky_solve() only reads the upper
+      triangle; call mirror_upper() if the full matrix is needed
+     */
+    void add_upper_outer(const VectorN<T,R> &v) {
+        static_assert(R == C, "add_upper_outer needs a square matrix");
+        for (uint8_t i=0; i<R; i++) {
+            const T a = v[i];
+            for (uint8_t j=i; j<C; j++) {
+                _v[i][j] += a * v[j];
+            }
+        }
+    }
+
+    // copy the upper triangle into the lower triangle
+    void mirror_upper() {
+        static_assert(R == C, "mirror_upper needs a square matrix");
+        for (uint8_t i=1; i<R; i++) {
+            for (uint8_t j=0; j<i; j++) {
+                _v[i][j] = _v[j][i];
+            }
+        }
+    }
+
+    // add num to each diagonal element, e.g. for LM damping
+    void add_diagonal(const T num) {
+        static_assert(R == C, "add_diagonal needs a square matrix");
+        for (uint8_t i=0; i<R; i++) {
+            _v[i][i] += num;
+        }
+    }
+
+    /*
+      solve A*x = b for symmetric positive definite A using the upper
+      triangle only. Returns false if A is not positive definite. x
+      may be the same vector as b
+     */
+    bool cholesky_solve(const VectorN<T,R> &b, VectorN<T,R> &x) const {
+        static_assert(R == C, "cholesky_solve needs a square matrix");
+        // A = U^T * U, with 1/U[i][i] kept for the substitutions
+        T U[R][R];
+        T inv_diag[R];
+        for (uint8_t i=0; i<R; i++) {
+            T d = _v[i][i];
+            for (uint8_t k=0; k<i; k++) {
+                d -= U[k][i] * U[k][i];
+            }
+            if (!(d > 0) || isinf(d)) {
+                return false;
+            }
+            const T u = _sqrt(d);
+            inv_diag[i] = 1 / u;
+            for (uint8_t j=i+1; j<R; j++) {
+                T s = _v[i][j];
+                for (uint8_t k=0; k<i; k++) {
+                    s -= U[k][i] * U[k][j];
+                }
+                U[i][j] = s * inv_diag[i];
+            }
+        }
+
+        // U^T * y = b
+        for (uint8_t i=0; i<R; i++) {
+            T s = b[i];
+            for (uint8_t k=0; k<i; k++) {
+                s -= U[k][i] * x[k];
+            }
+            x[i] = s * inv_diag[i];
+        }
+        // U * x = y
+        for (int16_t i=R-1; i>=0; i--) {
+            T s = x[i];
+            for (uint8_t k=i+1; k<R; k++) {
+                s -= U[i][k] * x[k];
+            }
+            x[i] = s * inv_diag[i];
+        }
+        return true;
+    }
+
+    /*
+      solve A*x = b for general square A by LU decomposition with
+      partial pivoting. Returns false if A is singular
+     */
+    bool solve(const VectorN<T,R> &b, VectorN<T,R> &x) const {
+        static_assert(R == C, "solve needs a square matrix");
+        MatrixN<T,R,C> LU = *this;
+        uint8_t perm[R];
+        if (!LU.lu_decompose(perm)) {
+            return false;
+        }
+        // copy b as x may be the same vector
+        const VectorN<T,R> rhs = b;
+        LU.lu_substitute(perm, rhs, x);
+        return true;
+    }
+
+    /*
+      inverse of a general square matrix by LU decomposition with
+      partial pivoting. Returns false if the matrix is singular, in
+      which case inv is unchanged
+     */
+    bool inverse(MatrixN<T,R,C> &inv) const {
+        static_assert(R == C, "inverse needs a square matrix");
+        MatrixN<T,R,C> LU = *this;
+        uint8_t perm[R];
+        if (!LU.lu_decompose(perm)) {
+            return false;
+        }
+        MatrixN<T,R,C> ret;
+        VectorN<T,R> e, col;
+        for (uint8_t j=0; j<C; j++) {
+            e.zero();
+            e[j] = 1;
+            LU.lu_substitute(perm, e, col);
+            for (uint8_t i=0; i<R; i++) {
+                if (isnan(col[i]) || isinf(col[i])) {
+                    return false;
+                }
+                ret[i][j] = col[i];
+            }
+        }
+        inv = ret;
+        return true;
+    }
+
+private:
+    // keep float maths in single precision
+    static inline float _abs(float v) { return fabsf(v); }
+    static inline double _abs(double v) { return fabs(v); }
+    static inline float _sqrt(float v) { return sqrtf(v); }
+    static inline double _sqrt(double v) { return sqrt(v); }
+
+    /*
+      in place LU decomposition with partial pivoting: L below the
+      diagonal with implicit unit diagonal, U on and above it. Row i
+      of the result is row perm[i] of the original
+     */
+    bool lu_decompose(uint8_t perm[R]) {
+        for (uint8_t i=0; i<R; i++) {
+            perm[i] = i;
+        }
+        for (uint8_t k=0; k<R; k++) {
+            uint8_t p = k;
+            T max = _abs(_v[k][k]);
+            for (uint8_t i=k+1; i<R; i++) {
+                const T a = _abs(_v[i][k]);
+                if (a > max) {
+                    max = a;
+                    p = i;
+                }
+            }
+            if (!(max > 0) || isinf(max)) {
+                return false;
+            }
+            if (p != k) {
+                T tmp[C];
+                memcpy(tmp, _v[k], sizeof(tmp));
+                memcpy(_v[k], _v[p], sizeof(tmp));
+                memcpy(_v[p], tmp, sizeof(tmp));
+                const uint8_t t = perm[k];
+                perm[k] = perm[p];
+                perm[p] = t;
+            }
+            const T inv_pivot = 1 / _v[k][k];
+            for (uint8_t i=k+1; i<R; i++) {
+                const T l = _v[i][k] * inv_pivot;
+                _v[i][k] = l;
+                for (uint8_t j=k+1; j<C; j++) {
+                    _v[i][j] -= l * _v[k][j];
+                }
+            }
+        }
+        return true;
+    }
+
+    // solve using the output of lu_decompose()
+    void lu_substitute(const uint8_t perm[R], const VectorN<T,R> &b, VectorN<T,R> &x) const {
+        for (uint8_t i=0; i<R; i++) {
+            T s = b[perm[i]];
+            for (uint8_t k=0; k<i; k++) {
+                s -= _v[i][k] * x[k];
+            }
+            x[i] = s;
+        }
+        for (int16_t i=R-1; i>=0; i--) {
+            T s = x[i];
+            for (uint8_t k=i+1; k<C; k++) {
+                s -= _v[i][k] * x[k];
+            }
+            x[i] = s / _v[i][i];
+        }
+    }
+
+    T _v[R][C];
+};
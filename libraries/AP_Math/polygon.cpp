@@ -25,6 +25,45 @@
  */
 
 
+/*
+ *  test if the ray from P crosses the edge from Vj to Vi, so that
+ *  crossing it changes P between inside and outside
+ */
+static inline bool Polygon_edge_crossed(const Vector2l &P, const Vector2l &Vi, const Vector2l &Vj)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return false;
+    }
+    int32_t dx1, dx2, dy1, dy2;
+    dx1 = P.x - Vi.x;
+    dx2 = Vj.x - Vi.x;
+    dy1 = P.y - Vi.y;
+    dy2 = Vj.y - Vi.y;
+    int8_t dx1s, dx2s, dy1s, dy2s, m1, m2;
+#define sign(x) ((x)<0 ? -1 : 1)
+    dx1s = sign(dx1);
+    dx2s = sign(dx2);
+    dy1s = sign(dy1);
+    dy2s = sign(dy2);
+    m1 = dx1s * dy2s;
+    m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 < m2) {
+        return true;
+    } else if (m1 > m2) {
+        return false;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
 /*
  *  Polygon_outside(): test for a point in a polygon
  *     Input:   P = a point,
@@ -40,39 +79,8 @@ bool Polygon_outside(const Vector2l &P, const Vector2l *V, unsigned n)
     unsigned i, j;
     bool outside = true;
     for (i = 0, j = n-1; i < n; j = i++) {
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        int32_t dx1, dx2, dy1, dy2;
-        dx1 = P.x - V[i].x;
-        dx2 = V[j].x - V[i].x;
-        dy1 = P.y - V[i].y;
-        dy2 = V[j].y - V[i].y;
-        int8_t dx1s, dx2s, dy1s, dy2s, m1, m2;
-#define sign(x) ((x)<0 ? -1 : 1)
-        dx1s = sign(dx1);
-        dx2s = sign(dx2);
-        dy1s = sign(dy1);
-        dy2s = sign(dy2);
-        m1 = dx1s * dy2s;
-        m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                outside = !outside;
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                outside = !outside;
-            }
+        if (Polygon_edge_crossed(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
@@ -89,3 +97,240 @@ bool Polygon_complete(const Vector2l *V, unsigned n)
 {
     return (n >= 4 && V[n-1].x == V[0].x && V[n-1].y == V[0].y);
 }
+
+// index entries per edge allowed before using a coarser grid
+#define POLYGON_INDEX_MAX_ENTRIES_PER_EDGE 4
+
+PolygonIndex::PolygonIndex() :
+    _points(nullptr),
+    _num_points(0),
+    _bands(),
+    _cells()
+{
+}
+
+PolygonIndex::~PolygonIndex()
+{
+    clear();
+}
+
+void PolygonIndex::free_grid(struct EdgeGrid &grid)
+{
+    delete[] grid.start;
+    delete[] grid.edges;
+    grid = {};
+}
+
+void PolygonIndex::clear()
+{
+    delete[] _points;
+    _points = nullptr;
+    _num_points = 0;
+    free_grid(_bands);
+    free_grid(_cells);
+}
+
+uint16_t PolygonIndex::row_of(const struct EdgeGrid &grid, int32_t y) const
+{
+    if (y <= _min.y) {
+        return 0;
+    }
+    const uint32_t row = ((int64_t)y - _min.y) / grid.row_height;
+    return row < grid.rows ? row : grid.rows - 1;
+}
+
+uint16_t PolygonIndex::col_of(const struct EdgeGrid &grid, int32_t x) const
+{
+    if (x <= _min.x) {
+        return 0;
+    }
+    const uint32_t col = ((int64_t)x - _min.x) / grid.col_width;
+    return col < grid.cols ? col : grid.cols - 1;
+}
+
+// number of cells overlapped by the bounding boxes of all edges
+uint32_t PolygonIndex::count_entries(const struct EdgeGrid &grid) const
+{
+    uint32_t total = 0;
+    for (uint16_t i = 0, j = _num_points-1; i < _num_points; j = i++) {
+        const uint32_t rows = row_of(grid, MAX(_points[i].y, _points[j].y)) -
+            row_of(grid, MIN(_points[i].y, _points[j].y)) + 1;
+        const uint32_t cols = col_of(grid, MAX(_points[i].x, _points[j].x)) -
+            col_of(grid, MIN(_points[i].x, _points[j].x)) + 1;
+        total += rows * cols;
+    }
+    return total;
+}
+
+/*
+  build a grid of at most rows by cols cells, halving both until the
+  entry count is in budget
+ */
+bool PolygonIndex::build_grid(struct EdgeGrid &grid, uint16_t rows, uint16_t cols)
+{
+    const uint64_t y_range = (int64_t)_max.y - _min.y + 1;
+    const uint64_t x_range = (int64_t)_max.x - _min.x + 1;
+    uint32_t entries;
+    while (true) {
+        grid.rows = rows;
+        grid.cols = cols;
+        grid.row_height = (y_range + rows - 1) / rows;
+        grid.col_width = (x_range + cols - 1) / cols;
+        entries = count_entries(grid);
+        if ((rows == 1 && cols == 1) ||
+            entries <= POLYGON_INDEX_MAX_ENTRIES_PER_EDGE * (uint32_t)_num_points) {
+            break;
+        }
+        rows = MAX(rows / 2, 1);
+        cols = MAX(cols / 2, 1);
+    }
+
+    const uint32_t num_cells = (uint32_t)grid.rows * grid.cols;
+    grid.start = new uint32_t[num_cells + 1];
+    grid.edges = new uint16_t[entries];
+    if (grid.start == nullptr || grid.edges == nullptr) {
+        return false;
+    }
+
+    // count the edges of each cell, then fill the cells in place
+    memset(grid.start, 0, (num_cells + 1) * sizeof(uint32_t));
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint16_t i = 0, j = _num_points-1; i < _num_points; j = i++) {
+            const uint16_t r0 = row_of(grid, MIN(_points[i].y, _points[j].y));
+            const uint16_t r1 = row_of(grid, MAX(_points[i].y, _points[j].y));
+            const uint16_t c0 = col_of(grid, MIN(_points[i].x, _points[j].x));
+            const uint16_t c1 = col_of(grid, MAX(_points[i].x, _points[j].x));
+            for (uint16_t r = r0; r <= r1; r++) {
+                for (uint16_t c = c0; c <= c1; c++) {
+                    const uint32_t cell = (uint32_t)r * grid.cols + c;
+                    if (pass == 0) {
+                        grid.start[cell+1]++;
+                    } else {
+                        grid.edges[grid.start[cell]++] = i;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (uint32_t c = 0; c < num_cells; c++) {
+                grid.start[c+1] += grid.start[c];
+            }
+        }
+    }
+    // filling moved each start on to the start of the next cell
+    for (uint32_t c = num_cells; c > 0; c--) {
+        grid.start[c] = grid.start[c-1];
+    }
+    grid.start[0] = 0;
+
+    return true;
+}
+
+bool PolygonIndex::build(const Vector2l *V, unsigned n)
+{
+    clear();
+    if (n == 0 || n > UINT16_MAX) {
+        return false;
+    }
+
+    _points = new Vector2l[n];
+    if (_points == nullptr) {
+        return false;
+    }
+    memcpy(_points, V, n * sizeof(Vector2l));
+    _num_points = n;
+
+    _min = _max = V[0];
+    for (uint16_t i = 1; i < n; i++) {
+        _min.x = MIN(_min.x, V[i].x);
+        _min.y = MIN(_min.y, V[i].y);
+        _max.x = MAX(_max.x, V[i].x);
+        _max.y = MAX(_max.y, V[i].y);
+    }
+
+    // about one band per edge, and one cell per edge in a square grid
+    const uint16_t side = MAX(sqrtf(n), 1);
+    if (!build_grid(_bands, n, 1) || !build_grid(_cells, side, side)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool PolygonIndex::outside(const Vector2l &P) const
+{
+    // only edges spanning P.y can be crossed, and they all overlap
+    // the band of P.y
+    if (_points == nullptr || P.y < _min.y || P.y >= _max.y) {
+        return true;
+    }
+    const uint16_t band = row_of(_bands, P.y);
+    bool outside = true;
+    for (uint32_t k = _bands.start[band]; k < _bands.start[band+1]; k++) {
+        const uint16_t i = _bands.edges[k];
+        const uint16_t j = (i == 0) ? _num_points-1 : i-1;
+        if (Polygon_edge_crossed(P, _points[i], _points[j])) {
+            outside = !outside;
+        }
+    }
+    return outside;
+}
+
+float PolygonIndex::edge_distance_sq(const Vector2l &P, uint16_t i, float y_scale) const
+{
+    const uint16_t j = (i == 0) ? _num_points-1 : i-1;
+    // closest point of the edge, relative to P
+    const float ax = (int64_t)_points[j].x - P.x;
+    const float ay = ((int64_t)_points[j].y - P.y) * y_scale;
+    const float ex = (int64_t)_points[i].x - _points[j].x;
+    const float ey = ((int64_t)_points[i].y - _points[j].y) * y_scale;
+    const float len_sq = sq(ex) + sq(ey);
+    float t = 0;
+    if (len_sq > 0) {
+        t = constrain_float(-(ax * ex + ay * ey) / len_sq, 0, 1);
+    }
+    return sq(ax + t * ex) + sq(ay + t * ey);
+}
+
+float PolygonIndex::distance_to_boundary(const Vector2l &P, float y_scale) const
+{
+    if (_points == nullptr) {
+        return -1;
+    }
+
+    // search square rings of cells around the cell of P. Every cell
+    // in ring k is at least k-1 cells from P in x or in y
+    const int32_t row0 = row_of(_cells, P.y);
+    const int32_t col0 = col_of(_cells, P.x);
+    float best_sq = FLT_MAX;
+    for (int32_t k = 0; ; k++) {
+        if (k > 0) {
+            const float gap = MIN((float)(k-1) * _cells.col_width,
+                                  (float)(k-1) * _cells.row_height * y_scale);
+            if (sq(gap) >= best_sq) {
+                break;
+            }
+        }
+        if (row0 - k < 0 && row0 + k >= _cells.rows &&
+            col0 - k < 0 && col0 + k >= _cells.cols) {
+            // ring is entirely outside the grid
+            break;
+        }
+        for (int32_t r = MAX(row0 - k, 0); r <= MIN(row0 + k, _cells.rows - 1); r++) {
+            // whole rows at the top and bottom of the ring, otherwise
+            // just its sides
+            const bool edge_row = (r == row0 - k || r == row0 + k);
+            const int32_t step = edge_row ? 1 : MAX(2*k, 1);
+            for (int32_t c = col0 - k; c <= col0 + k; c += step) {
+                if (c < 0 || c >= _cells.cols) {
+                    continue;
+                }
+                const uint32_t cell = (uint32_t)r * _cells.cols + c;
+                for (uint32_t e = _cells.start[cell]; e < _cells.start[cell+1]; e++) {
+                    best_sq = MIN(best_sq, edge_distance_sq(P, _cells.edges[e], y_scale));
+                }
+            }
+        }
+    }
+    return sqrtf(best_sq);
+}
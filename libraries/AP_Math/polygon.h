@@ -20,3 +20,75 @@
 bool        Polygon_outside(const Vector2l &P, const Vector2l *V, unsigned n);
 bool        Polygon_complete(const Vector2l *V, unsigned n);
 
+
+/*
+  Index of the edges of a fixed polygon for fast repeated queries, e.g.
+  a fence tested on every loop. build() sorts the edges into grids of
+  cells, each holding the edges whose bounding box overlaps it, so a
+  query only tests the few edges near the point rather than all of
+  them:
+
+  - outside() uses a grid of one column, i.e. bands of y, and tests the
+    edges of the band of the point with the crossing test from
+    Polygon_outside(), so it gives exactly the same answer.
+
+  - distance_to_boundary() uses a square grid and searches rings of
+    cells outward from the point until no further cell can be closer.
+
+  Grid sizes are reduced until each grid holds at most a few entries
+  per edge, keeping memory linear in the number of vertices.
+ */
+class PolygonIndex
+{
+public:
+    PolygonIndex();
+    ~PolygonIndex();
+
+    // index the polygon V[n] laid out as for Polygon_outside(). The
+    // points are copied. Returns false if out of memory
+    bool build(const Vector2l *V, unsigned n);
+
+    // free the index
+    void clear();
+
+    bool built() const { return _points != nullptr; }
+
+    // equivalent to Polygon_outside() on the indexed polygon
+    bool outside(const Vector2l &P) const;
+
+    // distance from P to the nearest edge, in the units of the
+    // points. y distances are multiplied by y_scale first, e.g. the
+    // longitude scale for lat/lng points. Returns -1 if not built
+    float distance_to_boundary(const Vector2l &P, float y_scale = 1.0f) const;
+
+private:
+    /*
+      edges of cell (row, col) are
+      edges[start[c]..start[c+1]-1] with c = row*cols + col. Edge i
+      runs from point i-1 to point i, wrapping
+     */
+    struct EdgeGrid {
+        uint16_t rows;
+        uint16_t cols;
+        uint32_t row_height;
+        uint32_t col_width;
+        uint32_t *start;
+        uint16_t *edges;
+    };
+
+    bool build_grid(struct EdgeGrid &grid, uint16_t rows, uint16_t cols);
+    void free_grid(struct EdgeGrid &grid);
+    uint32_t count_entries(const struct EdgeGrid &grid) const;
+    uint16_t row_of(const struct EdgeGrid &grid, int32_t y) const;
+    uint16_t col_of(const struct EdgeGrid &grid, int32_t x) const;
+
+    // squared distance from P to edge i, y scaled
+    float edge_distance_sq(const Vector2l &P, uint16_t i, float y_scale) const;
+
+    Vector2l *_points;
+    uint16_t _num_points;
+    Vector2l _min;
+    Vector2l _max;
+    struct EdgeGrid _bands;
+    struct EdgeGrid _cells;
+};
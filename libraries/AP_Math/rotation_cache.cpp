@@ -0,0 +1,63 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma GCC optimize("O3")
+
+#include "AP_Math.h"
+
+RotationCache::RotationCache() :
+    _r1(ROTATION_NONE),
+    _r2(ROTATION_NONE)
+{
+    _m.identity();
+}
+
+void RotationCache::set(enum Rotation r1, enum Rotation r2)
+{
+    if (r1 == _r1 && r2 == _r2) {
+        return;
+    }
+
+    // the columns are the rotated unit vectors
+    Vector3f x_vec(1, 0, 0);
+    Vector3f y_vec(0, 1, 0);
+    Vector3f z_vec(0, 0, 1);
+    x_vec.rotate(r1);
+    y_vec.rotate(r1);
+    z_vec.rotate(r1);
+    x_vec.rotate(r2);
+    y_vec.rotate(r2);
+    z_vec.rotate(r2);
+
+    _m = Matrix3f(x_vec.x, y_vec.x, z_vec.x,
+                  x_vec.y, y_vec.y, z_vec.y,
+                  x_vec.z, y_vec.z, z_vec.z);
+    _r1 = r1;
+    _r2 = r2;
+}
+
+void RotationCache::rotate(Vector3f *v, uint16_t count) const
+{
+    // a local copy of the matrix, as otherwise the compiler has to
+    // reload it after each store in case v aliases it
+    const Matrix3f m = _m;
+    for (uint16_t i = 0; i < count; i++) {
+        const float x = v[i].x, y = v[i].y, z = v[i].z;
+        v[i].x = m.a.x * x + m.a.y * y + m.a.z * z;
+        v[i].y = m.b.x * x + m.b.y * y + m.b.z * z;
+        v[i].z = m.c.x * x + m.c.y * y + m.c.z * z;
+    }
+}
@@ -0,0 +1,69 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  A standard rotation, or two applied in turn, reduced to a matrix
+  when it is set, for code that applies the same rotation to every
+  sensor sample. Vector3::rotate() switches on the rotation for every
+  vector; rotate() here is a branch free matrix multiply.
+
+  The matrix is built by Vector3::rotate() of the unit vectors, so for
+  the multiple of 90 degree rotations its elements are exactly 0 and
+  +/-1 and the results are identical to Vector3::rotate().
+ */
+
+#include "vector3.h"
+#include "matrix3.h"
+
+class RotationCache
+{
+public:
+    RotationCache();
+
+    // make this rotation r1 followed by r2. Cheap if unchanged, so
+    // it can be called with a parameter before each use
+    void set(enum Rotation r1, enum Rotation r2 = ROTATION_NONE);
+
+    enum Rotation get_first() const { return _r1; }
+    enum Rotation get_second() const { return _r2; }
+
+    // equivalent to v.rotate(r1) then v.rotate(r2)
+    inline void rotate(Vector3f &v) const {
+        const float x = v.x, y = v.y, z = v.z;
+        v.x = _m.a.x * x + _m.a.y * y + _m.a.z * z;
+        v.y = _m.b.x * x + _m.b.y * y + _m.b.z * z;
+        v.z = _m.c.x * x + _m.c.y * y + _m.c.z * z;
+    }
+
+    // undo rotate(), as Vector3::rotate_inverse()
+    inline void rotate_inverse(Vector3f &v) const {
+        const float x = v.x, y = v.y, z = v.z;
+        v.x = _m.a.x * x + _m.b.x * y + _m.c.x * z;
+        v.y = _m.a.y * x + _m.b.y * y + _m.c.y * z;
+        v.z = _m.a.z * x + _m.b.z * y + _m.c.z * z;
+    }
+
+    // rotate count vectors in place, e.g. a buffer of samples
+    void rotate(Vector3f *v, uint16_t count) const;
+
+    const Matrix3f &get_matrix() const { return _m; }
+
+private:
+    Matrix3f _m;
+    enum Rotation _r1;
+    enum Rotation _r2;
+};
@@ -0,0 +1,78 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+static Location make_location(int32_t lat, int32_t lng)
+{
+    Location loc {};
+    loc.lat = lat;
+    loc.lng = lng;
+    return loc;
+}
+
+TEST(LocationTest, LocationCacheMatchesLocationDiff)
+{
+    const Location origin = make_location(-353632610, 1491652300);
+    const LocationCache cache(origin);
+
+    for (int32_t ofs = -2000000; ofs <= 2000000; ofs += 400000) {
+        const Location loc = make_location(origin.lat + ofs, origin.lng - 2*ofs);
+        const Vector2f diff = location_diff(origin, loc);
+        const Vector2f ne = cache.ne_offset(loc);
+        EXPECT_FLOAT_EQ(diff.x, ne.x);
+        EXPECT_FLOAT_EQ(diff.y, ne.y);
+
+        const Vector2d ne_double = cache.ne_offset_double(loc);
+        EXPECT_NEAR(diff.x, ne_double.x, 0.01);
+        EXPECT_NEAR(diff.y, ne_double.y, 0.01);
+
+        const Vector2l ne_cm = cache.ne_offset_cm(loc);
+        EXPECT_NEAR(ne_double.x * 100, ne_cm.x, 1);
+        EXPECT_NEAR(ne_double.y * 100, ne_cm.y, 1);
+
+        Vector2f batch[2];
+        const Location locs[2] = { loc, origin };
+        cache.ne_offsets(locs, batch, 2);
+        EXPECT_FLOAT_EQ(ne.x, batch[0].x);
+        EXPECT_FLOAT_EQ(ne.y, batch[0].y);
+        EXPECT_FLOAT_EQ(0.0f, batch[1].x);
+        EXPECT_FLOAT_EQ(0.0f, batch[1].y);
+    }
+}
+
+TEST(LocationTest, LocationCacheBearingAndOffset)
+{
+    const Location origin = make_location(-353632610, 1491652300);
+    const LocationCache cache(origin);
+
+    Location loc = origin;
+    cache.offset(loc, 100.0f, 100.0f);
+    EXPECT_NEAR(100.0f * M_SQRT2, cache.get_distance(loc), 0.01f);
+    EXPECT_NEAR(4500, cache.get_bearing_cd(loc), 1);
+
+    cache.offset(loc, -50.0f, 0.0f);
+    EXPECT_NEAR(50.0f, cache.get_distance(loc), 0.01f);
+    EXPECT_NEAR(18000, cache.get_bearing_cd(loc), 1);
+}
+
+TEST(LocationTest, LocationCacheLongRange)
+{
+    // 150 degrees of longitude would overflow a 32 bit difference
+    const Location origin = make_location(0, -1500000000);
+    const LocationCache cache(origin);
+    const Location loc = make_location(10, 1500000000);
+
+    const Vector2d ne = cache.ne_offset_double(loc);
+    EXPECT_NEAR(10 * 0.011131884502145034, ne.x, 1.0e-9);
+    EXPECT_NEAR(3000000000.0 * 0.011131884502145034, ne.y, 1.0e-3);
+
+    // centimeters cover about 21000km in 32 bits. The Q24 scale is
+    // good to a few parts per billion
+    const Location loc2 = make_location(-10, 0);
+    const Vector2d ne2 = cache.ne_offset_double(loc2);
+    const Vector2l ne_cm = cache.ne_offset_cm(loc2);
+    EXPECT_NEAR(ne2.x * 100, ne_cm.x, 1);
+    EXPECT_NEAR(ne2.y * 100, ne_cm.y, 10);
+}
+
+AP_GTEST_MAIN()
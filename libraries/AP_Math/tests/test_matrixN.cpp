@@ -0,0 +1,114 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+
+#define MATRIXN_ACCURACY 1.0e-5f
+
+// a well conditioned symmetric positive definite test matrix
+static MatrixN<float,4,4> spd_matrix()
+{
+    static const float v[4][4] = {
+        { 4.0f, 1.0f, 0.5f, 0.2f },
+        { 1.0f, 3.0f, 0.3f, 0.1f },
+        { 0.5f, 0.3f, 2.0f, 0.4f },
+        { 0.2f, 0.1f, 0.4f, 1.5f },
+    };
+    MatrixN<float,4,4> m;
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            m[i][j] = v[i][j];
+        }
+    }
+    return m;
+}
+
+TEST(MatrixNTest, Multiply)
+{
+    MatrixN<float,2,3> a;
+    MatrixN<float,3,2> b;
+    for (uint8_t i = 0; i < 2; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            a[i][j] = i * 3 + j + 1;
+            b[j][i] = i * 3 + j + 1;
+        }
+    }
+    MatrixN<float,2,2> c = a * b;
+    EXPECT_FLOAT_EQ(14.0f, c[0][0]);
+    EXPECT_FLOAT_EQ(32.0f, c[0][1]);
+    EXPECT_FLOAT_EQ(32.0f, c[1][0]);
+    EXPECT_FLOAT_EQ(77.0f, c[1][1]);
+
+    MatrixN<float,3,2> t = a.transposed();
+    EXPECT_FLOAT_EQ(a[1][2], t[2][1]);
+}
+
+TEST(MatrixNTest, Inverse)
+{
+    MatrixN<float,4,4> m = spd_matrix();
+    // swap two rows so pivoting is needed
+    for (uint8_t j = 0; j < 4; j++) {
+        float tmp = m[0][j];
+        m[0][j] = m[3][j];
+        m[3][j] = tmp;
+    }
+
+    MatrixN<float,4,4> inv;
+    ASSERT_TRUE(m.inverse(inv));
+    MatrixN<float,4,4> ident = m * inv;
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            EXPECT_NEAR(i == j ? 1.0f : 0.0f, ident[i][j], MATRIXN_ACCURACY);
+        }
+    }
+
+    MatrixN<float,4,4> singular;
+    singular[0][0] = 1.0f;
+    EXPECT_FALSE(singular.inverse(inv));
+}
+
+TEST(MatrixNTest, Solve)
+{
+    MatrixN<float,4,4> m = spd_matrix();
+    VectorN<float,4> x;
+    for (uint8_t i = 0; i < 4; i++) {
+        x[i] = i - 1.5f;
+    }
+    const VectorN<float,4> b = m * x;
+
+    VectorN<float,4> lu_x, chol_x;
+    ASSERT_TRUE(m.solve(b, lu_x));
+    ASSERT_TRUE(m.cholesky_solve(b, chol_x));
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(x[i], lu_x[i], MATRIXN_ACCURACY);
+        EXPECT_NEAR(x[i], chol_x[i], MATRIXN_ACCURACY);
+    }
+
+    // not positive definite
+    MatrixN<float,4,4> neg = m;
+    neg[2][2] = -1.0f;
+    EXPECT_FALSE(neg.cholesky_solve(b, chol_x));
+}
+
+TEST(MatrixNTest, NormalEquations)
+{
+    // accumulating the upper triangle one row at a time gives J^T*J
+    MatrixN<float,3,3> JTJ;
+    MatrixN<float,4,3> J;
+    for (uint8_t k = 0; k < 4; k++) {
+        VectorN<float,3> row;
+        for (uint8_t i = 0; i < 3; i++) {
+            row[i] = J[k][i] = (k + 1) * (i + 2) + k * k;
+        }
+        JTJ.add_upper_outer(row);
+    }
+    JTJ.mirror_upper();
+    MatrixN<float,3,3> expected = J.transposed() * J;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_FLOAT_EQ(expected[i][j], JTJ[i][j]);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
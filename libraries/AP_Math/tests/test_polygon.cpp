@@ -0,0 +1,79 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+#define POLYGON_NUM_POINTS 201
+
+// a circle with a zig-zag edge around a fence sized area, closed as for
+// Polygon_outside()
+static void make_fence(Vector2l *V, unsigned n)
+{
+    for (unsigned i = 0; i < n-1; i++) {
+        const float angle = i * (2 * M_PI / (n-1));
+        const float radius = (i % 2) ? 380000 : 420000;
+        V[i].x = -353632610 + radius * cosf(angle);
+        V[i].y = 1491652300 + radius * sinf(angle);
+    }
+    V[n-1] = V[0];
+}
+
+TEST(PolygonTest, IndexMatchesPolygonOutside)
+{
+    Vector2l V[POLYGON_NUM_POINTS];
+    make_fence(V, POLYGON_NUM_POINTS);
+    PolygonIndex index;
+    ASSERT_TRUE(index.build(V, POLYGON_NUM_POINTS));
+
+    for (int32_t dx = -500000; dx <= 500000; dx += 3917) {
+        for (int32_t dy = -500000; dy <= 500000; dy += 4111) {
+            const Vector2l P(-353632610 + dx, 1491652300 + dy);
+            EXPECT_EQ(Polygon_outside(P, V, POLYGON_NUM_POINTS), index.outside(P));
+        }
+    }
+    // on vertices
+    for (unsigned i = 0; i < POLYGON_NUM_POINTS; i++) {
+        EXPECT_EQ(Polygon_outside(V[i], V, POLYGON_NUM_POINTS), index.outside(V[i]));
+    }
+}
+
+TEST(PolygonTest, DistanceToBoundary)
+{
+    // 1000 unit square
+    const Vector2l V[] = {
+        Vector2l(0, 0), Vector2l(1000, 0), Vector2l(1000, 1000), Vector2l(0, 1000), Vector2l(0, 0)
+    };
+    PolygonIndex index;
+    EXPECT_FLOAT_EQ(-1, index.distance_to_boundary(Vector2l(0, 0)));
+    ASSERT_TRUE(index.build(V, 5));
+
+    EXPECT_FALSE(index.outside(Vector2l(500, 400)));
+    EXPECT_FLOAT_EQ(400, index.distance_to_boundary(Vector2l(500, 400)));
+    EXPECT_FLOAT_EQ(100, index.distance_to_boundary(Vector2l(900, 500)));
+    EXPECT_FLOAT_EQ(200, index.distance_to_boundary(Vector2l(500, 400), 0.5f));
+    EXPECT_TRUE(index.outside(Vector2l(500, 3000)));
+    EXPECT_FLOAT_EQ(2000, index.distance_to_boundary(Vector2l(500, 3000)));
+    EXPECT_FLOAT_EQ(500, index.distance_to_boundary(Vector2l(1300, -400)));
+}
+
+TEST(PolygonTest, DistanceMatchesExhaustive)
+{
+    Vector2l V[POLYGON_NUM_POINTS];
+    make_fence(V, POLYGON_NUM_POINTS);
+    PolygonIndex index;
+    ASSERT_TRUE(index.build(V, POLYGON_NUM_POINTS));
+
+    for (int32_t d = -600000; d <= 600000; d += 7919) {
+        const Vector2l P(-353632610 + d, 1491652300 + (d * 3) % 600000);
+        float best = FLT_MAX;
+        for (unsigned i = 1; i < POLYGON_NUM_POINTS; i++) {
+            const Vector2f a(V[i-1].x - P.x, V[i-1].y - P.y);
+            const Vector2f b(V[i].x - P.x, V[i].y - P.y);
+            const Vector2f e = b - a;
+            const float t = constrain_float(-(a * e) / (e * e), 0, 1);
+            best = MIN(best, (a + e * t).length());
+        }
+        EXPECT_NEAR(best, index.distance_to_boundary(P), best * 1.0e-4f + 1);
+    }
+}
+
+AP_GTEST_MAIN()
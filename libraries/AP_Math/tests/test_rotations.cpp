@@ -0,0 +1,54 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+TEST(RotationsTest, RotationCacheMatchesRotate)
+{
+    const Vector3f v(1.5f, -2.25f, 3.125f);
+
+    for (uint8_t r = ROTATION_NONE; r < ROTATION_MAX; r++) {
+        Vector3f expected = v;
+        expected.rotate((enum Rotation)r);
+
+        RotationCache cache;
+        cache.set((enum Rotation)r);
+        Vector3f rotated = v;
+        cache.rotate(rotated);
+
+        // exact except for rounding of the 45 degree and custom rotations
+        EXPECT_NEAR(expected.x, rotated.x, 1.0e-5f) << "rotation " << (int)r;
+        EXPECT_NEAR(expected.y, rotated.y, 1.0e-5f) << "rotation " << (int)r;
+        EXPECT_NEAR(expected.z, rotated.z, 1.0e-5f) << "rotation " << (int)r;
+
+        Vector3f inverse = expected;
+        inverse.rotate_inverse((enum Rotation)r);
+        cache.rotate_inverse(rotated);
+        EXPECT_NEAR(inverse.x, rotated.x, 1.0e-5f) << "rotation " << (int)r;
+        EXPECT_NEAR(inverse.y, rotated.y, 1.0e-5f) << "rotation " << (int)r;
+        EXPECT_NEAR(inverse.z, rotated.z, 1.0e-5f) << "rotation " << (int)r;
+    }
+}
+
+TEST(RotationsTest, RotationCacheCombined)
+{
+    RotationCache cache;
+    cache.set(ROTATION_YAW_90, ROTATION_ROLL_180);
+    EXPECT_EQ(ROTATION_YAW_90, cache.get_first());
+    EXPECT_EQ(ROTATION_ROLL_180, cache.get_second());
+
+    Vector3f samples[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        samples[i] = Vector3f(i, 2 * i + 1, -3.0f * i);
+    }
+    cache.rotate(samples, 4);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        Vector3f expected(i, 2 * i + 1, -3.0f * i);
+        expected.rotate(ROTATION_YAW_90);
+        expected.rotate(ROTATION_ROLL_180);
+        // multiples of 90 degrees are exact
+        EXPECT_EQ(expected, samples[i]);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -1,6 +1,7 @@
 #include <AP_gtest.h>
 
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/vectorN.h>
 
 #define SQRT_2 1.4142135623730951f
 
@@ -63,4 +64,33 @@ TEST(VectorTest, Rotations)
     EXPECT_EQ(ROTATION_MAX, rotation_count) << "All rotations are expect to be tested";
 }
 
+TEST(VectorTest, VectorNExpressions)
+{
+    VectorN<float,5> a, b, c;
+    for (uint8_t i = 0; i < 5; i++) {
+        a[i] = i;
+        b[i] = 2 * i + 1;
+        c[i] = 10 - i;
+    }
+
+    VectorN<float,5> r = a + b*0.5 - c;
+    for (uint8_t i = 0; i < 5; i++) {
+        EXPECT_FLOAT_EQ(a[i] + b[i]*0.5f - c[i], r[i]);
+    }
+
+    r = -(a - b) / 2.0f;
+    for (uint8_t i = 0; i < 5; i++) {
+        EXPECT_FLOAT_EQ((b[i] - a[i]) / 2.0f, r[i]);
+    }
+
+    // the result may appear on the right hand side
+    r = a;
+    r = r + 3.0f * r;
+    r += b;
+    r -= a * 2;
+    for (uint8_t i = 0; i < 5; i++) {
+        EXPECT_FLOAT_EQ(4*a[i] + b[i] - 2*a[i], r[i]);
+    }
+}
+
 AP_GTEST_MAIN()
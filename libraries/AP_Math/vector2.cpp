@@ -138,7 +138,7 @@ float Vector2<T>::angle(const Vector2<T> &v2) const
     return acosf(cosv);
 }
 
-// only define for float
+// only define for float and double
 template float Vector2<float>::length(void) const;
 template float Vector2<float>::operator *(const Vector2<float> &v) const;
 template float Vector2<float>::operator %(const Vector2<float> &v) const;
@@ -156,3 +156,20 @@ template bool Vector2<float>::operator !=(const Vector2<float> &v) const;
 template bool Vector2<float>::is_nan(void) const;
 template bool Vector2<float>::is_inf(void) const;
 template float Vector2<float>::angle(const Vector2<float> &v) const;
+
+template float Vector2<double>::length(void) const;
+template double Vector2<double>::operator *(const Vector2<double> &v) const;
+template double Vector2<double>::operator %(const Vector2<double> &v) const;
+template Vector2<double> &Vector2<double>::operator *=(const double num);
+template Vector2<double> &Vector2<double>::operator /=(const double num);
+template Vector2<double> &Vector2<double>::operator -=(const Vector2<double> &v);
+template Vector2<double> &Vector2<double>::operator +=(const Vector2<double> &v);
+template Vector2<double> Vector2<double>::operator /(const double num) const;
+template Vector2<double> Vector2<double>::operator *(const double num) const;
+template Vector2<double> Vector2<double>::operator +(const Vector2<double> &v) const;
+template Vector2<double> Vector2<double>::operator -(const Vector2<double> &v) const;
+template Vector2<double> Vector2<double>::operator -(void) const;
+template bool Vector2<double>::operator ==(const Vector2<double> &v) const;
+template bool Vector2<double>::operator !=(const Vector2<double> &v) const;
+template bool Vector2<double>::is_nan(void) const;
+template bool Vector2<double>::is_inf(void) const;
@@ -23,8 +23,83 @@
 #include <assert.h>
 #endif
 
+/*
+  VectorN arithmetic uses expression templates: a + b*k - c builds a
+  small tree of nodes holding references to its operands, and nothing
+  is computed until the tree is assigned to a VectorN. The assignment
+  then runs a single loop over the elements with no temporary vectors.
+
+  Expression nodes reference their operands, so they must not outlive
+  the full expression that creates them. Assign the result to a
+  VectorN rather than keeping it in an auto variable.
+ */
+
+// base of all vector expressions, E is the concrete node type
+template <typename T, uint8_t N, typename E>
+class VectorNExpr
+{
+public:
+    typedef T value_type;
+
+    inline T operator[](uint8_t i) const {
+        return static_cast<const E &>(*this)[i];
+    }
+};
+
+// element-wise a OP b
+template <typename T, uint8_t N, typename A, typename B, typename OP>
+class VectorNBinaryExpr : public VectorNExpr<T,N,VectorNBinaryExpr<T,N,A,B,OP> >
+{
+public:
+    VectorNBinaryExpr(const A &a, const B &b) : _a(a), _b(b) {}
+
+    inline T operator[](uint8_t i) const {
+        return OP::apply(_a[i], _b[i]);
+    }
+
+private:
+    const A &_a;
+    const B &_b;
+};
+
+// element-wise a OP k for a scalar k
+template <typename T, uint8_t N, typename A, typename OP>
+class VectorNScalarExpr : public VectorNExpr<T,N,VectorNScalarExpr<T,N,A,OP> >
+{
+public:
+    VectorNScalarExpr(const A &a, const T k) : _a(a), _k(k) {}
+
+    inline T operator[](uint8_t i) const {
+        return OP::apply(_a[i], _k);
+    }
+
+private:
+    const A &_a;
+    const T _k;
+};
+
+// element-wise -a
+template <typename T, uint8_t N, typename A>
+class VectorNNegExpr : public VectorNExpr<T,N,VectorNNegExpr<T,N,A> >
+{
+public:
+    VectorNNegExpr(const A &a) : _a(a) {}
+
+    inline T operator[](uint8_t i) const {
+        return -_a[i];
+    }
+
+private:
+    const A &_a;
+};
+
+struct VectorNAddOp { template <typename T> static inline T apply(const T &a, const T &b) { return a + b; } };
+struct VectorNSubOp { template <typename T> static inline T apply(const T &a, const T &b) { return a - b; } };
+struct VectorNMulOp { template <typename T> static inline T apply(const T &a, const T &b) { return a * b; } };
+struct VectorNDivOp { template <typename T> static inline T apply(const T &a, const T &b) { return a / b; } };
+
 template <typename T, uint8_t N>
-class VectorN
+class VectorN : public VectorNExpr<T,N,VectorN<T,N> >
 {
 public:
     // trivial ctor
@@ -32,6 +107,18 @@ public:
         memset(_v, 0, sizeof(T)*N);
     }
 
+    // evaluate an expression, with no need to zero first
+    template <typename E>
+    inline VectorN<T,N>(const VectorNExpr<T,N,E> &e) {
+        assign(static_cast<const E &>(e));
+    }
+
+    template <typename E>
+    inline VectorN<T,N> &operator =(const VectorNExpr<T,N,E> &e) {
+        assign(static_cast<const E &>(e));
+        return *this;
+    }
+
     inline T & operator[](uint8_t i) {
 #if MATH_CHECK_INDEXES
         assert(i >= 0 && i < N);
@@ -60,64 +147,31 @@ public:
         memset(_v, 0, sizeof(T)*N);
     }
 
-    // negation
-    VectorN<T,N> operator -(void) const {
-        VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
-            v2[i] = - _v[i];
-        }   
-        return v2;
-    }
-
     // addition
-    VectorN<T,N> operator +(const VectorN<T,N> &v) const {
-        VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
-            v2[i] = _v[i] + v[i];
-        }   
-        return v2;
-    }
-
-    // subtraction
-    VectorN<T,N> operator -(const VectorN<T,N> &v) const {
-        VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
-            v2[i] = _v[i] - v[i];
-        }   
-        return v2;
-    }
-
-    // uniform scaling
-    VectorN<T,N> operator *(const T num) const {
-        VectorN<T,N> v2;
+    template <typename E>
+    VectorN<T,N> &operator +=(const VectorNExpr<T,N,E> &e) {
+        const E &expr = static_cast<const E &>(e);
+        T tmp[N];
         for (uint8_t i=0; i<N; i++) {
-            v2[i] = _v[i] * num;
-        }   
-        return v2;
-    }
-
-    // uniform scaling
-    VectorN<T,N> operator  /(const T num) const {
-        VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
-            v2[i] = _v[i] / num;
-        }   
-        return v2;
-    }
-
-    // addition
-    VectorN<T,N> &operator +=(const VectorN<T,N> &v) {
+            tmp[i] = expr[i];
+        }
         for (uint8_t i=0; i<N; i++) {
-            _v[i] += v[i];
-        }   
+            _v[i] += tmp[i];
+        }
         return *this;
     }
 
     // subtraction
-    VectorN<T,N> &operator -=(const VectorN<T,N> &v) {
+    template <typename E>
+    VectorN<T,N> &operator -=(const VectorNExpr<T,N,E> &e) {
+        const E &expr = static_cast<const E &>(e);
+        T tmp[N];
+        for (uint8_t i=0; i<N; i++) {
+            tmp[i] = expr[i];
+        }
         for (uint8_t i=0; i<N; i++) {
-            _v[i] -= v[i];
-        }   
+            _v[i] -= tmp[i];
+        }
         return *this;
     }
 
@@ -125,7 +179,7 @@ public:
     VectorN<T,N> &operator *=(const T num) {
         for (uint8_t i=0; i<N; i++) {
             _v[i] *= num;
-        }   
+        }
         return *this;
     }
 
@@ -133,12 +187,67 @@ public:
     VectorN<T,N> &operator /=(const T num) {
         for (uint8_t i=0; i<N; i++) {
             _v[i] /= num;
-        }   
+        }
         return *this;
     }
 
 private:
+    /*
+      evaluate an expression. The loop fills a local so the compiler
+      knows the stores cannot alias the operands and can vectorise it
+     */
+    template <typename E>
+    inline void assign(const E &expr) {
+        T tmp[N];
+        for (uint8_t i=0; i<N; i++) {
+            tmp[i] = expr[i];
+        }
+        memcpy(_v, tmp, sizeof(T)*N);
+    }
+
     T _v[N];
 };
 
+// negation
+template <typename T, uint8_t N, typename A>
+inline VectorNNegExpr<T,N,A> operator -(const VectorNExpr<T,N,A> &a)
+{
+    return VectorNNegExpr<T,N,A>(static_cast<const A &>(a));
+}
+
+// addition
+template <typename T, uint8_t N, typename A, typename B>
+inline VectorNBinaryExpr<T,N,A,B,VectorNAddOp> operator +(const VectorNExpr<T,N,A> &a, const VectorNExpr<T,N,B> &b)
+{
+    return VectorNBinaryExpr<T,N,A,B,VectorNAddOp>(static_cast<const A &>(a), static_cast<const B &>(b));
+}
+
+// subtraction
+template <typename T, uint8_t N, typename A, typename B>
+inline VectorNBinaryExpr<T,N,A,B,VectorNSubOp> operator -(const VectorNExpr<T,N,A> &a, const VectorNExpr<T,N,B> &b)
+{
+    return VectorNBinaryExpr<T,N,A,B,VectorNSubOp>(static_cast<const A &>(a), static_cast<const B &>(b));
+}
+
+// uniform scaling. The scalar type is taken from the vector so that
+// e.g. a double constant converts as it did with the member operators
+template <typename T, uint8_t N, typename A>
+inline VectorNScalarExpr<T,N,A,VectorNMulOp> operator *(const VectorNExpr<T,N,A> &a, const typename VectorNExpr<T,N,A>::value_type num)
+{
+    return VectorNScalarExpr<T,N,A,VectorNMulOp>(static_cast<const A &>(a), num);
+}
+
+template <typename T, uint8_t N, typename A>
+inline VectorNScalarExpr<T,N,A,VectorNMulOp> operator *(const typename VectorNExpr<T,N,A>::value_type num, const VectorNExpr<T,N,A> &a)
+{
+    return VectorNScalarExpr<T,N,A,VectorNMulOp>(static_cast<const A &>(a), num);
+}
+
+// uniform scaling
+template <typename T, uint8_t N, typename A>
+inline VectorNScalarExpr<T,N,A,VectorNDivOp> operator /(const VectorNExpr<T,N,A> &a, const typename VectorNExpr<T,N,A>::value_type num)
+{
+    return VectorNScalarExpr<T,N,A,VectorNDivOp>(static_cast<const A &>(a), num);
+}
+
 #endif // VECTORN_H
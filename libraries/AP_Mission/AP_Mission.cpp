@@ -22,6 +22,14 @@ const AP_Param::GroupInfo AP_Mission::var_info[] = {
     // @Values: 0:Resume Mission, 1:Restart Mission
     AP_GROUPINFO("RESTART",  1, AP_Mission, _restart, AP_MISSION_RESTART_DEFAULT),
 
+    // @Param: UPLOAD_WIN
+    // @DisplayName: Mission upload window
+    // @Description: Number of mission items requested at once during a mission upload. 1 requests one item at a time, as every ground station expects. Larger values request items ahead of those received, which needs a ground station that answers requests in any order, and are limited to 16 (4 on small boards)
+    // @Range: 1 16
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("UPLOAD_WIN",  2, AP_Mission, _upload_window, 1),
+
     AP_GROUPEND
 };
 
@@ -46,6 +54,10 @@ void AP_Mission::init()
         AP_HAL::panic("AP_Mission Content must be 12 bytes");
     }
 
+#if AP_MISSION_CMD_CACHE
+    load_cmd_cache();
+#endif
+
     _last_change_time_ms = AP_HAL::millis();
 }
 
@@ -167,6 +179,20 @@ void AP_Mission::truncate(uint16_t index)
     }
 }
 
+/// extend - extends the mission to num_commands after the extra commands have been written with write_cmd_to_storage
+///     returns false if num_commands is more than can be stored
+bool AP_Mission::extend(uint16_t num_commands)
+{
+    if (num_commands > num_commands_max()) {
+        return false;
+    }
+    if ((unsigned)_cmd_total < num_commands) {
+        _cmd_total.set_and_save(num_commands);
+        _last_change_time_ms = AP_HAL::millis();
+    }
+    return true;
+}
+
 /// update - ensures the command queues are loaded with the next command and calls main programs command_init and command_verify functions to progress the mission
 ///     should be called at 10hz or higher
 void AP_Mission::update()
@@ -261,8 +287,8 @@ bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 
     // search until the end of the mission command list
     while(cmd_index < (unsigned)_cmd_total) {
-        // get next command
-        if (!get_next_cmd(cmd_index, cmd, false)) {
+        // get next command, skipping straight past any "do" commands where the command cache allows
+        if (!get_next_cmd(cmd_index, cmd, false, true)) {
             // no more commands so return failure
             return false;
         }else{
@@ -419,6 +445,12 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         cmd.p1 = 0;
         cmd.content.location = _ahrs.get_home();
     }else{
+#if AP_MISSION_CMD_CACHE
+        if (index < _cmd_cache_size) {
+            cmd = _cmd_cache[index];
+            return true;
+        }
+#endif
         // Find out proper location in memory by using the start_byte position + the index
         // we can load a command, we don't process it yet
         // read WP position
@@ -453,6 +485,15 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, Mission_Command& cmd)
     _storage.write_uint16(pos_in_storage+1, cmd.p1);
     _storage.write_block(pos_in_storage+3, cmd.content.bytes, 12);
 
+#if AP_MISSION_CMD_CACHE
+    // keep the cache in step with storage
+    if (index < _cmd_cache_size) {
+        _cmd_cache[index] = cmd;
+        _cmd_cache[index].index = index;
+        _cmd_graph_valid = false;
+    }
+#endif
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -1230,7 +1271,7 @@ void AP_Mission::advance_current_do_cmd()
 ///     returns true if found, false if not found (i.e. mission complete)
 ///     accounts for do_jump commands
 ///     increment_jump_num_times_if_found should be set to true if advancing the active navigation command
-bool AP_Mission::get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool increment_jump_num_times_if_found)
+bool AP_Mission::get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool increment_jump_num_times_if_found, bool nav_cmds_only)
 {
     uint16_t cmd_index = start_index;
     Mission_Command temp_cmd;
@@ -1239,6 +1280,14 @@ bool AP_Mission::get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool i
     // search until the end of the mission command list
     uint8_t max_loops = 64;
     while(cmd_index < (unsigned)_cmd_total) {
+        if (nav_cmds_only) {
+            // skip straight past any "do" commands, they can never be returned
+            cmd_index = next_nav_or_jump_index(cmd_index);
+            if (cmd_index >= (unsigned)_cmd_total) {
+                break;
+            }
+        }
+
         // load the next command
         if (!read_cmd_from_storage(cmd_index, temp_cmd)) {
             // this should never happen because of check above but just in case
@@ -1273,7 +1322,7 @@ bool AP_Mission::get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool i
             // check if jump command is 'repeat forever'
             if (temp_cmd.content.jump.num_times == AP_MISSION_JUMP_REPEAT_FOREVER) {
                 // continue searching from jump target
-                cmd_index = temp_cmd.content.jump.target;
+                cmd_index = jump_target_index(temp_cmd, nav_cmds_only);
             }else{
                 // get number of times jump command has already been run
                 int16_t jump_times_run = get_jump_times_run(temp_cmd);
@@ -1283,7 +1332,7 @@ bool AP_Mission::get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool i
                         increment_jump_times_run(temp_cmd);
                     }
                     // continue searching from jump target
-                    cmd_index = temp_cmd.content.jump.target;
+                    cmd_index = jump_target_index(temp_cmd, nav_cmds_only);
                 }else{
                     // jump has been run specified number of times so move search to next command in mission
                     cmd_index++;
@@ -1407,6 +1456,105 @@ void AP_Mission::check_eeprom_version()
     }
 }
 
+#if AP_MISSION_CMD_CACHE
+/// load_cmd_cache - allocates the command cache and fills it from storage
+///     if allocation fails commands continue to be read from storage
+void AP_Mission::load_cmd_cache()
+{
+    if (_cmd_cache != nullptr) {
+        return;
+    }
+    uint16_t size = num_commands_max();
+    _cmd_cache = new Mission_Command[size];
+    _cmd_next_nav_or_jump = new uint16_t[size];
+    _cmd_jump_next_nav_or_jump = new uint16_t[size];
+    if (_cmd_cache == nullptr || _cmd_next_nav_or_jump == nullptr || _cmd_jump_next_nav_or_jump == nullptr) {
+        delete[] _cmd_cache;
+        delete[] _cmd_next_nav_or_jump;
+        delete[] _cmd_jump_next_nav_or_jump;
+        _cmd_cache = nullptr;
+        _cmd_next_nav_or_jump = nullptr;
+        _cmd_jump_next_nav_or_jump = nullptr;
+        return;
+    }
+
+    // read every slot, not just the current mission, so that raising MIS_TOTAL is also covered
+    for (uint16_t i=0; i<size; i++) {
+        uint16_t pos_in_storage = 4 + (i * AP_MISSION_EEPROM_COMMAND_SIZE);
+        _cmd_cache[i].index = i;
+        _cmd_cache[i].id = _storage.read_byte(pos_in_storage);
+        _cmd_cache[i].p1 = _storage.read_uint16(pos_in_storage+1);
+        _storage.read_block(_cmd_cache[i].content.bytes, pos_in_storage+3, 12);
+    }
+    _cmd_cache_size = size;
+    _cmd_graph_valid = false;
+}
+
+/// update_cmd_graph - rebuilds the next nav/jump and jump target tables after the command list has changed
+void AP_Mission::update_cmd_graph()
+{
+    uint16_t next = AP_MISSION_CMD_INDEX_NONE;
+    for (int32_t i=_cmd_cache_size-1; i>=0; i--) {
+        if (is_nav_cmd(_cmd_cache[i]) || _cmd_cache[i].id == MAV_CMD_DO_JUMP) {
+            next = i;
+        }
+        _cmd_next_nav_or_jump[i] = next;
+    }
+    // resolve each do-jump to where a nav search continues after taking it, so that at run time
+    // only its repeat count needs checking
+    for (uint16_t i=0; i<_cmd_cache_size; i++) {
+        _cmd_jump_next_nav_or_jump[i] = AP_MISSION_CMD_INDEX_NONE;
+        if (_cmd_cache[i].id == MAV_CMD_DO_JUMP) {
+            uint16_t target = _cmd_cache[i].content.jump.target;
+            if (target != 0 && target < _cmd_cache_size) {
+                _cmd_jump_next_nav_or_jump[i] = _cmd_next_nav_or_jump[target];
+            }
+        }
+    }
+    _cmd_graph_valid = true;
+}
+#endif
+
+/// jump_target_index - returns the index a search continues from after taking a do-jump
+///     for nav only searches this is the first nav or do-jump command at or after the target
+uint16_t AP_Mission::jump_target_index(const Mission_Command& jump_cmd, bool nav_cmds_only)
+{
+#if AP_MISSION_CMD_CACHE
+    if (nav_cmds_only && jump_cmd.index < _cmd_cache_size) {
+        if (!_cmd_graph_valid) {
+            update_cmd_graph();
+        }
+        uint16_t next = _cmd_jump_next_nav_or_jump[jump_cmd.index];
+        if (next != AP_MISSION_CMD_INDEX_NONE) {
+            return next;
+        }
+    }
+#endif
+    return jump_cmd.content.jump.target;
+}
+
+/// next_nav_or_jump_index - returns the index of the first nav or do-jump command at or after index
+///     returns index unchanged if the command cache is not available
+uint16_t AP_Mission::next_nav_or_jump_index(uint16_t index)
+{
+#if AP_MISSION_CMD_CACHE
+    if (index == 0 || index >= _cmd_cache_size) {
+        return index;
+    }
+    if (!_cmd_graph_valid) {
+        update_cmd_graph();
+    }
+    uint16_t next = _cmd_next_nav_or_jump[index];
+    if (next == AP_MISSION_CMD_INDEX_NONE) {
+        // no more nav commands in storage
+        return _cmd_total;
+    }
+    return next;
+#else
+    return index;
+#endif
+}
+
 /*
   return total number of commands that can fit in storage space
  */
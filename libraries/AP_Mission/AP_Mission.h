@@ -40,6 +40,11 @@
 
 #define AP_MISSION_RESTART_DEFAULT          0       // resume the mission from the last command run by default
 
+// on boards with plenty of memory keep a decoded copy of the whole command list in RAM
+#ifndef AP_MISSION_CMD_CACHE
+#define AP_MISSION_CMD_CACHE (HAL_CPU_CLASS >= HAL_CPU_CLASS_1000)
+#endif
+
 /// @class    AP_Mission
 /// @brief    Object managing Mission
 class AP_Mission {
@@ -271,6 +276,9 @@ public:
     /// num_commands_max - returns maximum number of commands that can be stored
     uint16_t num_commands_max() const;
 
+    /// upload_window - returns the number of items a ground station has asked to be requested at once during an upload
+    uint8_t upload_window() const { return _upload_window > 1 ? _upload_window : 1; }
+
     /// start - resets current commands to point to the beginning of the mission
     ///     To-Do: should we validate the mission first and return true/false?
     void start();
@@ -295,6 +303,11 @@ public:
     /// truncate - truncate any mission items beyond given index
     void truncate(uint16_t index);
 
+    /// extend - extends the mission to num_commands after the extra commands have been written with write_cmd_to_storage
+    ///     saves the command count once rather than once per command as add_cmd does
+    ///     returns false if num_commands is more than can be stored
+    bool extend(uint16_t num_commands);
+
     /// update - ensures the command queues are loaded with the next command and calls main programs command_init and command_verify functions to progress the mission
     ///     should be called at 10hz or higher
     void update();
@@ -415,7 +428,8 @@ private:
     ///     returns true if found, false if not found (i.e. mission complete)
     ///     accounts for do_jump commands
     ///     increment_jump_num_times_if_found should be set to true if advancing the active navigation command
-    bool get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool increment_jump_num_times_if_found);
+    ///     nav_cmds_only may be set to skip over "do" commands where the command cache allows, callers must still check what is returned
+    bool get_next_cmd(uint16_t start_index, Mission_Command& cmd, bool increment_jump_num_times_if_found, bool nav_cmds_only = false);
 
     /// get_next_do_cmd - gets next "do" or "conditional" command after start_index
     ///     returns true if found, false if not found
@@ -440,12 +454,27 @@ private:
     /// command list will be cleared if they do not match
     void check_eeprom_version();
 
+#if AP_MISSION_CMD_CACHE
+    /// load_cmd_cache - allocates the command cache and fills it from storage
+    void load_cmd_cache();
+
+    /// update_cmd_graph - rebuilds the next nav/jump and jump target tables after the command list has changed
+    void update_cmd_graph();
+#endif
+
+    /// next_nav_or_jump_index - returns the index of the first nav or do-jump command at or after index
+    uint16_t next_nav_or_jump_index(uint16_t index);
+
+    /// jump_target_index - returns the index a search continues from after taking a do-jump
+    uint16_t jump_target_index(const Mission_Command& jump_cmd, bool nav_cmds_only);
+
     // references to external libraries
     const AP_AHRS&   _ahrs;      // used only for home position
 
     // parameters
     AP_Int16                _cmd_total;  // total number of commands in the mission
     AP_Int8                 _restart;   // controls mission starting point when entering Auto mode (either restart from beginning of mission or resume from last command run)
+    AP_Int8                 _upload_window; // number of items requested at once during an upload
 
     // pointer to main program functions
     mission_cmd_fn_t        _cmd_start_fn;  // pointer to function which will be called when a new command is started
@@ -466,6 +495,21 @@ private:
 
     // last time that mission changed
     uint32_t _last_change_time_ms;
+
+#if AP_MISSION_CMD_CACHE
+    // decoded copy of all commands in storage, indexed by command number. Storage is only read when
+    // this is loaded, afterwards it is only written to
+    Mission_Command *_cmd_cache = nullptr;
+    uint16_t _cmd_cache_size = 0;
+
+    // for each command, the index of the first nav or do-jump command at or after it. This lets
+    // lookahead skip over runs of do commands without decoding them
+    uint16_t *_cmd_next_nav_or_jump = nullptr;
+
+    // for each do-jump command, the first nav or do-jump command at or after its target
+    uint16_t *_cmd_jump_next_nav_or_jump = nullptr;
+    bool _cmd_graph_valid = false;
+#endif
 };
 
 #endif
@@ -120,6 +120,7 @@ uint16_t AP_MotorsMatrix::get_motor_mask()
 void AP_MotorsMatrix::output_armed_not_stabilizing()
 {
     uint8_t i;
+    uint8_t num_motors = _mixer.num_motors();
     int16_t throttle_radio_output;                                  // total throttle pwm value, summed onto throttle channel minimum, typically ~1100-1900
     int16_t motor_out[AP_MOTORS_MAX_NUM_MOTORS];                    // final outputs sent to the motors
     int16_t out_min_pwm = _throttle_radio_min + _min_throttle;      // minimum pwm value we can send to the motors
@@ -145,27 +146,19 @@ void AP_MotorsMatrix::output_armed_not_stabilizing()
     throttle_radio_output = calc_throttle_radio_output();
 
     // set output throttle
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            motor_out[i] = throttle_radio_output;
-        }
+    for (i=0; i<num_motors; i++) {
+        motor_out[i] = throttle_radio_output;
     }
 
     if(throttle_radio_output >= out_min_pwm) {
         // apply thrust curve and voltage scaling
-        for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-            if (motor_enabled[i]) {
-                motor_out[i] = apply_thrust_curve_and_volt_scaling(motor_out[i], out_min_pwm, out_max_pwm);
-            }
-        }
+        apply_thrust_curve_and_volt_scaling(motor_out, num_motors, out_min_pwm, out_max_pwm);
     }
 
     // send output to each motor
     hal.rcout->cork();
-    for( i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++ ) {
-        if( motor_enabled[i] ) {
-            rc_write(i, motor_out[i]);
-        }
+    for (i=0; i<num_motors; i++) {
+        rc_write(_mixer.motor_num(i), motor_out[i]);
     }
     hal.rcout->push();
 }
@@ -175,7 +168,8 @@ void AP_MotorsMatrix::output_armed_not_stabilizing()
 // TODO pull code that is common to output_armed_not_stabilizing into helper functions
 void AP_MotorsMatrix::output_armed_stabilizing()
 {
-    int8_t i;
+    uint8_t i;
+    uint8_t num_motors = _mixer.num_motors();                       // motor_out and rpy_out are in the order of the compiled mixer
     int16_t roll_pwm;                                               // roll pwm value, initially calculated by calc_roll_pwm() but may be modified after, +/- 400
     int16_t pitch_pwm;                                              // pitch pwm value, initially calculated by calc_roll_pwm() but may be modified after, +/- 400
     int16_t yaw_pwm;                                                // yaw pwm value, initially calculated by calc_yaw_pwm() but may be modified after, +/- 400
@@ -185,6 +179,7 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     int16_t out_mid_pwm = (out_min_pwm+out_max_pwm)/2;              // mid pwm value we can send to the motors
     int16_t out_best_thr_pwm;                                       // the is the best throttle we can come up which provides good control without climbing
     float rpy_scale = 1.0;                                          // this is used to scale the roll, pitch and yaw to fit within the motor limits
+    float compensation_gain = get_compensation_gain();              // voltage and air density compensation, the same for every motor
 
     int16_t rpy_out[AP_MOTORS_MAX_NUM_MOTORS]; // buffer so we don't have to multiply coefficients multiple times.
     int16_t motor_out[AP_MOTORS_MAX_NUM_MOTORS];    // final outputs sent to the motors
@@ -218,21 +213,7 @@ void AP_MotorsMatrix::output_armed_stabilizing()
 
     // calculate roll and pitch for each motor
     // set rpy_low and rpy_high to the lowest and highest values of the motors
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            rpy_out[i] = roll_pwm * _roll_factor[i] * get_compensation_gain() +
-                            pitch_pwm * _pitch_factor[i] * get_compensation_gain();
-
-            // record lowest roll pitch command
-            if (rpy_out[i] < rpy_low) {
-                rpy_low = rpy_out[i];
-            }
-            // record highest roll pich command
-            if (rpy_out[i] > rpy_high) {
-                rpy_high = rpy_out[i];
-            }
-        }
-    }
+    _mixer.mix_roll_pitch(roll_pwm * compensation_gain, pitch_pwm * compensation_gain, rpy_out, rpy_low, rpy_high);
 
     // calculate throttle that gives most possible room for yaw (range 1000 ~ 2000) which is the lower of:
     //      1. mid throttle - average of highest and lowest motor (this would give the maximum possible room margin above the highest motor and below the lowest)
@@ -253,39 +234,24 @@ void AP_MotorsMatrix::output_armed_stabilizing()
 
     if (yaw_pwm >= 0) {
         // if yawing right
-        if (yaw_allowed > yaw_pwm * get_compensation_gain()) {
-            yaw_allowed = yaw_pwm * get_compensation_gain(); // to-do: this is bad form for yaw_allows to change meaning to become the amount that we are going to output
+        if (yaw_allowed > yaw_pwm * compensation_gain) {
+            yaw_allowed = yaw_pwm * compensation_gain; // to-do: this is bad form for yaw_allows to change meaning to become the amount that we are going to output
         }else{
             limit.yaw = true;
         }
     }else{
         // if yawing left
         yaw_allowed = -yaw_allowed;
-        if (yaw_allowed < yaw_pwm * get_compensation_gain()) {
-            yaw_allowed = yaw_pwm * get_compensation_gain(); // to-do: this is bad form for yaw_allows to change meaning to become the amount that we are going to output
+        if (yaw_allowed < yaw_pwm * compensation_gain) {
+            yaw_allowed = yaw_pwm * compensation_gain; // to-do: this is bad form for yaw_allows to change meaning to become the amount that we are going to output
         }else{
             limit.yaw = true;
         }
     }
 
     // add yaw to intermediate numbers for each motor
-    rpy_low = 0;
-    rpy_high = 0;
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            rpy_out[i] =    rpy_out[i] +
-                            yaw_allowed * _yaw_factor[i];
-
-            // record lowest roll+pitch+yaw command
-            if( rpy_out[i] < rpy_low ) {
-                rpy_low = rpy_out[i];
-            }
-            // record highest roll+pitch+yaw command
-            if( rpy_out[i] > rpy_high) {
-                rpy_high = rpy_out[i];
-            }
-        }
-    }
+    // and record the lowest and highest roll+pitch+yaw commands
+    _mixer.mix_yaw(yaw_allowed, rpy_out, rpy_low, rpy_high);
 
     // check everything fits
     thr_adj = throttle_radio_output - out_best_thr_pwm;
@@ -337,33 +303,20 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     }
 
     // add scaled roll, pitch, constrained yaw and throttle for each motor
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            motor_out[i] = out_best_thr_pwm+thr_adj +
-                            rpy_scale*rpy_out[i];
-        }
-    }
+    _mixer.mix_throttle(out_best_thr_pwm+thr_adj, rpy_scale, rpy_out, motor_out);
 
     // apply thrust curve and voltage scaling
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            motor_out[i] = apply_thrust_curve_and_volt_scaling(motor_out[i], out_min_pwm, out_max_pwm);
-        }
-    }
+    apply_thrust_curve_and_volt_scaling(motor_out, num_motors, out_min_pwm, out_max_pwm);
 
     // clip motor output if required (shouldn't be)
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            motor_out[i] = constrain_int16(motor_out[i], out_min_pwm, out_max_pwm);
-        }
+    for (i=0; i<num_motors; i++) {
+        motor_out[i] = constrain_int16(motor_out[i], out_min_pwm, out_max_pwm);
     }
 
     // send output to each motor
     hal.rcout->cork();
-    for( i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++ ) {
-        if( motor_enabled[i] ) {
-            rc_write(i, motor_out[i]);
-        }
+    for (i=0; i<num_motors; i++) {
+        rc_write(_mixer.motor_num(i), motor_out[i]);
     }
     hal.rcout->push();
 }
@@ -415,6 +368,9 @@ void AP_MotorsMatrix::add_motor_raw(int8_t motor_num, float roll_fac, float pitc
         // set order that motor appears in test
         _test_order[motor_num] = testing_order;
 
+        // update the mixer with the new factors
+        _mixer.compile(motor_enabled, _roll_factor, _pitch_factor, _yaw_factor);
+
         uint8_t chan;
         if (RC_Channel_aux::find_channel((RC_Channel_aux::Aux_servo_function_t)(RC_Channel_aux::k_motor1+motor_num),
                                          chan)) {
@@ -454,6 +410,9 @@ void AP_MotorsMatrix::remove_motor(int8_t motor_num)
         _roll_factor[motor_num] = 0;
         _pitch_factor[motor_num] = 0;
         _yaw_factor[motor_num] = 0;
+
+        // drop the motor from the mixer
+        _mixer.compile(motor_enabled, _roll_factor, _pitch_factor, _yaw_factor);
     }
 }
 
@@ -0,0 +1,75 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_MotorsMixer.h"
+
+// compile - rebuilds the table from the per output factors, skipping disabled outputs
+void AP_MotorsMixer::compile(const bool enabled[AP_MOTORS_MAX_NUM_MOTORS],
+                             const float roll_factor[AP_MOTORS_MAX_NUM_MOTORS],
+                             const float pitch_factor[AP_MOTORS_MAX_NUM_MOTORS],
+                             const float yaw_factor[AP_MOTORS_MAX_NUM_MOTORS])
+{
+    _num_motors = 0;
+    for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (enabled[i]) {
+            _roll_factor[_num_motors] = roll_factor[i];
+            _pitch_factor[_num_motors] = pitch_factor[i];
+            _yaw_factor[_num_motors] = yaw_factor[i];
+            _motor_num[_num_motors] = i;
+            _num_motors++;
+        }
+    }
+}
+
+// mix_roll_pitch - sets rpy_out to each motor's roll and pitch command
+void AP_MotorsMixer::mix_roll_pitch(float roll_pwm, float pitch_pwm, int16_t rpy_out[], int16_t &rpy_low, int16_t &rpy_high) const
+{
+    int16_t low = 0;
+    int16_t high = 0;
+
+    for (uint8_t i=0; i<_num_motors; i++) {
+        rpy_out[i] = roll_pwm * _roll_factor[i] + pitch_pwm * _pitch_factor[i];
+        low = MIN(low, rpy_out[i]);
+        high = MAX(high, rpy_out[i]);
+    }
+
+    rpy_low = low;
+    rpy_high = high;
+}
+
+// mix_yaw - adds each motor's yaw command to rpy_out
+void AP_MotorsMixer::mix_yaw(float yaw_pwm, int16_t rpy_out[], int16_t &rpy_low, int16_t &rpy_high) const
+{
+    int16_t low = 0;
+    int16_t high = 0;
+
+    for (uint8_t i=0; i<_num_motors; i++) {
+        rpy_out[i] = rpy_out[i] + yaw_pwm * _yaw_factor[i];
+        low = MIN(low, rpy_out[i]);
+        high = MAX(high, rpy_out[i]);
+    }
+
+    rpy_low = low;
+    rpy_high = high;
+}
+
+// mix_throttle - sets motor_out to throttle plus the scaled rpy_out of each motor
+void AP_MotorsMixer::mix_throttle(int16_t throttle_pwm, float rpy_scale, const int16_t rpy_out[], int16_t motor_out[]) const
+{
+    for (uint8_t i=0; i<_num_motors; i++) {
+        motor_out[i] = throttle_pwm + rpy_scale * rpy_out[i];
+    }
+}
@@ -0,0 +1,52 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+/// @file	AP_MotorsMixer.h
+/// @brief	Compiled roll, pitch and yaw mix for Matrixcopters
+
+#ifndef __AP_MOTORS_MIXER_H__
+#define __AP_MOTORS_MIXER_H__
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include "AP_Motors_Class.h"
+
+/// @class      AP_MotorsMixer
+/// @brief      factors of the enabled motors only, packed together so that each
+///             mixing pass is a straight loop over the motors actually fitted
+class AP_MotorsMixer {
+public:
+    AP_MotorsMixer() :
+        _num_motors(0)
+    {};
+
+    // compile - rebuilds the table from the per output factors, skipping disabled outputs
+    void                compile(const bool enabled[AP_MOTORS_MAX_NUM_MOTORS],
+                                const float roll_factor[AP_MOTORS_MAX_NUM_MOTORS],
+                                const float pitch_factor[AP_MOTORS_MAX_NUM_MOTORS],
+                                const float yaw_factor[AP_MOTORS_MAX_NUM_MOTORS]);
+
+    // num_motors - number of enabled motors
+    uint8_t             num_motors() const { return _num_motors; }
+
+    // motor_num - output of the i'th enabled motor
+    uint8_t             motor_num(uint8_t i) const { return _motor_num[i]; }
+
+    // mix_roll_pitch - sets rpy_out to each motor's roll and pitch command
+    //  rpy_low and rpy_high are set to the lowest and highest commands, but never above or below zero
+    void                mix_roll_pitch(float roll_pwm, float pitch_pwm, int16_t rpy_out[], int16_t &rpy_low, int16_t &rpy_high) const;
+
+    // mix_yaw - adds each motor's yaw command to rpy_out, rpy_low and rpy_high as in mix_roll_pitch
+    void                mix_yaw(float yaw_pwm, int16_t rpy_out[], int16_t &rpy_low, int16_t &rpy_high) const;
+
+    // mix_throttle - sets motor_out to throttle plus the scaled rpy_out of each motor
+    void                mix_throttle(int16_t throttle_pwm, float rpy_scale, const int16_t rpy_out[], int16_t motor_out[]) const;
+
+private:
+    float               _roll_factor[AP_MOTORS_MAX_NUM_MOTORS];     // each enabled motor's contribution to roll
+    float               _pitch_factor[AP_MOTORS_MAX_NUM_MOTORS];    // each enabled motor's contribution to pitch
+    float               _yaw_factor[AP_MOTORS_MAX_NUM_MOTORS];      // each enabled motor's contribution to yaw
+    uint8_t             _motor_num[AP_MOTORS_MAX_NUM_MOTORS];       // output of each enabled motor
+    uint8_t             _num_motors;                                // number of enabled motors
+};
+
+#endif  // __AP_MOTORS_MIXER_H__
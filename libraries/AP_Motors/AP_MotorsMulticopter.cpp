@@ -146,6 +146,9 @@ void AP_MotorsMulticopter::output()
     // calc filtered battery voltage and lift_max
     update_lift_max_from_batt_voltage();
 
+    // rebuild thrust curve table if expo has changed
+    _thrust_curve.set_expo(_thrust_curve_expo);
+
     // move throttle_low_comp towards desired throttle low comp
     update_throttle_thr_mix();
 
@@ -242,19 +245,36 @@ void AP_MotorsMulticopter::current_limit_max_throttle()
 // apply_thrust_curve_and_volt_scaling - returns throttle curve adjusted pwm value (i.e. 1000 ~ 2000)
 int16_t AP_MotorsMulticopter::apply_thrust_curve_and_volt_scaling(int16_t pwm_out, int16_t pwm_min, int16_t pwm_max) const
 {
-    // convert to 0.0 to 1.0 ratio
-    float throttle_ratio = ((float)(pwm_out-pwm_min))/((float)(pwm_max-pwm_min));
+    apply_thrust_curve_and_volt_scaling(&pwm_out, 1, pwm_min, pwm_max);
+    return pwm_out;
+}
+
+// apply_thrust_curve_and_volt_scaling - thrust curve and voltage adjusted pwm values for num_motors motors
+void AP_MotorsMulticopter::apply_thrust_curve_and_volt_scaling(int16_t pwm_out[], uint8_t num_motors, int16_t pwm_min, int16_t pwm_max) const
+{
+    float pwm_range = pwm_max-pwm_min;
+    float pwm_limit = pwm_range*_thrust_curve_max+pwm_min;
+
+    // scale from pwm above pwm_min to 0.0 to 1.0 ratio
+    float ratio_scale = 1.0f/pwm_range;
+
+    // scale from throttle ratio to pwm above pwm_min, including maximum thrust point
+    float pwm_scale = _thrust_curve_max*pwm_range;
 
     // apply thrust curve - domain 0.0 to 1.0, range 0.0 to 1.0
-    if (_thrust_curve_expo > 0.0f){
-        throttle_ratio = ((_thrust_curve_expo-1.0f) + safe_sqrt((1.0f-_thrust_curve_expo)*(1.0f-_thrust_curve_expo) + 4.0f*_thrust_curve_expo*_lift_max*throttle_ratio))/(2.0f*_thrust_curve_expo*_batt_voltage_filt.get());
+    // the curve only depends on expo so lift max and voltage scaling are applied around it
+    float expo = _thrust_curve_expo;
+    if (expo > 0.0f) {
+        ratio_scale *= _lift_max;
+        pwm_scale /= _batt_voltage_filt.get();
     }
 
-    // scale to maximum thrust point
-    throttle_ratio *= _thrust_curve_max;
+    for (uint8_t i=0; i<num_motors; i++) {
+        float throttle_ratio = _thrust_curve.get(expo, (pwm_out[i]-pwm_min)*ratio_scale);
 
-    // convert back to pwm range, constrain and return
-    return (int16_t)constrain_float(throttle_ratio*(pwm_max-pwm_min)+pwm_min, pwm_min, (pwm_max-pwm_min)*_thrust_curve_max+pwm_min);
+        // convert back to pwm range and constrain
+        pwm_out[i] = (int16_t)constrain_float(throttle_ratio*pwm_scale+pwm_min, pwm_min, pwm_limit);
+    }
 }
 
 // update_lift_max from battery voltage - used for voltage compensation
@@ -7,6 +7,7 @@
 #define __AP_MOTORS_MULTICOPTER_H__
 
 #include "AP_Motors_Class.h"
+#include "AP_MotorsThrustCurve.h"
 
 #ifndef AP_MOTORS_DENSITY_COMP
 #define AP_MOTORS_DENSITY_COMP 1
@@ -114,6 +115,9 @@ protected:
     // apply_thrust_curve_and_volt_scaling - thrust curve and voltage adjusted pwm value (i.e. 1000 ~ 2000)
     int16_t             apply_thrust_curve_and_volt_scaling(int16_t pwm_out, int16_t pwm_min, int16_t pwm_max) const;
 
+    // apply_thrust_curve_and_volt_scaling - as above for num_motors values of pwm_out at once
+    void                apply_thrust_curve_and_volt_scaling(int16_t pwm_out[], uint8_t num_motors, int16_t pwm_min, int16_t pwm_max) const;
+
     // update_lift_max_from_batt_voltage - used for voltage compensation
     void                update_lift_max_from_batt_voltage();
 
@@ -175,6 +179,7 @@ protected:
     float               _batt_resistance;       // battery's resistance calculated by comparing resting voltage vs in flight voltage
     int16_t             _batt_timer;            // timer used in battery resistance calcs
     float               _lift_max;              // maximum lift ratio from battery voltage
+    AP_MotorsThrustCurve _thrust_curve;         // thrust curve table, rebuilt when _thrust_curve_expo changes
     float               _throttle_limit;        // ratio of throttle limit between hover and maximum
 };
 #endif  // __AP_MOTORS_MULTICOPTER_H__
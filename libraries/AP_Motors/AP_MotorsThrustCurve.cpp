@@ -0,0 +1,44 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_MotorsThrustCurve.h"
+
+// set_expo - rebuilds the table if expo has changed
+void AP_MotorsThrustCurve::set_expo(float expo)
+{
+    if (_use_lut && is_equal(expo, _expo)) {
+        return;
+    }
+
+    _expo = expo;
+    _use_lut = (expo > 0.0f && expo <= AP_MOTORS_THST_CURVE_LUT_EXPO_MAX);
+    if (!_use_lut) {
+        return;
+    }
+
+    for (uint8_t i=0; i<AP_MOTORS_THST_CURVE_LUT_SIZE; i++) {
+        _lut[i] = calc(expo, (float)i / (AP_MOTORS_THST_CURVE_LUT_SIZE-1));
+    }
+}
+
+// calc - calculates the curve directly
+float AP_MotorsThrustCurve::calc(float expo, float thrust)
+{
+    if (expo <= 0.0f) {
+        return thrust;
+    }
+    return ((expo-1.0f) + safe_sqrt((1.0f-expo)*(1.0f-expo) + 4.0f*expo*thrust))/(2.0f*expo);
+}
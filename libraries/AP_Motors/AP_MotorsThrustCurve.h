@@ -0,0 +1,54 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+
+/// @file	AP_MotorsThrustCurve.h
+/// @brief	Lookup table for the multicopter thrust curve
+
+#ifndef __AP_MOTORS_THRUST_CURVE_H__
+#define __AP_MOTORS_THRUST_CURVE_H__
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#define AP_MOTORS_THST_CURVE_LUT_SIZE       129     // table entries over thrust 0 ~ 1
+#define AP_MOTORS_THST_CURVE_LUT_EXPO_MAX   0.8f    // interpolation error near zero thrust is about 1us of pwm at this expo, above it the curve is calculated instead
+
+/// @class      AP_MotorsThrustCurve
+/// @brief      inverse of the thrust model thrust = (1-expo)*throttle + expo*throttle^2
+///             The table only depends on expo, so it is rebuilt when the parameter
+///             changes. Battery voltage scaling is applied by the caller around it.
+class AP_MotorsThrustCurve {
+public:
+    AP_MotorsThrustCurve() :
+        _expo(0.0f),
+        _use_lut(false)
+    {};
+
+    // set_expo - rebuilds the table if expo has changed
+    void                set_expo(float expo);
+
+    // get - returns the throttle ratio (0 ~ 1) producing thrust ratio (0 ~ 1) for the given expo
+    //  the table is used if it was built for expo, otherwise the curve is calculated
+    float               get(float expo, float thrust) const
+    {
+        thrust = constrain_float(thrust, 0.0f, 1.0f);
+        if (_use_lut && is_equal(expo, _expo)) {
+            float pos = thrust * (AP_MOTORS_THST_CURVE_LUT_SIZE-1);
+            uint8_t i = (uint8_t)pos;
+            if (i >= AP_MOTORS_THST_CURVE_LUT_SIZE-1) {
+                return _lut[AP_MOTORS_THST_CURVE_LUT_SIZE-1];
+            }
+            return _lut[i] + (_lut[i+1] - _lut[i]) * (pos - i);
+        }
+        return calc(expo, thrust);
+    }
+
+    // calc - calculates the curve directly
+    static float        calc(float expo, float thrust);
+
+private:
+    float               _expo;                                  // expo the table was built for
+    bool                _use_lut;                               // true if the table is valid for _expo
+    float               _lut[AP_MOTORS_THST_CURVE_LUT_SIZE];    // throttle ratio at evenly spaced thrust ratios
+};
+
+#endif  // __AP_MOTORS_THRUST_CURVE_H__
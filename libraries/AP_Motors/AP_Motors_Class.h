@@ -47,6 +47,9 @@ public:
     // set update rate to motors - a value in hertz
     virtual void        set_update_rate( uint16_t speed_hz ) { _speed_hz = speed_hz; };
 
+    // set the rate at which output() is called, if not the loop rate given to the constructor
+    void                set_loop_rate(uint16_t loop_rate) { _loop_rate = loop_rate; }
+
     // set frame orientation (normally + or X)
     virtual void        set_frame_orientation( uint8_t new_orientation ) { _flags.frame_orientation = new_orientation; };
 
@@ -0,0 +1,179 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Motors/AP_MotorsMatrix.h>
+
+/*
+  roll, pitch and yaw mixing of X frames from quad to octa, looping
+  over every output with enabled checks as AP_MotorsMatrix used to
+  and with the compiled AP_MotorsMixer, and the thrust curve
+  calculated and from its table
+ */
+
+#define BENCH_NUM_THRUSTS 64
+
+struct frame_motor {
+    float angle;
+    float yaw_factor;
+};
+
+static const frame_motor quad_x[] = {
+    {   45, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    { -135, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    {  -45, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+    {  135, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+};
+
+static const frame_motor hexa_x[] = {
+    {   90, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+    {  -90, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    {  -30, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+    {  150, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    {   30, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    { -150, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+};
+
+static const frame_motor octa_x[] = {
+    {   22.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+    { -157.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+    {   67.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    {  157.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    {  -22.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    { -112.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CCW },
+    {  -67.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+    {  112.5f, AP_MOTORS_MATRIX_YAW_FACTOR_CW  },
+};
+
+struct bench_frame {
+    bool enabled[AP_MOTORS_MAX_NUM_MOTORS];
+    float roll[AP_MOTORS_MAX_NUM_MOTORS];
+    float pitch[AP_MOTORS_MAX_NUM_MOTORS];
+    float yaw[AP_MOTORS_MAX_NUM_MOTORS];
+};
+
+// factors as set by AP_MotorsMatrix::add_motor(), frame chosen by number of motors
+static void setup_frame(uint8_t num_motors, bench_frame &frame)
+{
+    const frame_motor *motors = num_motors == 4 ? quad_x : num_motors == 6 ? hexa_x : octa_x;
+
+    memset(&frame, 0, sizeof(frame));
+    for (uint8_t i = 0; i < num_motors; i++) {
+        frame.enabled[i] = true;
+        frame.roll[i] = cosf(radians(motors[i].angle + 90));
+        frame.pitch[i] = cosf(radians(motors[i].angle));
+        frame.yaw[i] = motors[i].yaw_factor;
+    }
+}
+
+static void BM_MixPerOutput(benchmark::State& state)
+{
+    bench_frame frame;
+    setup_frame(state.range_x(), frame);
+    int16_t rpy_out[AP_MOTORS_MAX_NUM_MOTORS];
+    int16_t motor_out[AP_MOTORS_MAX_NUM_MOTORS];
+    float roll_pwm = 120, pitch_pwm = -80, yaw_pwm = 40;
+    gbenchmark_escape(&roll_pwm);
+
+    while (state.KeepRunning()) {
+        int16_t rpy_low = 0, rpy_high = 0;
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (frame.enabled[i]) {
+                rpy_out[i] = roll_pwm * frame.roll[i] + pitch_pwm * frame.pitch[i];
+                if (rpy_out[i] < rpy_low) {
+                    rpy_low = rpy_out[i];
+                }
+                if (rpy_out[i] > rpy_high) {
+                    rpy_high = rpy_out[i];
+                }
+            }
+        }
+        rpy_low = 0;
+        rpy_high = 0;
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (frame.enabled[i]) {
+                rpy_out[i] = rpy_out[i] + yaw_pwm * frame.yaw[i];
+                if (rpy_out[i] < rpy_low) {
+                    rpy_low = rpy_out[i];
+                }
+                if (rpy_out[i] > rpy_high) {
+                    rpy_high = rpy_out[i];
+                }
+            }
+        }
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (frame.enabled[i]) {
+                motor_out[i] = 1500 + 0.9f * rpy_out[i];
+            }
+        }
+        gbenchmark_escape(motor_out);
+        gbenchmark_escape(&rpy_low);
+        gbenchmark_escape(&rpy_high);
+    }
+}
+
+static void BM_MixCompiled(benchmark::State& state)
+{
+    bench_frame frame;
+    setup_frame(state.range_x(), frame);
+    AP_MotorsMixer mixer;
+    mixer.compile(frame.enabled, frame.roll, frame.pitch, frame.yaw);
+    int16_t rpy_out[AP_MOTORS_MAX_NUM_MOTORS];
+    int16_t motor_out[AP_MOTORS_MAX_NUM_MOTORS];
+    float roll_pwm = 120, pitch_pwm = -80, yaw_pwm = 40;
+    gbenchmark_escape(&roll_pwm);
+
+    while (state.KeepRunning()) {
+        int16_t rpy_low, rpy_high;
+        mixer.mix_roll_pitch(roll_pwm, pitch_pwm, rpy_out, rpy_low, rpy_high);
+        mixer.mix_yaw(yaw_pwm, rpy_out, rpy_low, rpy_high);
+        mixer.mix_throttle(1500, 0.9f, rpy_out, motor_out);
+        gbenchmark_escape(motor_out);
+        gbenchmark_escape(&rpy_low);
+        gbenchmark_escape(&rpy_high);
+    }
+}
+
+static void setup_thrusts(float *thrust)
+{
+    for (uint8_t i = 0; i < BENCH_NUM_THRUSTS; i++) {
+        thrust[i] = (float)i / (BENCH_NUM_THRUSTS - 1);
+    }
+}
+
+static void BM_ThrustCurveCalc(benchmark::State& state)
+{
+    float thrust[BENCH_NUM_THRUSTS];
+    setup_thrusts(thrust);
+    float expo = AP_MOTORS_THST_EXPO_DEFAULT;
+    gbenchmark_escape(&expo);
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_NUM_THRUSTS; i++) {
+            float throttle = AP_MotorsThrustCurve::calc(expo, thrust[i]);
+            gbenchmark_escape(&throttle);
+        }
+    }
+}
+
+static void BM_ThrustCurveLut(benchmark::State& state)
+{
+    float thrust[BENCH_NUM_THRUSTS];
+    setup_thrusts(thrust);
+    float expo = AP_MOTORS_THST_EXPO_DEFAULT;
+    gbenchmark_escape(&expo);
+    AP_MotorsThrustCurve curve;
+    curve.set_expo(expo);
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_NUM_THRUSTS; i++) {
+            float throttle = curve.get(expo, thrust[i]);
+            gbenchmark_escape(&throttle);
+        }
+    }
+}
+
+BENCHMARK(BM_MixPerOutput)->Arg(4)->Arg(6)->Arg(8);
+BENCHMARK(BM_MixCompiled)->Arg(4)->Arg(6)->Arg(8);
+BENCHMARK(BM_ThrustCurveCalc);
+BENCHMARK(BM_ThrustCurveLut);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,312 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "LatencyTrace.h"
+
+#include <string.h>
+
+#include <AP_Math/AP_Math.h>
+
+#if LATENCY_TRACE_EXPORT_ENABLED
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#ifdef PERF_LTTNG
+#include <AP_HAL_Linux/Perf_Lttng.h>
+#endif
+#endif
+
+extern const AP_HAL::HAL& hal;
+
+#if LATENCY_TRACE_EXPORT_ENABLED && !defined(PERF_LTTNG)
+#define LATENCY_TRACE_CHROME_FILE HAL_BOARD_LOG_DIRECTORY "/latency_trace.json"
+
+static const char *stage_names[LatencyTrace::STAGE_MAX] = {
+    "ahrs",
+    "rate_control",
+    "output",
+};
+#endif
+
+LatencyTrace::LatencyTrace() :
+    _enabled(false),
+    _active(false),
+    _token(),
+    _stats_sem(nullptr),
+    _count(0),
+#if LATENCY_TRACE_EXPORT_ENABLED
+    _export(false),
+    _io_registered(false),
+    _io_registered_ms(0),
+    _io_running(false),
+    _drain_sem(nullptr),
+    _buffer(nullptr),
+    _head(0),
+    _tail(0),
+    _export_failed(false),
+#ifndef PERF_LTTNG
+    _chrome_fd(-1),
+    _chrome_open_ms(0),
+#endif
+#endif
+    _dropped(0)
+{
+    reset_stats();
+}
+
+void LatencyTrace::set_enabled(bool enabled, bool export_tokens)
+{
+    if (enabled && _stats_sem == nullptr) {
+        _stats_sem = hal.util->new_semaphore();
+        if (_stats_sem == nullptr) {
+            return;
+        }
+    }
+    _enabled = enabled;
+    if (!enabled) {
+        _active = false;
+    }
+
+#if LATENCY_TRACE_EXPORT_ENABLED
+    if (enabled && export_tokens && _buffer == nullptr) {
+        if (_drain_sem == nullptr) {
+            _drain_sem = hal.util->new_semaphore();
+            if (_drain_sem == nullptr) {
+                return;
+            }
+        }
+        _buffer = new struct token[LATENCY_TRACE_BUFFER_SIZE];
+        if (_buffer == nullptr) {
+            return;
+        }
+    }
+    if (_buffer != nullptr && !_io_registered) {
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&LatencyTrace::io_update, void));
+        _io_registered = true;
+        _io_registered_ms = AP_HAL::millis();
+    }
+    _export = enabled && export_tokens && _buffer != nullptr && !_export_failed;
+
+    // the scheduler silently drops IO processes once its table is
+    // full. If ours has never run, empty the buffer from here
+    if (_io_registered && !_io_running &&
+        AP_HAL::millis() - _io_registered_ms > 1000) {
+        drain();
+    }
+#endif
+}
+
+void LatencyTrace::begin(uint32_t sample_us)
+{
+    if (!_enabled) {
+        return;
+    }
+    _token.start_us = AP_HAL::micros();
+    // no sample yet, or the arrival time is from a stale instance
+    _token.sample_us = (sample_us == 0 || _token.start_us - sample_us > 1000000U) ?
+        _token.start_us : sample_us;
+    _active = true;
+}
+
+void LatencyTrace::end()
+{
+    if (!_active) {
+        return;
+    }
+    _active = false;
+
+    if (_stats_sem->take_nonblocking()) {
+        for (uint8_t s = 0; s < STAGE_MAX; s++) {
+            const uint32_t latency = _token.stage_us[s] - _token.sample_us;
+            const uint32_t bucket = MIN(latency / LATENCY_TRACE_BUCKET_US, (uint32_t)LATENCY_TRACE_NUM_BUCKETS - 1);
+            _histogram[s][bucket]++;
+            _max[s] = MAX(_max[s], latency);
+        }
+        _count++;
+        _stats_sem->give();
+    } else {
+        _dropped++;
+    }
+
+#if LATENCY_TRACE_EXPORT_ENABLED
+    if (_export) {
+        const uint16_t head = _head;
+        const uint16_t next = (head + 1) & (LATENCY_TRACE_BUFFER_SIZE - 1);
+        if (next == _tail) {
+            _dropped++;
+            return;
+        }
+        _buffer[head] = _token;
+        // the token must be complete before the IO thread can see it
+        __sync_synchronize();
+        _head = next;
+    }
+#endif
+}
+
+void LatencyTrace::get_stats(enum stage s, struct stats &st) const
+{
+    memset(&st, 0, sizeof(st));
+    if (_stats_sem == nullptr) {
+        // never enabled
+        return;
+    }
+    if (!_stats_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        AP_HAL::panic("LatencyTrace: unable to get semaphore");
+    }
+
+    st.count = _count;
+    st.max = _max[s];
+
+    // upper edge of the bucket holding each percentile
+    const uint32_t n50 = (_count * 50 + 99) / 100;
+    const uint32_t n95 = (_count * 95 + 99) / 100;
+    const uint32_t n99 = (_count * 99 + 99) / 100;
+    st.p50 = st.p95 = st.p99 = 0;
+    uint32_t sum = 0;
+    for (uint16_t b = 0; b < LATENCY_TRACE_NUM_BUCKETS && sum < n99; b++) {
+        const uint32_t prev = sum;
+        sum += _histogram[s][b];
+        const uint16_t edge_us = (b + 1) * LATENCY_TRACE_BUCKET_US;
+        if (prev < n50 && sum >= n50) {
+            st.p50 = edge_us;
+        }
+        if (prev < n95 && sum >= n95) {
+            st.p95 = edge_us;
+        }
+        if (sum >= n99) {
+            st.p99 = edge_us;
+        }
+    }
+
+    _stats_sem->give();
+}
+
+void LatencyTrace::reset_stats()
+{
+    if (_stats_sem != nullptr && !_stats_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        AP_HAL::panic("LatencyTrace: unable to get semaphore");
+    }
+    memset(_histogram, 0, sizeof(_histogram));
+    memset(_max, 0, sizeof(_max));
+    _count = 0;
+    if (_stats_sem != nullptr) {
+        _stats_sem->give();
+    }
+}
+
+#if LATENCY_TRACE_EXPORT_ENABLED
+/*
+  called from the IO thread
+ */
+void LatencyTrace::io_update()
+{
+    _io_running = true;
+    drain();
+}
+
+/*
+  write out the tokens in the export buffer. Only one thread may
+  consume them at a time
+ */
+void LatencyTrace::drain()
+{
+    if (!_drain_sem->take_nonblocking()) {
+        return;
+    }
+    uint16_t tail = _tail;
+    while (tail != _head) {
+        // read the token before releasing its slot
+        __sync_synchronize();
+        export_token(_buffer[tail]);
+        tail = (tail + 1) & (LATENCY_TRACE_BUFFER_SIZE - 1);
+        _tail = tail;
+    }
+    _drain_sem->give();
+}
+
+#ifdef PERF_LTTNG
+void LatencyTrace::export_token(const struct token &t)
+{
+    Linux::Perf_Lttng::latency(t.sample_us, t.start_us, t.stage_us[STAGE_AHRS],
+                               t.stage_us[STAGE_RATE_CONTROL], t.stage_us[STAGE_OUTPUT]);
+}
+#else
+/*
+  write the token as Chrome trace complete events: the wait from the
+  sample arriving to the start of the loop, then each stage. The
+  closing ] of the array is optional in this format, so the file is
+  valid whenever it is read
+ */
+void LatencyTrace::export_token(const struct token &t)
+{
+    if (_export_failed) {
+        _dropped++;
+        return;
+    }
+    if (_chrome_fd == -1) {
+        const uint32_t now_ms = AP_HAL::millis();
+        if (_chrome_open_ms != 0 && now_ms - _chrome_open_ms < LATENCY_TRACE_OPEN_RETRY_MS) {
+            _dropped++;
+            return;
+        }
+        _chrome_open_ms = now_ms;
+        _chrome_fd = ::open(LATENCY_TRACE_CHROME_FILE, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+        if (_chrome_fd == -1) {
+            // no log directory yet, try again later
+            _dropped++;
+            return;
+        }
+        if (::write(_chrome_fd, "[\n", 2) != 2) {
+            export_failed();
+            return;
+        }
+    }
+
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf),
+                       "{\"name\":\"sample\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%u,\"dur\":%u},\n",
+                       (unsigned)t.sample_us, (unsigned)(t.start_us - t.sample_us));
+    uint32_t stage_start_us = t.start_us;
+    for (uint8_t s = 0; s < STAGE_MAX && len < (int)sizeof(buf); s++) {
+        len += snprintf(&buf[len], sizeof(buf) - len,
+                        "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%u,\"dur\":%u},\n",
+                        stage_names[s], (unsigned)stage_start_us,
+                        (unsigned)(t.stage_us[s] - stage_start_us));
+        stage_start_us = t.stage_us[s];
+    }
+    if (len <= 0 || len >= (int)sizeof(buf)) {
+        _dropped++;
+        return;
+    }
+    if (::write(_chrome_fd, buf, len) != len) {
+        export_failed();
+    }
+}
+
+/*
+  give up on the trace file after a write error, most likely a full
+  disk, rather than retrying for every token
+ */
+void LatencyTrace::export_failed()
+{
+    ::close(_chrome_fd);
+    _chrome_fd = -1;
+    _export_failed = true;
+    _dropped++;
+    hal.console->printf("LatencyTrace: write to %s failed, export stopped\n", LATENCY_TRACE_CHROME_FILE);
+}
+#endif // PERF_LTTNG
+#endif // LATENCY_TRACE_EXPORT_ENABLED
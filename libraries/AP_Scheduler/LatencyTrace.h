@@ -0,0 +1,145 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  sensor to output latency tracing for the main loop
+
+  The main loop carries a token through the stages between an IMU
+  sample arriving and the motor outputs being pushed: begin() with the
+  arrival time of the sample, mark() at the end of each stage and
+  end() once the outputs are out. Completed tokens update a latency
+  histogram per stage, from which get_stats() gives percentiles for
+  logging.
+
+  With export enabled, tokens are also queued in a lock free single
+  producer buffer owned by the tracing thread, and the IO thread
+  writes them out: as LTTng events on Linux builds with PERF_LTTNG,
+  otherwise as a Chrome trace (chrome://tracing) in the log directory.
+  If the scheduler has no room for the IO process, set_enabled()
+  drains the buffer instead. Tokens that can't be written are dropped,
+  and export stops for good after a write error.
+
+  Tokens may be completed on a different thread to the one reading
+  the stats, so the histogram is guarded by a semaphore. The tracing
+  thread never waits for it, and leaves a token out of the stats
+  instead.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+#define LATENCY_TRACE_EXPORT_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+
+// histogram resolution and range. Latencies beyond the range count in
+// the last bucket
+#define LATENCY_TRACE_BUCKET_US 20
+#define LATENCY_TRACE_NUM_BUCKETS 128
+
+// tokens queued for export, must be a power of 2
+#define LATENCY_TRACE_BUFFER_SIZE 256
+
+// how long to wait before trying to open the trace file again
+#define LATENCY_TRACE_OPEN_RETRY_MS 5000
+
+class LatencyTrace
+{
+public:
+    enum stage {
+        STAGE_AHRS         = 0,
+        STAGE_RATE_CONTROL = 1,
+        STAGE_OUTPUT       = 2,
+        STAGE_MAX
+    };
+
+    // latencies from the sample to the end of a stage, microseconds
+    struct stats {
+        uint32_t count;
+        uint16_t p50;
+        uint16_t p95;
+        uint16_t p99;
+        uint32_t max;
+    };
+
+    LatencyTrace();
+
+    // start or stop tracing, and exporting each token. Call at about
+    // 1Hz from the main thread
+    void set_enabled(bool enabled, bool export_tokens);
+
+    // start a token for a sample that arrived at sample_us
+    void begin(uint32_t sample_us);
+
+    // record the end of a stage
+    void mark(enum stage s) {
+        if (_active) {
+            _token.stage_us[s] = AP_HAL::micros();
+        }
+    }
+
+    // complete the token, updating the stats and queueing it for export
+    void end();
+
+    // stats of the tokens since the last reset_stats()
+    void get_stats(enum stage s, struct stats &st) const;
+    void reset_stats();
+
+    // tokens lost because the export buffer was full or couldn't be
+    // written, or left out of the stats while they were being read
+    uint32_t get_dropped() const { return _dropped; }
+
+private:
+    struct token {
+        uint32_t sample_us;
+        uint32_t start_us;
+        uint32_t stage_us[STAGE_MAX];
+    };
+
+    bool _enabled;
+    bool _active;
+    struct token _token;
+
+    AP_HAL::Semaphore *_stats_sem;
+    uint32_t _histogram[STAGE_MAX][LATENCY_TRACE_NUM_BUCKETS];
+    uint32_t _count;
+    uint32_t _max[STAGE_MAX];
+
+#if LATENCY_TRACE_EXPORT_ENABLED
+    void io_update();
+    void drain();
+    void export_token(const struct token &t);
+#ifndef PERF_LTTNG
+    void export_failed();
+#endif
+
+    bool _export;
+    bool _io_registered;
+    uint32_t _io_registered_ms;
+    volatile bool _io_running;
+    // held by whichever thread is draining the buffer
+    AP_HAL::Semaphore *_drain_sem;
+    // written only by the tracing thread (_head) and the IO thread (_tail)
+    struct token *_buffer;
+    volatile uint16_t _head;
+    volatile uint16_t _tail;
+    // set by the IO thread once a token couldn't be written
+    volatile bool _export_failed;
+#ifndef PERF_LTTNG
+    int _chrome_fd;
+    uint32_t _chrome_open_ms;
+#endif
+#endif
+    uint32_t _dropped;
+};
@@ -0,0 +1,85 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AP_SharedCommand.h"
+
+#if AP_SHARED_STATE_AVAILABLE
+
+#include <new>
+#include <unistd.h>
+
+bool AP_SharedCommand::init(const char *name)
+{
+    if (_region != nullptr) {
+        return true;
+    }
+
+    void *p = AP_SharedState::map_object(name, sizeof(ap_shared_command_region), true);
+    if (p == nullptr) {
+        return false;
+    }
+
+    // drop anything a writer left from before this boot. Writers must
+    // wait for the magic before publishing
+    ap_shared_command_region *region = (ap_shared_command_region *)p;
+    region->magic = 0;
+    __sync_synchronize();
+    new (&region->command) AP_HAL::DoubleBuffer<ap_shared_command>();
+    region->version = AP_SHARED_STATE_VERSION;
+    region->command_size = sizeof(ap_shared_command);
+    region->reader_pid = getpid();
+    region->accepted_sequence = 0;
+    region->rejected_count = 0;
+    __sync_synchronize();
+    region->magic = AP_SHARED_COMMAND_MAGIC;
+
+    _region = region;
+    _last_count = 0;
+    return true;
+}
+
+bool AP_SharedCommand::read(ap_shared_command &cmd)
+{
+    if (_region == nullptr) {
+        return false;
+    }
+    // only copy the command out when there is a new one
+    const uint32_t count = _region->command.count();
+    if (count == _last_count) {
+        return false;
+    }
+    // the writer is another process that may be preempted or stopped
+    // mid write, so don't spin on it. A command that can't be copied
+    // out cleanly is picked up on a later call
+    if (!_region->command.read(cmd, AP_SHARED_COMMAND_READ_TRIES)) {
+        return false;
+    }
+    _last_count = count;
+    return true;
+}
+
+#else
+
+bool AP_SharedCommand::init(const char *name)
+{
+    return false;
+}
+
+bool AP_SharedCommand::read(ap_shared_command &cmd)
+{
+    return false;
+}
+
+#endif // AP_SHARED_STATE_AVAILABLE
@@ -0,0 +1,49 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  command input from other processes on the same board through a
+  POSIX shared memory object, the counterpart of AP_SharedState
+ */
+
+#include "AP_SharedState.h"
+
+// attempts at copying out a command before leaving it for the next call
+#define AP_SHARED_COMMAND_READ_TRIES 3
+
+class AP_SharedCommand {
+public:
+    AP_SharedCommand() : _region(nullptr), _last_count(0) { }
+
+    // create and map the shared memory object. Returns false if the
+    // board has no shared memory or the object can't be created
+    bool init(const char *name);
+
+    bool enabled() const { return _region != nullptr; }
+
+    // get a command the writer has published since the last call.
+    // Cheap enough to poll every loop
+    bool read(ap_shared_command &cmd);
+
+    // report the outcome of the last command read back to the writer
+    void accept(const ap_shared_command &cmd) { _region->accepted_sequence = cmd.sequence; }
+    void reject() { _region->rejected_count++; }
+
+private:
+    ap_shared_command_region *_region;
+    uint32_t _last_count;
+};
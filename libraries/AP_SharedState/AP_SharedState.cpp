@@ -0,0 +1,103 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AP_SharedState.h"
+
+#if AP_SHARED_STATE_AVAILABLE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern const AP_HAL::HAL& hal;
+
+void *AP_SharedState::map_object(const char *name, uint32_t size, bool others_write)
+{
+    // readers only need to map the state, so leave it readable by
+    // anyone. Channels written by other processes are opened to the
+    // vehicle's group only, as they can command the vehicle
+    const mode_t mode = others_write ? 0660 : 0644;
+    int fd = shm_open(name, O_RDWR | O_CREAT, mode);
+    if (fd == -1) {
+        hal.console->printf("SharedState: shm_open %s failed - %s\n",
+                            name, strerror(errno));
+        return nullptr;
+    }
+    if (others_write) {
+        // don't let the umask take the group write permission back off
+        fchmod(fd, mode);
+    }
+    if (ftruncate(fd, size) != 0) {
+        hal.console->printf("SharedState: ftruncate %s failed - %s\n",
+                            name, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // the mapping holds its own reference to the object
+    close(fd);
+    if (p == MAP_FAILED) {
+        hal.console->printf("SharedState: mmap %s failed - %s\n",
+                            name, strerror(errno));
+        return nullptr;
+    }
+    return p;
+}
+
+bool AP_SharedState::init(const char *name)
+{
+    if (_region != nullptr) {
+        return true;
+    }
+
+    void *p = map_object(name, sizeof(ap_shared_state_region), false);
+    if (p == nullptr) {
+        return false;
+    }
+
+    // the object may be left over from an earlier run with readers
+    // still attached. Invalidate it before resetting the contents
+    ap_shared_state_region *region = (ap_shared_state_region *)p;
+    region->magic = 0;
+    __sync_synchronize();
+    new (&region->state) AP_HAL::DoubleBuffer<ap_shared_state>();
+    region->version = AP_SHARED_STATE_VERSION;
+    region->state_size = sizeof(ap_shared_state);
+    region->writer_pid = getpid();
+    __sync_synchronize();
+    region->magic = AP_SHARED_STATE_MAGIC;
+
+    _region = region;
+    return true;
+}
+
+#else
+
+void *AP_SharedState::map_object(const char *name, uint32_t size, bool others_write)
+{
+    return nullptr;
+}
+
+bool AP_SharedState::init(const char *name)
+{
+    return false;
+}
+
+#endif // AP_SHARED_STATE_AVAILABLE
@@ -0,0 +1,62 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  export of vehicle state to other processes on the same board through
+  a POSIX shared memory object. See AP_SharedState_Protocol.h for the
+  layout consumers map
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include "AP_SharedState_Protocol.h"
+
+#ifndef AP_SHARED_STATE_AVAILABLE
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define AP_SHARED_STATE_AVAILABLE 1
+#else
+#define AP_SHARED_STATE_AVAILABLE 0
+#endif
+#endif
+
+class AP_SharedState {
+public:
+    AP_SharedState() : _region(nullptr) { }
+
+    // create and map the shared memory object. Returns false if the
+    // board has no shared memory or the object can't be created, in
+    // which case publish() does nothing
+    bool init(const char *name);
+
+    bool enabled() const { return _region != nullptr; }
+
+    // create, size and map a shared memory object, returning nullptr
+    // on failure. others_write lets other processes of the vehicle's
+    // group write to it, for the command channel
+    static void *map_object(const char *name, uint32_t size, bool others_write);
+
+    // make a new state visible to readers. Must only be called from
+    // one thread
+    void publish(const ap_shared_state &state)
+    {
+        if (_region != nullptr) {
+            _region->state.write(state);
+        }
+    }
+
+private:
+    ap_shared_state_region *_region;
+};
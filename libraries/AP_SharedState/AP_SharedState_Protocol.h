@@ -0,0 +1,167 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  layout of the vehicle state exported through POSIX shared memory for
+  processes running on the same board, such as companion computer
+  software on a Linux flight controller.
+
+  This header is meant to be included by those processes as well as
+  the vehicle, so it only depends on the standard integer types and
+  AP_HAL::DoubleBuffer. A reader does:
+
+    char name[AP_SHARED_OBJECT_NAME_MAX];
+    snprintf(name, sizeof(name), AP_SHARED_STATE_NAME "_%u", sysid);
+    int fd = shm_open(name, O_RDONLY, 0);
+    const ap_shared_state_region *r = (const ap_shared_state_region *)
+        mmap(nullptr, sizeof(*r), PROT_READ, MAP_SHARED, fd, 0);
+    ap_shared_state s;
+    if (r->magic == AP_SHARED_STATE_MAGIC &&
+        r->version == AP_SHARED_STATE_VERSION &&
+        r->state.read(s)) {
+        // s is a consistent copy of the latest fast loop
+    }
+
+  Reading never blocks the vehicle.
+
+  Commands go the other way through AP_SHARED_COMMAND_NAME, which the
+  vehicle creates writable by its group. A single writer process
+  fills in an ap_shared_command, echoing the time_us of the state it
+  was calculated from, bumps the sequence and calls
+  command.write(). The vehicle polls it every fast loop and reports
+  the last sequence it accepted, and how many it rejected, back in the
+  region.
+
+  Bump AP_SHARED_STATE_VERSION for any change to the structures below.
+ */
+
+#include <stdint.h>
+#include <AP_HAL/utility/DoubleBuffer.h>
+
+// objects are named with the vehicle's MAVLink system ID appended,
+// e.g. "/ardupilot_state_1", so several vehicles or SITL instances on
+// one board each get their own
+#define AP_SHARED_STATE_NAME        "/ardupilot_state"
+#define AP_SHARED_COMMAND_NAME      "/ardupilot_command"
+#define AP_SHARED_OBJECT_NAME_MAX   32
+#define AP_SHARED_STATE_MAGIC       0x41505353  // "APSS"
+#define AP_SHARED_COMMAND_MAGIC     0x41505343  // "APSC"
+#define AP_SHARED_STATE_VERSION     2
+
+// one fast loop worth of vehicle state. All frames are NED unless
+// noted, positions and velocities are in the inertial nav NEU frame
+// relative to the EKF origin, as used by the position controller
+struct ap_shared_state {
+    uint64_t time_us;               // AP_HAL::micros64() when published
+
+    // vehicle status
+    int8_t   control_mode;          // Copter flight mode number
+    uint8_t  armed;
+    uint8_t  land_complete;
+    uint8_t  home_state;
+    uint16_t filter_status;         // nav_filter_status flags
+    uint16_t reserved;
+
+    // AHRS
+    float    attitude[3];           // roll, pitch, yaw in radians
+    float    gyro[3];               // drift corrected body rates in rad/s
+    float    accel_ef[3];           // earth frame acceleration in m/s/s
+
+    // inertial nav
+    int32_t  lat;                   // degrees * 1e7
+    int32_t  lng;                   // degrees * 1e7
+    float    position[3];           // cm from EKF origin, NEU
+    float    velocity[3];           // cm/s, NEU
+
+    // controller targets
+    float    pos_target[3];         // cm from EKF origin, NEU
+    float    vel_target[3];         // cm/s, NEU
+    float    accel_target[3];       // cm/s/s, NEU
+    float    att_target[3];         // roll, pitch, yaw in centi-degrees
+
+    // RUAS detection and avoidance
+    float    rel_d[3];              // last relative distance from the detection hardware
+    float    rel_v[3];              // last relative velocity from the detection hardware
+    float    rel_d_filt[3];         // interpolated relative distance
+    float    rel_v_filt[3];         // interpolated relative velocity
+    float    detect_health;
+    float    avoidance_roll_cd;
+    float    avoidance_pitch_cd;
+    uint8_t  do_avoid_maneuver;
+    uint8_t  do_track_maneuver;
+    uint8_t  reserved2[2];
+};
+
+// the whole shared memory object. magic is written last, once the
+// rest of the region is initialised
+struct ap_shared_state_region {
+    volatile uint32_t magic;
+    uint16_t version;
+    uint16_t state_size;            // sizeof(ap_shared_state)
+    uint32_t writer_pid;
+    AP_HAL::DoubleBuffer<ap_shared_state> state;
+};
+
+// what an ap_shared_command asks for
+enum ap_shared_command_type {
+    AP_SHARED_COMMAND_NONE      = 0,
+    AP_SHARED_COMMAND_POSITION  = 1,    // guided position target
+    AP_SHARED_COMMAND_VELOCITY  = 2,    // guided velocity target
+    AP_SHARED_COMMAND_POSVEL    = 3,    // guided position and velocity target
+    AP_SHARED_COMMAND_AVOIDANCE = 4,    // RUAS avoidance targets
+};
+
+// frame of the position and velocity of an ap_shared_command. These
+// match the MAVLink SET_POSITION_TARGET_LOCAL_NED frames
+enum ap_shared_command_frame {
+    AP_SHARED_COMMAND_FRAME_LOCAL_NED        = 0,   // position relative to home
+    AP_SHARED_COMMAND_FRAME_LOCAL_OFFSET_NED = 1,   // position relative to the vehicle
+    AP_SHARED_COMMAND_FRAME_BODY_OFFSET_NED  = 2,   // as above, rotated by vehicle yaw
+};
+
+struct ap_shared_command {
+    uint64_t state_time_us;         // time_us of the ap_shared_state used
+    uint32_t sequence;              // bumped by the writer for each command
+    uint8_t  type;                  // ap_shared_command_type
+    uint8_t  frame;                 // ap_shared_command_frame
+    uint16_t reserved;
+
+    // guided targets, in metres and m/s
+    float    pos[3];
+    float    vel[3];
+
+    // RUAS avoidance, replacing the onboard avoidance manoeuvre
+    float    avoidance_roll_cd;
+    float    avoidance_pitch_cd;
+    uint8_t  do_avoid_maneuver;
+    uint8_t  do_track_maneuver;
+    uint8_t  reserved2[2];
+};
+
+struct ap_shared_command_region {
+    volatile uint32_t magic;
+    uint16_t version;
+    uint16_t command_size;          // sizeof(ap_shared_command)
+    uint32_t reader_pid;
+
+    // written by the vehicle
+    volatile uint32_t accepted_sequence;
+    volatile uint32_t rejected_count;
+
+    // written by the companion
+    AP_HAL::DoubleBuffer<ap_shared_command> command;
+};
@@ -44,11 +44,18 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping at least 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
     // @Units: meters
     // @Increment: 1
     AP_GROUPINFO("SPACING",   1, AP_Terrain, grid_spacing, 100),
 
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain cache size
+    // @Description: The number of grid blocks of terrain data to keep in memory. Each block takes about 2 kilobytes. A larger cache lets the vehicle fetch blocks ahead of its path and avoids waiting on SD card reads at grid boundaries. If the cache can't be allocated the minimum of 12 is used instead. Takes effect on the next boot.
+    // @Range: 12 128
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ",  2, AP_Terrain, cache_size_blocks, TERRAIN_GRID_BLOCK_CACHE_SIZE_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -103,39 +110,10 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height)
     // find the grid
     const struct grid_block &grid = find_grid_cache(info).grid;
 
-    /*
-      note that we rely on the one square overlap to ensure these
-      calculations don't go past the end of the arrays
-     */
-    ASSERT_RANGE(info.idx_x, 0, TERRAIN_GRID_BLOCK_SIZE_X-2);
-    ASSERT_RANGE(info.idx_y, 0, TERRAIN_GRID_BLOCK_SIZE_Y-2);
-
-
-    // check we have all 4 required heights
-    if (!check_bitmap(grid, info.idx_x,   info.idx_y) ||
-        !check_bitmap(grid, info.idx_x,   info.idx_y+1) ||
-        !check_bitmap(grid, info.idx_x+1, info.idx_y) ||
-        !check_bitmap(grid, info.idx_x+1, info.idx_y+1)) {
+    if (!interpolate_height(grid, info, height)) {
         return false;
     }
 
-    // hXY are the heights of the 4 surrounding grid points
-    int16_t h00, h01, h10, h11;
-
-    h00 = grid.height[info.idx_x+0][info.idx_y+0];
-    h01 = grid.height[info.idx_x+0][info.idx_y+1];
-    h10 = grid.height[info.idx_x+1][info.idx_y+0];
-    h11 = grid.height[info.idx_x+1][info.idx_y+1];
-
-    // do a simple dual linear interpolation. We could do something
-    // fancier, but it probably isn't worth it as long as the
-    // grid_spacing is kept small enough
-    float avg1 = (1.0f-info.frac_x) * h00  + info.frac_x * h10;
-    float avg2 = (1.0f-info.frac_x) * h01  + info.frac_x * h11;
-    float avg  = (1.0f-info.frac_y) * avg1 + info.frac_y * avg2;
-
-    height = avg;
-
     if (loc.lat == ahrs.get_home().lat &&
         loc.lng == ahrs.get_home().lng) {
         // remember home altitude as a special case
@@ -146,6 +124,81 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height)
     return true;
 }
 
+/*
+  return terrain heights in meters above sea level for an array of
+  locations, setting valid[i] for each location that has terrain
+  data. Returns the number of valid heights.
+
+  Locations are grouped by grid_block in chunks. Within a chunk each
+  grid_block is found once and reused for every location in it, so a
+  route profile (where consecutive points share blocks) costs one
+  cache lookup per block rather than per point. Each height is then
+  interpolated on its own, as height_amsl() does
+ */
+uint16_t AP_Terrain::height_amsl_grouped(const Location *locs, float *heights, bool *valid, uint16_t count)
+{
+    memset(valid, 0, count * sizeof(valid[0]));
+    if (!enable || !allocate()) {
+        return 0;
+    }
+
+    uint16_t num_valid = 0;
+    struct grid_info info[TERRAIN_GROUP_CHUNK_SIZE];
+    bool done[TERRAIN_GROUP_CHUNK_SIZE];
+
+    for (uint16_t base=0; base<count; base += TERRAIN_GROUP_CHUNK_SIZE) {
+        uint8_t n = MIN(count - base, TERRAIN_GROUP_CHUNK_SIZE);
+
+        for (uint8_t i=0; i<n; i++) {
+            const Location &loc = locs[base+i];
+            // quick access for home altitude
+            if (loc.lat == home_loc.lat &&
+                loc.lng == home_loc.lng) {
+                heights[base+i] = home_height;
+                valid[base+i] = true;
+                num_valid++;
+                done[i] = true;
+                continue;
+            }
+            calculate_grid_index(loc, info[i]);
+            done[i] = false;
+        }
+
+        for (uint8_t i=0; i<n; i++) {
+            if (done[i]) {
+                continue;
+            }
+            // the SW corner is only needed once per block
+            calculate_grid_corner(info[i]);
+            const struct grid_block &grid = find_grid_cache(info[i]).grid;
+
+            for (uint8_t j=i; j<n; j++) {
+                if (done[j] ||
+                    info[j].lat_degrees != info[i].lat_degrees ||
+                    info[j].lon_degrees != info[i].lon_degrees ||
+                    info[j].grid_idx_x != info[i].grid_idx_x ||
+                    info[j].grid_idx_y != info[i].grid_idx_y) {
+                    continue;
+                }
+                done[j] = true;
+                if (!interpolate_height(grid, info[j], heights[base+j])) {
+                    continue;
+                }
+                valid[base+j] = true;
+                num_valid++;
+                const Location &loc = locs[base+j];
+                if (loc.lat == ahrs.get_home().lat &&
+                    loc.lng == ahrs.get_home().lng) {
+                    // remember home altitude as a special case
+                    home_height = heights[base+j];
+                    home_loc = loc;
+                }
+            }
+        }
+    }
+
+    return num_valid;
+}
 
 /* 
    find difference between home terrain height and the terrain height
@@ -268,16 +321,26 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
     float climb = 0;
     float lookahead_estimate = 0;
 
-    // check for terrain at grid spacing intervals
+    // check for terrain at grid spacing intervals, a chunk of points
+    // at a time
+    Location locs[TERRAIN_GROUP_CHUNK_SIZE];
+    float heights[TERRAIN_GROUP_CHUNK_SIZE];
+    bool valid[TERRAIN_GROUP_CHUNK_SIZE];
     while (distance > 0) {
-        location_update(loc, bearing, grid_spacing);
-        climb += climb_ratio * grid_spacing;
-        distance -= grid_spacing;
-        float height;
-        if (height_amsl(loc, height)) {
-            float rise = (height - base_height) - climb;
-            if (rise > lookahead_estimate) {
-                lookahead_estimate = rise;
+        uint8_t n = 0;
+        while (distance > 0 && n < TERRAIN_GROUP_CHUNK_SIZE) {
+            location_update(loc, bearing, grid_spacing);
+            distance -= grid_spacing;
+            locs[n++] = loc;
+        }
+        height_amsl_grouped(locs, heights, valid, n);
+        for (uint8_t i=0; i<n; i++) {
+            climb += climb_ratio * grid_spacing;
+            if (valid[i]) {
+                float rise = (heights[i] - base_height) - climb;
+                if (rise > lookahead_estimate) {
+                    lookahead_estimate = rise;
+                }
             }
         }
     }
@@ -296,6 +359,11 @@ void AP_Terrain::update(void)
     // just schedule any needed disk IO
     schedule_disk_io();
 
+    // load the grids we are about to fly into. This is done before
+    // the lookups below so the current grids keep the most recent
+    // access time
+    update_prefetch();
+
     // try to ensure the home location is populated
     float height;
     height_amsl(ahrs.get_home(), height);
@@ -382,13 +450,30 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
-    if (cache == nullptr) {
+    uint16_t size = constrain_int16(cache_size_blocks, TERRAIN_GRID_BLOCK_CACHE_SIZE, TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX);
+    cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
+    if (cache == nullptr && size > TERRAIN_GRID_BLOCK_CACHE_SIZE) {
+        // fall back to the minimum cache rather than no terrain at all
+        size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+        cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
+    }
+    cache_hash = (uint16_t *)malloc(TERRAIN_GRID_CACHE_HASH_SIZE * sizeof(cache_hash[0]));
+    if (cache == nullptr || cache_hash == nullptr) {
+        free(cache);
+        free(cache_hash);
+        cache = nullptr;
+        cache_hash = nullptr;
         enable.set(0);
         GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    for (uint16_t i=0; i<TERRAIN_GRID_CACHE_HASH_SIZE; i++) {
+        cache_hash[i] = TERRAIN_GRID_CACHE_NONE;
+    }
+    for (uint16_t i=0; i<size; i++) {
+        cache[i].hash_next = TERRAIN_GRID_CACHE_NONE;
+    }
+    cache_size = size;
     return true;
 }
 
@@ -36,6 +36,16 @@
 
 #define TERRAIN_DEBUG 0
 
+// on Linux based boards the degree files are memory mapped rather
+// than accessed with lseek()/read()/write()
+#ifndef TERRAIN_USE_MMAP
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define TERRAIN_USE_MMAP 1
+#else
+#define TERRAIN_USE_MMAP 0
+#endif
+#endif
+
 
 // MAVLink sends 4x4 grids
 #define TERRAIN_GRID_MAVLINK_SIZE 4
@@ -55,9 +65,39 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// minimum number of grid_blocks in the LRU memory cache
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
 
+// maximum number of grid_blocks in the LRU memory cache
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX 128
+
+// default for TERRAIN_CACHE_SZ. Boards with megabytes of memory can
+// afford a much larger cache, which avoids waiting on disk reads at
+// grid boundaries
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_DEFAULT 64
+#else
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_DEFAULT TERRAIN_GRID_BLOCK_CACHE_SIZE
+#endif
+
+// number of buckets in the hash index over the cache. Must be a power
+// of 2
+#define TERRAIN_GRID_CACHE_HASH_SIZE 256
+
+// marker for the end of a hash chain
+#define TERRAIN_GRID_CACHE_NONE 0xFFFF
+
+// number of locations height_amsl_grouped() groups by grid_block at a time
+#define TERRAIN_GROUP_CHUNK_SIZE 16
+
+// how far ahead along the velocity vector and the current mission leg
+// to prefetch grid_blocks, in seconds of travel and in grid_blocks
+#define TERRAIN_PREFETCH_TIME_S 60
+#define TERRAIN_PREFETCH_MAX_BLOCKS 6
+
+// prefetch never replaces a grid_block accessed more recently than this
+#define TERRAIN_PREFETCH_KEEP_MS 1000
+
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
@@ -109,6 +149,11 @@ public:
     // return false if not available
     bool height_amsl(const Location &loc, float &height);
 
+    // return terrain heights in meters above sea level for an array
+    // of locations, grouped by grid_block. valid[i] is set for each
+    // location with data. Returns the number of locations with data
+    uint16_t height_amsl_grouped(const Location *locs, float *heights, bool *valid, uint16_t count);
+
     /* 
        find difference between home terrain height and the terrain
        height at the current location in meters. A positive result
@@ -229,6 +274,9 @@ private:
 
         // the last time access was requested to this block, used for LRU
         uint32_t last_access_ms;
+
+        // next cache index in the same hash bucket
+        uint16_t hash_next;
     };
 
     /*
@@ -262,11 +310,26 @@ private:
 
     // given a location, fill a grid_info structure
     void calculate_grid_info(const Location &loc, struct grid_info &info) const;
+    void calculate_grid_index(const Location &loc, struct grid_info &info) const;
+    void calculate_grid_corner(struct grid_info &info) const;
+
+    // interpolate a height within a grid_block
+    bool interpolate_height(const struct grid_block &grid, const struct grid_info &info, float &height);
 
     /*
       find a grid structure given a grid_info
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
+    int16_t find_oldest_cache_idx(bool for_prefetch) const;
+    struct grid_cache &reuse_grid_cache(uint16_t idx, const struct grid_info &info);
+
+    /*
+      hash index over the grid cache
+    */
+    uint16_t cache_hash_bucket(int32_t lat, int32_t lon) const;
+    int16_t find_cache_idx(int32_t lat, int32_t lon, uint16_t spacing) const;
+    void cache_hash_insert(uint16_t idx);
+    void cache_hash_remove(uint16_t idx);
 
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
@@ -306,9 +369,16 @@ private:
     void check_disk_write(void);
     void io_timer(void);
     void open_file(void);
+    uint16_t east_blocks(const struct grid_block &block) const;
+    uint32_t block_file_offset(const struct grid_block &block) const;
     void seek_offset(void);
     void write_block(void);
     void read_block(void);
+#if TERRAIN_USE_MMAP
+    uint32_t degree_file_size(const struct grid_block &block) const;
+    bool map_file(void);
+    void unmap_file(void);
+#endif
 
     /*
       check for missing mission terrain data
@@ -320,10 +390,17 @@ private:
      */
     void update_rally_data(void);
 
+    /*
+      prefetch grid_blocks ahead of the vehicle
+     */
+    void update_prefetch(void);
+    void prefetch_along(const Location &loc, float bearing, float distance, uint8_t &count);
+
 
     // parameters
     AP_Int8  enable;
     AP_Int16 grid_spacing; // meters between grid points
+    AP_Int16 cache_size_blocks; // grid_blocks to keep in memory
 
     // reference to AHRS, so we can ask for our position,
     // heading and speed
@@ -338,9 +415,13 @@ private:
     const AP_Rally &rally;
 
     // cache of grids in memory, LRU
-    uint8_t cache_size = 0;
+    uint16_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+    // heads of the hash chains over the cache, indexed by
+    // cache_hash_bucket()
+    uint16_t *cache_hash = nullptr;
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -360,6 +441,17 @@ private:
     // open file handle on degree file
     int fd;
 
+#if TERRAIN_USE_MMAP
+    // mapping of the open degree file, nullptr if the file is
+    // accessed with read()/write()
+    uint8_t *file_map = nullptr;
+    uint32_t file_map_size = 0;
+
+    // bitmap of blocks in the mapped file that have passed a CRC
+    // check. CRCs are only checked the first time a block is read
+    uint8_t *file_crc_checked = nullptr;
+#endif
+
     // has the timer been setup?
     bool timer_setup;
 
@@ -386,8 +478,9 @@ private:
     // next mission command to check
     uint16_t next_mission_index;
 
-    // next mission position to check
-    uint8_t next_mission_pos;
+    // bitmask of the points around the next mission command that
+    // have terrain data
+    uint8_t next_mission_done;
 
     // last time the mission changed
     uint32_t last_mission_change_ms;
@@ -257,20 +257,21 @@ void AP_Terrain::handle_terrain_check(mavlink_channel_t chan, mavlink_message_t
  */
 void AP_Terrain::handle_terrain_data(mavlink_message_t *msg)
 {
+    if (cache_hash == nullptr) {
+        // terrain disabled or cache allocation failed
+        return;
+    }
+
     mavlink_terrain_data_t packet;
     mavlink_msg_terrain_data_decode(msg, &packet);
 
-    uint16_t i;
-    for (i=0; i<cache_size; i++) {
-        if (cache[i].grid.lat == packet.lat && 
-            cache[i].grid.lon == packet.lon && 
-            cache[i].grid.spacing == packet.grid_spacing &&
-            grid_spacing == packet.grid_spacing &&
-            packet.gridbit < 56) {
-            break;
-        }
+    if (grid_spacing != packet.grid_spacing ||
+        packet.gridbit >= 56) {
+        // not a grid we could have asked for
+        return;
     }
-    if (i == cache_size) {
+    int16_t i = find_cache_idx(packet.lat, packet.lon, packet.grid_spacing);
+    if (i == -1) {
         // we don't have that grid, ignore data
         return;
     }
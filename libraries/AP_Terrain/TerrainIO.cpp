@@ -33,6 +33,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#if TERRAIN_USE_MMAP
+#include <sys/mman.h>
+#endif
 
 extern const AP_HAL::HAL& hal;
 
@@ -80,12 +83,6 @@ void AP_Terrain::schedule_disk_io(void)
 
     switch (disk_io_state) {
     case DiskIoIdle:
-        // look for a block that needs reading or writing
-        check_disk_read();
-        if (disk_io_state == DiskIoIdle) {
-            // still idle, check for writes
-            check_disk_write();            
-        }
         break;
         
     case DiskIoDoneRead: {
@@ -121,6 +118,17 @@ void AP_Terrain::schedule_disk_io(void)
         // waiting for io_timer()
         break;
     }
+
+    if (disk_io_state == DiskIoIdle) {
+        // look for a block that needs reading or writing. This is
+        // done straight after a completed IO so that a run of
+        // prefetched blocks doesn't take one update per block
+        check_disk_read();
+        if (disk_io_state == DiskIoIdle) {
+            // still idle, check for writes
+            check_disk_write();            
+        }
+    }
 }
 
 
@@ -184,6 +192,9 @@ void AP_Terrain::open_file(void)
         *p = '/';
     }
 
+#if TERRAIN_USE_MMAP
+    unmap_file();
+#endif
     if (fd != -1) {
         ::close(fd);
     }
@@ -199,15 +210,21 @@ void AP_Terrain::open_file(void)
 
     file_lat_degrees = block.lat_degrees;
     file_lon_degrees = block.lon_degrees;
+
+#if TERRAIN_USE_MMAP
+    if (!map_file()) {
+        // fall back to read()/write() on the file descriptor
+        unmap_file();
+    }
+#endif
 }
 
 /*
-  seek to the right offset for disk_block
+  work out how many longitude blocks there are at the latitude of a
+  block
  */
-void AP_Terrain::seek_offset(void)
+uint16_t AP_Terrain::east_blocks(const struct grid_block &block) const
 {
-    struct grid_block &block = disk_block.block;
-    // work out how many longitude blocks there are at this latitude
     Location loc1, loc2;
     loc1.lat = block.lat_degrees*10*1000*1000L;
     loc1.lng = block.lon_degrees*10*1000*1000L;
@@ -217,10 +234,24 @@ void AP_Terrain::seek_offset(void)
     // shift another two blocks east to ensure room is available
     location_offset(loc2, 0, 2*grid_spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
     Vector2f offset = location_diff(loc1, loc2);
-    uint16_t east_blocks = offset.y / (grid_spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
+    return offset.y / (grid_spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
+}
+
+/*
+  offset of a block within its degree file
+ */
+uint32_t AP_Terrain::block_file_offset(const struct grid_block &block) const
+{
+    return (east_blocks(block) * block.grid_idx_x + 
+            block.grid_idx_y) * sizeof(union grid_io_block);
+}
 
-    uint32_t file_offset = (east_blocks * block.grid_idx_x + 
-                            block.grid_idx_y) * sizeof(union grid_io_block);
+/*
+  seek to the right offset for disk_block
+ */
+void AP_Terrain::seek_offset(void)
+{
+    uint32_t file_offset = block_file_offset(disk_block.block);
     if (::lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
 #if TERRAIN_DEBUG
         hal.console->printf("Seek %lu failed - %s\n",
@@ -237,6 +268,8 @@ void AP_Terrain::seek_offset(void)
  */
 void AP_Terrain::write_block(void)
 {
+    // writes always go through write(), never through the file
+    // mapping, so a full card gives a clean error instead of SIGBUS
     seek_offset();
     if (io_failure) {
         return;
@@ -248,12 +281,27 @@ void AP_Terrain::write_block(void)
     if (ret  != sizeof(disk_block)) {
 #if TERRAIN_DEBUG
         hal.console->printf("write failed - %s\n", strerror(errno));
+#endif
+#if TERRAIN_USE_MMAP
+        unmap_file();
 #endif
         ::close(fd);
         fd = -1;
         io_failure = true;
+        // leave the block dirty, it was not written
+        return;
     } else {
         ::fsync(fd);
+#if TERRAIN_USE_MMAP
+        if (file_map != nullptr) {
+            // the mapping shares the page cache with write(), so the
+            // block we just wrote is already known good
+            uint32_t idx = block_file_offset(disk_block.block) / sizeof(disk_block);
+            if (idx < file_map_size / sizeof(disk_block)) {
+                file_crc_checked[idx/8] |= 1U<<(idx%8);
+            }
+        }
+#endif
 #if TERRAIN_DEBUG
         printf("wrote block at %ld %ld ret=%d mask=%07llx\n",
                (long)disk_block.block.lat,
@@ -270,21 +318,39 @@ void AP_Terrain::write_block(void)
  */
 void AP_Terrain::read_block(void)
 {
-    seek_offset();
-    if (io_failure) {
-        return;
-    }
     int32_t lat = disk_block.block.lat;
     int32_t lon = disk_block.block.lon;
+    bool check_crc = true;
+    ssize_t ret;
+
+#if TERRAIN_USE_MMAP
+    uint32_t file_offset = block_file_offset(disk_block.block);
+    uint32_t idx = file_offset / sizeof(disk_block);
+    if (file_map != nullptr) {
+        if (file_offset + sizeof(disk_block) <= file_map_size) {
+            memcpy(&disk_block, &file_map[file_offset], sizeof(disk_block));
+            ret = sizeof(disk_block);
+            check_crc = (file_crc_checked[idx/8] & (1U<<(idx%8))) == 0;
+        } else {
+            ret = 0;
+        }
+    } else
+#endif
+    {
+        seek_offset();
+        if (io_failure) {
+            return;
+        }
+        ret = ::read(fd, &disk_block, sizeof(disk_block));
+    }
 
-    ssize_t ret = ::read(fd, &disk_block, sizeof(disk_block));
     if (ret != sizeof(disk_block) || 
         disk_block.block.lat != lat || 
         disk_block.block.lon != lon ||
         disk_block.block.bitmap == 0 ||
         disk_block.block.spacing != grid_spacing ||
         disk_block.block.version != TERRAIN_GRID_FORMAT_VERSION ||
-        disk_block.block.crc != get_block_crc(disk_block.block)) {
+        (check_crc && disk_block.block.crc != get_block_crc(disk_block.block))) {
 #if TERRAIN_DEBUG
         printf("read empty block at %ld %ld ret=%d\n",
                (long)lat,
@@ -298,6 +364,11 @@ void AP_Terrain::read_block(void)
         disk_block.block.lon = lon;
         disk_block.block.bitmap = 0;
     } else {
+#if TERRAIN_USE_MMAP
+        if (file_map != nullptr) {
+            file_crc_checked[idx/8] |= 1U<<(idx%8);
+        }
+#endif
 #if TERRAIN_DEBUG
         printf("read block at %ld %ld ret=%d mask=%07llx\n",
                (long)lat,
@@ -309,6 +380,81 @@ void AP_Terrain::read_block(void)
     disk_io_state = DiskIoDoneRead;
 }
 
+#if TERRAIN_USE_MMAP
+/*
+  size of a degree file, allowing for the last row of blocks
+  overrunning east_blocks()
+ */
+uint32_t AP_Terrain::degree_file_size(const struct grid_block &block) const
+{
+    Location loc1, loc2;
+    loc1.lat = block.lat_degrees*10*1000*1000L;
+    loc1.lng = block.lon_degrees*10*1000*1000L;
+    loc2.lat = (block.lat_degrees+1)*10*1000*1000L;
+    loc2.lng = block.lon_degrees*10*1000*1000L;
+    Vector2f offset = location_diff(loc1, loc2);
+    uint32_t north_blocks = offset.x / (grid_spacing*TERRAIN_GRID_BLOCK_SPACING_X) + 1;
+
+    return (north_blocks + 2) * east_blocks(block) * sizeof(union grid_io_block);
+}
+
+/*
+  map the open degree file into memory for reading. The file is
+  extended (as a sparse file) to cover every block in the degree, so
+  all blocks can be read in place. The mapping is read only: writes
+  use write() so that running out of space is reported as an error
+ */
+bool AP_Terrain::map_file(void)
+{
+    uint32_t size = degree_file_size(disk_block.block);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return false;
+    }
+    if ((uint32_t)st.st_size > size) {
+        size = st.st_size;
+    } else if ((uint32_t)st.st_size < size && ftruncate(fd, size) != 0) {
+        return false;
+    }
+
+    void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+#if TERRAIN_DEBUG
+        hal.console->printf("mmap %s failed - %s\n",
+                            file_path, strerror(errno));
+#endif
+        return false;
+    }
+    file_map = (uint8_t *)p;
+    file_map_size = size;
+
+    // ask the kernel to start reading in the populated parts of the
+    // file, so later block reads are memory copies
+    madvise(file_map, file_map_size, MADV_WILLNEED);
+
+    file_crc_checked = (uint8_t *)calloc((size / sizeof(union grid_io_block) + 7) / 8, 1);
+    if (file_crc_checked == nullptr) {
+        return false;
+    }
+    return true;
+}
+
+/*
+  remove any mapping of the degree file
+ */
+void AP_Terrain::unmap_file(void)
+{
+    if (file_map != nullptr) {
+        munmap(file_map, file_map_size);
+        file_map = nullptr;
+        file_map_size = 0;
+    }
+    free(file_crc_checked);
+    file_crc_checked = nullptr;
+}
+#endif // TERRAIN_USE_MMAP
+
 /*
   timer called to do disk IO
  */
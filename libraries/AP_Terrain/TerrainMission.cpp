@@ -37,7 +37,7 @@ void AP_Terrain::update_mission_data(void)
         last_mission_spacing != grid_spacing) {
         // the mission has changed - start again
         next_mission_index = 1;
-        next_mission_pos = 0;
+        next_mission_done = 0;
         last_mission_change_ms = mission.last_change_time_ms();
         last_mission_spacing = grid_spacing;
     }
@@ -73,7 +73,6 @@ void AP_Terrain::update_mission_data(void)
             if (!mission.read_cmd_from_storage(next_mission_index, cmd)) {
                 // nothing more to do
                 next_mission_index = 0;
-                next_mission_pos = 0;
                 return;
             }
         }
@@ -81,28 +80,37 @@ void AP_Terrain::update_mission_data(void)
         // we will fetch 5 points around the waypoint. Four at 10 grid
         // spacings away at 45, 135, 225 and 315 degrees, and the
         // point itself
-        if (next_mission_pos != 4) {
-            location_update(cmd.content.location, 45+90*next_mission_pos, grid_spacing.get() * 10);
+        Location locs[5];
+        for (uint8_t pos=0; pos<4; pos++) {
+            locs[pos] = cmd.content.location;
+            location_update(locs[pos], 45+90*pos, grid_spacing.get() * 10);
         }
-
-        // we have a mission command to check
-        float height;
-        if (!height_amsl(cmd.content.location, height)) {
+        locs[4] = cmd.content.location;
+
+        // we have a mission command to check. Points that already
+        // have data are remembered, so a waypoint whose blocks arrive
+        // over several calls still completes
+        float heights[5];
+        bool valid[5];
+        height_amsl_grouped(locs, heights, valid, 5);
+        for (uint8_t pos=0; pos<5; pos++) {
+            if (valid[pos]) {
+                next_mission_done |= 1U<<pos;
+            }
+        }
+        if (next_mission_done != 0x1F) {
             // if we can't get data for a mission item then return and
             // check again next time
             return;
         }
 
-        next_mission_pos++;
-        if (next_mission_pos == 5) {
 #if TERRAIN_DEBUG
-            hal.console->printf("checked waypoint %u\n", (unsigned)next_mission_index);
+        hal.console->printf("checked waypoint %u\n", (unsigned)next_mission_index);
 #endif
 
-            // move to next waypoint
-            next_mission_index++;
-            next_mission_pos = 0;
-        }
+        // move to next waypoint
+        next_mission_index++;
+        next_mission_done = 0;
     }
 }
 
@@ -158,4 +166,88 @@ void AP_Terrain::update_rally_data(void)
     }
 }
 
+/*
+  prefetch grid_blocks along a line from a location. The blocks are
+  read from disk by the IO timer, and any missing data is requested
+  from the GCS by send_request(), before the vehicle gets there. The
+  count of newly loaded blocks is limited, and only grids that are
+  idle and have nothing pending on disk are replaced, so prefetching
+  can't push the blocks in use or unsaved data out of the cache
+ */
+void AP_Terrain::prefetch_along(const Location &loc, float bearing, float distance, uint8_t &count)
+{
+    // step by half a grid_block so no block along the line is missed
+    float step = 0.5f * TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+    uint8_t max_count = MIN(TERRAIN_PREFETCH_MAX_BLOCKS, cache_size/3);
+    int32_t last_lat = 0;
+    int32_t last_lon = 0;
+
+    for (float d=step; d < distance+step && count < max_count; d += step) {
+        Location loc2 = loc;
+        location_update(loc2, bearing, MIN(d, distance));
+
+        struct grid_info info;
+        calculate_grid_info(loc2, info);
+        if (info.grid_lat == last_lat && info.grid_lon == last_lon) {
+            // same block as the last step
+            continue;
+        }
+        last_lat = info.grid_lat;
+        last_lon = info.grid_lon;
+
+        int16_t idx = find_cache_idx(info.grid_lat, info.grid_lon, grid_spacing);
+        if (idx != -1) {
+            cache[idx].last_access_ms = AP_HAL::millis();
+            continue;
+        }
+        idx = find_oldest_cache_idx(true);
+        if (idx == -1) {
+            // no idle grid to replace
+            return;
+        }
+        reuse_grid_cache(idx, info);
+        count++;
+    }
+}
+
+/*
+  prefetch the grid_blocks the vehicle will need next, along the
+  current velocity vector and along the current mission leg
+ */
+void AP_Terrain::update_prefetch(void)
+{
+    if (enable == 0 || !allocate() || grid_spacing <= 0) {
+        return;
+    }
+
+    Location loc;
+    if (!ahrs.get_position(loc)) {
+        // we don't know where we are
+        return;
+    }
+
+    // look ahead by a fixed time, but always at least one block
+    // ahead so the next mission leg is loaded while hovering
+    float min_distance = TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+    Vector2f groundspeed = ahrs.groundspeed_vector();
+    float speed = groundspeed.length();
+    float horizon = MAX(speed * TERRAIN_PREFETCH_TIME_S, min_distance);
+
+    uint8_t count = 0;
+
+    if (speed > 1.0f) {
+        float bearing = degrees(atan2f(groundspeed.y, groundspeed.x));
+        prefetch_along(loc, bearing, horizon, count);
+    }
+
+    if (mission.state() == AP_Mission::MISSION_RUNNING) {
+        const AP_Mission::Mission_Command &cmd = mission.get_current_nav_cmd();
+        if (cmd.content.location.lat != 0 || cmd.content.location.lng != 0) {
+            float bearing = get_bearing_cd(loc, cmd.content.location) * 0.01f;
+            float distance = MIN(get_distance(loc, cmd.content.location), horizon);
+            prefetch_along(loc, bearing, distance, count);
+        }
+    }
+}
+
 #endif // AP_TERRAIN_AVAILABLE
@@ -66,6 +66,16 @@ bool AP_Terrain::check_bitmap(const struct grid_block &grid, uint8_t idx_x, uint
   grid indices
 */
 void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info) const
+{
+    calculate_grid_index(loc, info);
+    calculate_grid_corner(info);
+}
+
+/*
+  given a location, calculate the grid indices and fractions. This
+  leaves grid_lat and grid_lon unset
+*/
+void AP_Terrain::calculate_grid_index(const Location &loc, struct grid_info &info) const
 {
     // grids start on integer degrees. This makes storing terrain data
     // on the SD card a bit easier
@@ -98,43 +108,173 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
     info.frac_x = (offset.x - idx_x * grid_spacing) / grid_spacing;
     info.frac_y = (offset.y - idx_y * grid_spacing) / grid_spacing;
 
-    // calculate lat/lon of SW corner of 32*28 grid_block
+    ASSERT_RANGE(info.idx_x,0,TERRAIN_GRID_BLOCK_SPACING_X-1);
+    ASSERT_RANGE(info.idx_y,0,TERRAIN_GRID_BLOCK_SPACING_Y-1);
+    ASSERT_RANGE(info.frac_x,0,1);
+    ASSERT_RANGE(info.frac_y,0,1);
+}
+
+/*
+  calculate lat/lon of SW corner of the 32*28 grid_block from the
+  indices set by calculate_grid_index()
+*/
+void AP_Terrain::calculate_grid_corner(struct grid_info &info) const
+{
+    Location ref;
+    ref.lat = info.lat_degrees*10*1000*1000L;
+    ref.lng = info.lon_degrees*10*1000*1000L;
+
     location_offset(ref, 
                     info.grid_idx_x * TERRAIN_GRID_BLOCK_SPACING_X * (float)grid_spacing,
                     info.grid_idx_y * TERRAIN_GRID_BLOCK_SPACING_Y * (float)grid_spacing);
     info.grid_lat = ref.lat;
     info.grid_lon = ref.lng;
+}
 
-    ASSERT_RANGE(info.idx_x,0,TERRAIN_GRID_BLOCK_SPACING_X-1);
-    ASSERT_RANGE(info.idx_y,0,TERRAIN_GRID_BLOCK_SPACING_Y-1);
-    ASSERT_RANGE(info.frac_x,0,1);
-    ASSERT_RANGE(info.frac_y,0,1);
+/*
+  interpolate the height at a grid_info within a grid_block. Return
+  false if the 4 surrounding heights are not all available
+*/
+bool AP_Terrain::interpolate_height(const struct grid_block &grid, const struct grid_info &info, float &height)
+{
+    /*
+      note that we rely on the one square overlap to ensure these
+      calculations don't go past the end of the arrays
+     */
+    ASSERT_RANGE(info.idx_x, 0, TERRAIN_GRID_BLOCK_SIZE_X-2);
+    ASSERT_RANGE(info.idx_y, 0, TERRAIN_GRID_BLOCK_SIZE_Y-2);
+
+
+    // check we have all 4 required heights
+    if (!check_bitmap(grid, info.idx_x,   info.idx_y) ||
+        !check_bitmap(grid, info.idx_x,   info.idx_y+1) ||
+        !check_bitmap(grid, info.idx_x+1, info.idx_y) ||
+        !check_bitmap(grid, info.idx_x+1, info.idx_y+1)) {
+        return false;
+    }
+
+    // hXY are the heights of the 4 surrounding grid points
+    int16_t h00, h01, h10, h11;
+
+    h00 = grid.height[info.idx_x+0][info.idx_y+0];
+    h01 = grid.height[info.idx_x+0][info.idx_y+1];
+    h10 = grid.height[info.idx_x+1][info.idx_y+0];
+    h11 = grid.height[info.idx_x+1][info.idx_y+1];
+
+    // do a simple dual linear interpolation. We could do something
+    // fancier, but it probably isn't worth it as long as the
+    // grid_spacing is kept small enough
+    float avg1 = (1.0f-info.frac_x) * h00  + info.frac_x * h10;
+    float avg2 = (1.0f-info.frac_x) * h01  + info.frac_x * h11;
+    float avg  = (1.0f-info.frac_y) * avg1 + info.frac_y * avg2;
+
+    height = avg;
+    return true;
 }
 
 
+/*
+  calculate the hash bucket for a grid_block SW corner
+ */
+uint16_t AP_Terrain::cache_hash_bucket(int32_t lat, int32_t lon) const
+{
+    uint32_t h = ((uint32_t)lat * 2654435761U) ^ ((uint32_t)lon * 2246822519U);
+    return (h >> 16) & (TERRAIN_GRID_CACHE_HASH_SIZE-1);
+}
+
+/*
+  find the cache index of a grid_block, or -1 if not in the cache
+ */
+int16_t AP_Terrain::find_cache_idx(int32_t lat, int32_t lon, uint16_t spacing) const
+{
+    uint16_t i = cache_hash[cache_hash_bucket(lat, lon)];
+    while (i != TERRAIN_GRID_CACHE_NONE) {
+        if (cache[i].grid.lat == lat &&
+            cache[i].grid.lon == lon &&
+            cache[i].grid.spacing == spacing) {
+            return i;
+        }
+        i = cache[i].hash_next;
+    }
+    return -1;
+}
+
+/*
+  add a cache entry to the hash index
+ */
+void AP_Terrain::cache_hash_insert(uint16_t idx)
+{
+    uint16_t &head = cache_hash[cache_hash_bucket(cache[idx].grid.lat, cache[idx].grid.lon)];
+    cache[idx].hash_next = head;
+    head = idx;
+}
+
+/*
+  remove a cache entry from the hash index. Entries that were never
+  inserted are ignored
+ */
+void AP_Terrain::cache_hash_remove(uint16_t idx)
+{
+    uint16_t *p = &cache_hash[cache_hash_bucket(cache[idx].grid.lat, cache[idx].grid.lon)];
+    while (*p != TERRAIN_GRID_CACHE_NONE) {
+        if (*p == idx) {
+            *p = cache[idx].hash_next;
+            break;
+        }
+        p = &cache[*p].hash_next;
+    }
+    cache[idx].hash_next = TERRAIN_GRID_CACHE_NONE;
+}
+
 /*
   find a grid structure given a grid_info
  */
 AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
 {
-    uint16_t oldest_i = 0;
-
     // see if we have that grid
+    int16_t idx = find_cache_idx(info.grid_lat, info.grid_lon, grid_spacing);
+    if (idx != -1) {
+        cache[idx].last_access_ms = AP_HAL::millis();
+        return cache[idx];
+    }
+
+    // Not found. Use the oldest grid and make it this grid,
+    // initially unpopulated
+    return reuse_grid_cache(find_oldest_cache_idx(false), info);
+}
+
+/*
+  find the least recently used grid in the cache. For prefetch, grids
+  waiting on a disk read, holding data from the GCS not yet written to
+  disk or in recent use are never chosen, and -1 is returned if there
+  is no other grid
+ */
+int16_t AP_Terrain::find_oldest_cache_idx(bool for_prefetch) const
+{
+    uint32_t now = AP_HAL::millis();
+    int16_t oldest_i = -1;
     for (uint16_t i=0; i<cache_size; i++) {
-        if (cache[i].grid.lat == info.grid_lat && 
-            cache[i].grid.lon == info.grid_lon &&
-            cache[i].grid.spacing == grid_spacing) {
-            cache[i].last_access_ms = AP_HAL::millis();
-            return cache[i];
+        if (for_prefetch &&
+            (cache[i].state == GRID_CACHE_DISKWAIT ||
+             cache[i].state == GRID_CACHE_DIRTY ||
+             now - cache[i].last_access_ms < TERRAIN_PREFETCH_KEEP_MS)) {
+            continue;
         }
-        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
+        if (oldest_i == -1 || cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
             oldest_i = i;
         }
     }
+    return oldest_i;
+}
 
-    // Not found. Use the oldest grid and make it this grid,
-    // initially unpopulated
-    struct grid_cache &grid = cache[oldest_i];
+/*
+  make a cache entry hold the given grid, initially unpopulated
+ */
+AP_Terrain::grid_cache &AP_Terrain::reuse_grid_cache(uint16_t idx, const struct grid_info &info)
+{
+    cache_hash_remove(idx);
+
+    struct grid_cache &grid = cache[idx];
     memset(&grid, 0, sizeof(grid));
 
     grid.grid.lat = info.grid_lat;
@@ -147,6 +287,8 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     grid.grid.version = TERRAIN_GRID_FORMAT_VERSION;
     grid.last_access_ms = AP_HAL::millis();
 
+    cache_hash_insert(idx);
+
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
@@ -158,22 +300,22 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
  */
 int16_t AP_Terrain::find_io_idx(enum GridCacheState state)
 {
-    // try first with given state
-    for (uint16_t i=0; i<cache_size; i++) {
-        if (disk_block.block.lat == cache[i].grid.lat &&
-            disk_block.block.lon == cache[i].grid.lon && 
-            cache[i].state == state) {
-            return i;
-        }
-    }    
-    // then any state
-    for (uint16_t i=0; i<cache_size; i++) {
+    int16_t any_idx = -1;
+    uint16_t i = cache_hash[cache_hash_bucket(disk_block.block.lat, disk_block.block.lon)];
+    while (i != TERRAIN_GRID_CACHE_NONE) {
         if (disk_block.block.lat == cache[i].grid.lat &&
             disk_block.block.lon == cache[i].grid.lon) {
-            return i;
+            // prefer a match with the given state
+            if (cache[i].state == state) {
+                return i;
+            }
+            if (any_idx == -1) {
+                any_idx = i;
+            }
         }
-    }    
-    return -1;
+        i = cache[i].hash_next;
+    }
+    return any_idx;
 }
 
 /*
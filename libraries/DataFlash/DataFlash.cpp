@@ -2,6 +2,12 @@
 
 #include "DataFlash_Backend.h"
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define DATAFLASH_MAV_BUFSIZE_DEFAULT 64
+#else
+#define DATAFLASH_MAV_BUFSIZE_DEFAULT 8
+#endif
+
 const AP_Param::GroupInfo DataFlash_Class::var_info[] = {
     // @Param: _BACKEND_TYPE
     // @DisplayName: DataFlash Backend Storage type
@@ -16,6 +22,74 @@ const AP_Param::GroupInfo DataFlash_Class::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("_FILE_BUFSIZE",  1, DataFlash_Class, _params.file_bufsize,       16),
 
+    // @Param: _RL1_TYPE
+    // @DisplayName: First rate limited message type
+    // @Description: Message type number, as in the log's FMT records, whose logging rate is capped at LOG_RL1_HZ. -1 for none. Critical messages are never limited
+    // @Range: -1 255
+    // @User: Advanced
+    AP_GROUPINFO("_RL1_TYPE",  2, DataFlash_Class, _params.rate_limit_type[0], -1),
+
+    // @Param: _RL1_HZ
+    // @DisplayName: First rate limit
+    // @Description: Maximum rate that messages of type LOG_RL1_TYPE are logged at. 0 for no limit
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RL1_HZ",  3, DataFlash_Class, _params.rate_limit_hz[0], 0),
+
+    // @Param: _RL2_TYPE
+    // @DisplayName: Second rate limited message type
+    // @Description: Message type number, as in the log's FMT records, whose logging rate is capped at LOG_RL2_HZ. -1 for none. Critical messages are never limited
+    // @Range: -1 255
+    // @User: Advanced
+    AP_GROUPINFO("_RL2_TYPE",  4, DataFlash_Class, _params.rate_limit_type[1], -1),
+
+    // @Param: _RL2_HZ
+    // @DisplayName: Second rate limit
+    // @Description: Maximum rate that messages of type LOG_RL2_TYPE are logged at. 0 for no limit
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RL2_HZ",  5, DataFlash_Class, _params.rate_limit_hz[1], 0),
+
+    // @Param: _RL3_TYPE
+    // @DisplayName: Third rate limited message type
+    // @Description: Message type number, as in the log's FMT records, whose logging rate is capped at LOG_RL3_HZ. -1 for none. Critical messages are never limited
+    // @Range: -1 255
+    // @User: Advanced
+    AP_GROUPINFO("_RL3_TYPE",  6, DataFlash_Class, _params.rate_limit_type[2], -1),
+
+    // @Param: _RL3_HZ
+    // @DisplayName: Third rate limit
+    // @Description: Maximum rate that messages of type LOG_RL3_TYPE are logged at. 0 for no limit
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RL3_HZ",  7, DataFlash_Class, _params.rate_limit_hz[2], 0),
+
+    // @Param: _RL4_TYPE
+    // @DisplayName: Fourth rate limited message type
+    // @Description: Message type number, as in the log's FMT records, whose logging rate is capped at LOG_RL4_HZ. -1 for none. Critical messages are never limited
+    // @Range: -1 255
+    // @User: Advanced
+    AP_GROUPINFO("_RL4_TYPE",  8, DataFlash_Class, _params.rate_limit_type[3], -1),
+
+    // @Param: _RL4_HZ
+    // @DisplayName: Fourth rate limit
+    // @Description: Maximum rate that messages of type LOG_RL4_TYPE are logged at. 0 for no limit
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RL4_HZ",  9, DataFlash_Class, _params.rate_limit_hz[3], 0),
+
+    // @Param: _MAV_BUFSIZE
+    // @DisplayName: Maximum DataFlash MAVLink Backend buffer size
+    // @Description: Size of the pool of blocks waiting to be sent to or acknowledged by the MAVLink logging client, in kilobytes. This bounds the number of blocks in flight, so fast links with long round trip times need a larger pool to reach full throughput
+    // @Units: kB
+    // @Range: 2 127
+    // @User: Advanced
+    AP_GROUPINFO("_MAV_BUFSIZE",  10, DataFlash_Class, _params.mav_bufsize, DATAFLASH_MAV_BUFSIZE_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -24,6 +98,17 @@ const struct LogStructure *DataFlash_Class::structure(uint16_t num) const
     return &_structures[num];
 }
 
+uint32_t DataFlash_Class::rate_limit_interval_us(uint8_t msg_type, uint8_t &slot) const
+{
+    for (uint8_t i=0; i<DATAFLASH_RATE_LIMITS; i++) {
+        if (_params.rate_limit_type[i] == msg_type && _params.rate_limit_hz[i] > 0) {
+            slot = i;
+            return constrain_float(1.0e6f / _params.rate_limit_hz[i], 1, 60000000);
+        }
+    }
+    return 0;
+}
+
 
 #define FOR_EACH_BACKEND(methodcall)              \
     do {                                          \
@@ -54,6 +139,23 @@ void DataFlash_Class::WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical));
 }
 
+bool DataFlash_Class::reserve_block(uint8_t msg_type, uint16_t size, bool is_critical, uint8_t *&block) {
+    block = nullptr;
+    if (_next_backend != 1) {
+        // each backend needs its own copy
+        return _next_backend != 0;
+    }
+    return backends[0]->reserve_block(msg_type, size, is_critical, block);
+}
+
+void DataFlash_Class::commit_block(uint16_t size) {
+    backends[0]->commit_block(size);
+}
+
+void DataFlash_Class::abort_block() {
+    backends[0]->abort_block();
+}
+
 // change me to "DoTimeConsumingPreparations"?
 void DataFlash_Class::EraseAll() {
     FOR_EACH_BACKEND(EraseAll());
@@ -144,6 +246,17 @@ void DataFlash_Class::ListAvailableLogs(AP_HAL::BetterStream *port) {
     backends[0]->ListAvailableLogs(port);
 }
 
+uint16_t DataFlash_Class::bufferspace_available(void) {
+    if (_next_backend == 0) {
+        return 0;
+    }
+    uint16_t ret = UINT16_MAX;
+    for (uint8_t i=0; i< _next_backend; i++) {
+        ret = MIN(ret, backends[i]->bufferspace_available());
+    }
+    return ret;
+}
+
 /* we're started if any of the backends are started */
 bool DataFlash_Class::logging_started(void) {
     for (uint8_t i=0; i< _next_backend; i++) {
@@ -41,6 +41,7 @@ enum DataFlash_Backend_Type {
 class DataFlash_Class
 {
     friend class DataFlash_Backend; // for _num_types
+    template <typename T> friend class DataFlash_Message; // for reserve_block
 
 public:
     FUNCTOR_TYPEDEF(print_mode_fn, void, AP_HAL::BetterStream*, uint8_t);
@@ -139,6 +140,9 @@ public:
 
     bool logging_started(void);
 
+    // free space in bytes in the write buffer of the fullest backend
+    uint16_t bufferspace_available(void);
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     // currently only DataFlash_File support this:
     void flush(void);
@@ -155,11 +159,20 @@ public:
 
     // parameter support
     static const struct AP_Param::GroupInfo        var_info[];
+    #define DATAFLASH_RATE_LIMITS 4
     struct {
         AP_Int8 backend_types;
         AP_Int8 file_bufsize; // in kilobytes
+        AP_Int8 mav_bufsize; // in kilobytes
+        AP_Int16 rate_limit_type[DATAFLASH_RATE_LIMITS];
+        AP_Float rate_limit_hz[DATAFLASH_RATE_LIMITS];
     } _params;
 
+    // minimum interval between messages of a type from the LOG_RLn
+    // parameters, or 0 if the type isn't limited. slot is set to the
+    // limit that applies
+    uint32_t rate_limit_interval_us(uint8_t msg_type, uint8_t &slot) const;
+
     const struct LogStructure *structure(uint16_t num) const;
 
 protected:
@@ -174,10 +187,67 @@ protected:
                                bool is_critical);
 
 private:
+    /*
+      space for a message in the write buffer of the only backend, for
+      DataFlash_Message. Returns false if the message should be
+      dropped. block is nullptr if the message has to be copied in
+      with WritePrioritisedBlock(), otherwise it must be followed by
+      commit_block() or abort_block()
+     */
+    bool reserve_block(uint8_t msg_type, uint16_t size, bool is_critical, uint8_t *&block);
+    void commit_block(uint16_t size);
+    void abort_block();
+
     #define DATAFLASH_MAX_BACKENDS 2
     uint8_t _next_backend;
     DataFlash_Backend *backends[DATAFLASH_MAX_BACKENDS];
     const char *_firmware_string;
+
+#if GYRO_FFT_ENABLED
+    // last gyro FFT frame written to the GFFT message
+    uint32_t _last_gfft_frame;
+#endif
 };
 
+template <typename T>
+DataFlash_Message<T>::DataFlash_Message(DataFlash_Class &dataflash, uint8_t msg_type, bool is_critical) :
+    _dataflash(dataflash),
+    _pkt(&_local),
+    _is_critical(is_critical),
+    _reserved(false),
+    _dropped(false)
+{
+    uint8_t *block;
+    if (!_dataflash.reserve_block(msg_type, sizeof(T), is_critical, block)) {
+        _dropped = true;
+    } else if (block != nullptr) {
+        _pkt = (T *)block;
+        _reserved = true;
+    }
+    _pkt->head1 = HEAD_BYTE1;
+    _pkt->head2 = HEAD_BYTE2;
+    _pkt->msgid = msg_type;
+}
+
+template <typename T>
+DataFlash_Message<T>::~DataFlash_Message()
+{
+    if (_reserved) {
+        // never written, give the space back
+        _dataflash.abort_block();
+    }
+}
+
+template <typename T>
+void DataFlash_Message<T>::write()
+{
+    if (_reserved) {
+        _dataflash.commit_block(sizeof(T));
+        _reserved = false;
+    } else if (!_dropped) {
+        _dataflash.WritePrioritisedBlock(&_local, sizeof(T), _is_critical);
+    }
+    _dropped = true;
+}
+
 #endif
@@ -10,6 +10,12 @@ DataFlash_Backend::DataFlash_Backend(DataFlash_Class &front,
     _startup_messagewriter(writer)
 {
     writer->set_dataflash_backend(this);
+#if DATAFLASH_MSG_STATS
+    _msg_stats = (struct msg_stats *)calloc(256, sizeof(struct msg_stats));
+    _decimation = 1;
+    _admitted = false;
+    memset(_rate_limit_last_us, 0, sizeof(_rate_limit_last_us));
+#endif
 }
 
 uint8_t DataFlash_Backend::num_types() const
@@ -41,16 +47,197 @@ void DataFlash_Backend::periodic_tasks()
     uint32_t now = AP_HAL::millis();
     if (now - _last_periodic_1Hz > 1000) {
         periodic_1Hz(now);
+#if DATAFLASH_MSG_STATS
+        Log_Write_MsgStats();
+#endif
         _last_periodic_1Hz = now;
     }
     if (now - _last_periodic_10Hz > 100) {
         periodic_10Hz(now);
+#if DATAFLASH_MSG_STATS
+        update_decimation();
+#endif
         _last_periodic_10Hz = now;
     }
     periodic_fullrate(now);
 }
 
 
+bool DataFlash_Backend::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
+{
+#if DATAFLASH_MSG_STATS
+    const uint8_t msg_type = ((const uint8_t *)pBuffer)[2];
+    // a message reserve_block() has let through is not checked again,
+    // as that would use up its rate limit slot a second time
+    const bool admitted = _admitted && msg_type == _reserved_type;
+    _admitted = false;
+    if (!admitted && !msg_allowed(msg_type, is_critical)) {
+        return false;
+    }
+    if (!_WritePrioritisedBlock(pBuffer, size, is_critical)) {
+        msg_dropped(msg_type);
+        return false;
+    }
+    msg_written(msg_type, size);
+    return true;
+#else
+    return _WritePrioritisedBlock(pBuffer, size, is_critical);
+#endif
+}
+
+bool DataFlash_Backend::reserve_block(uint8_t msg_type, uint16_t size, bool is_critical, uint8_t *&block)
+{
+    block = nullptr;
+#if DATAFLASH_MSG_STATS
+    if (!msg_allowed(msg_type, is_critical)) {
+        return false;
+    }
+    if (!_reserve_block(size, is_critical, block)) {
+        msg_dropped(msg_type);
+        return false;
+    }
+    // if no block was handed out the message goes through
+    // WritePrioritisedBlock(), which mustn't check it again
+    _reserved_type = msg_type;
+    _admitted = (block == nullptr);
+    return true;
+#else
+    return _reserve_block(size, is_critical, block);
+#endif
+}
+
+void DataFlash_Backend::commit_block(uint16_t size)
+{
+#if DATAFLASH_MSG_STATS
+    msg_written(_reserved_type, size);
+#endif
+    _commit_block(size);
+}
+
+#if DATAFLASH_MSG_STATS
+/*
+  check a message against the LOG_RLn rate limits, and against the
+  decimation of high rate types while the write buffer is filling
+  up. Critical and startup messages are always allowed
+ */
+bool DataFlash_Backend::msg_allowed(uint8_t msg_type, bool is_critical)
+{
+    if (_msg_stats == nullptr) {
+        return true;
+    }
+    struct msg_stats &stats = _msg_stats[msg_type];
+    const uint16_t count = stats.count++;
+    if (is_critical || _writing_startup_messages) {
+        return true;
+    }
+
+    uint8_t slot;
+    const uint32_t interval_us = _front.rate_limit_interval_us(msg_type, slot);
+    if (interval_us != 0) {
+        const uint32_t now_us = AP_HAL::micros();
+        const uint32_t elapsed_us = now_us - _rate_limit_last_us[slot];
+        if (elapsed_us < interval_us) {
+            stats.limited++;
+            return false;
+        }
+        // step on by whole intervals so the average rate is the limit
+        // even when messages don't arrive on interval boundaries. After
+        // a gap restart from now rather than letting a burst through
+        if (elapsed_us < 2 * interval_us) {
+            _rate_limit_last_us[slot] += interval_us;
+        } else {
+            _rate_limit_last_us[slot] = now_us;
+        }
+    }
+
+    if (_decimation > 1 &&
+        stats.rate_hz >= DATAFLASH_DECIMATE_MIN_HZ &&
+        count % _decimation != 0) {
+        stats.limited++;
+        return false;
+    }
+    return true;
+}
+
+void DataFlash_Backend::msg_written(uint8_t msg_type, uint16_t size)
+{
+    if (_msg_stats != nullptr) {
+        _msg_stats[msg_type].bytes += size;
+    }
+}
+
+void DataFlash_Backend::msg_dropped(uint8_t msg_type)
+{
+    if (_msg_stats != nullptr) {
+        _msg_stats[msg_type].dropped++;
+    }
+}
+
+/*
+  thin out high rate messages as the write buffer fills, leaving room
+  for critical and low rate messages
+ */
+void DataFlash_Backend::update_decimation()
+{
+    const uint8_t used = buffer_used_percent();
+    if (used < 50) {
+        _decimation = 1;
+    } else if (used < 75) {
+        _decimation = 2;
+    } else if (used < 90) {
+        _decimation = 4;
+    } else {
+        _decimation = 8;
+    }
+}
+
+/*
+  log the bandwidth used by each message type over the last second,
+  and start counting the next
+ */
+void DataFlash_Backend::Log_Write_MsgStats()
+{
+    if (_msg_stats == nullptr) {
+        return;
+    }
+    // before a log is open these writes fail, and the counts of the
+    // messages that went nowhere are thrown away with them
+    const bool write = _writes_enabled;
+    const uint64_t time_us = AP_HAL::micros64();
+    for (uint16_t i=0; i<256; i++) {
+        struct msg_stats &stats = _msg_stats[i];
+        if (write && i != LOG_DFT_MSG && stats.count != 0) {
+            struct log_DFT pkt = {
+                LOG_PACKET_HEADER_INIT(LOG_DFT_MSG),
+                time_us      : time_us,
+                msg_type     : (uint8_t)i,
+                name         : {},
+                rate_hz      : stats.count,
+                bytes        : stats.bytes,
+                dropped      : stats.dropped,
+                limited      : stats.limited,
+                decimation   : _decimation,
+            };
+            for (uint8_t j=0; j<num_types(); j++) {
+                const struct LogStructure *s = structure(j);
+                if (s->msg_type == i) {
+                    strncpy(pkt.name, s->name, sizeof(pkt.name));
+                    break;
+                }
+            }
+            WriteBlock(&pkt, sizeof(pkt));
+        }
+        stats.rate_hz = stats.count;
+        stats.count = 0;
+        stats.bytes = 0;
+        stats.dropped = 0;
+        stats.limited = 0;
+    }
+    // the stats messages themselves aren't counted
+    memset(&_msg_stats[LOG_DFT_MSG], 0, sizeof(_msg_stats[LOG_DFT_MSG]));
+}
+#endif
+
 void DataFlash_Backend::internal_error() {
     _internal_errors++;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
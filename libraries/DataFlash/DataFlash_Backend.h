@@ -3,6 +3,15 @@
 
 #include "DataFlash.h"
 
+// per message type accounting, rate limits and decimation
+#ifndef DATAFLASH_MSG_STATS
+#define DATAFLASH_MSG_STATS (HAL_CPU_CLASS >= HAL_CPU_CLASS_150)
+#endif
+
+// under buffer pressure only message types logged at least this often
+// are decimated
+#define DATAFLASH_DECIMATE_MIN_HZ 25
+
 class DFMessageWriter_DFLogStart;
 
 class DataFlash_Backend
@@ -36,7 +45,24 @@ public:
         return WritePrioritisedBlock(pBuffer, size, true);
     }
 
-    virtual bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) = 0;
+    /*
+      write a message, subject to the rate limits and decimation of
+      its type unless it is critical, counting the bytes written or
+      the drop
+     */
+    bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical);
+
+    /*
+      reserve contiguous space in the write buffer for a message to be
+      written in place. Returns false if the message would be
+      dropped. block is left nullptr by backends that can't do this,
+      and when the space wraps around the end of the buffer; the
+      message is then written with WritePrioritisedBlock()
+     */
+    bool reserve_block(uint8_t msg_type, uint16_t size, bool is_critical, uint8_t *&block);
+    // make a reserved block visible to the writer, or give it back
+    void commit_block(uint16_t size);
+    void abort_block() { _abort_block(); }
 
     // high level interface
     virtual uint16_t find_last_log() = 0;
@@ -63,6 +89,9 @@ public:
 
     virtual uint16_t bufferspace_available() = 0;
 
+    // how full the write buffer is, for adaptive decimation
+    virtual uint8_t buffer_used_percent() { return 0; }
+
     virtual uint16_t start_new_log(void) = 0;
     bool log_write_started;
 
@@ -96,6 +125,16 @@ public:
                              enum ap_var_type type);
 
 protected:
+    // backend specific writing, see WritePrioritisedBlock and
+    // reserve_block above
+    virtual bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) = 0;
+    virtual bool _reserve_block(uint16_t size, bool is_critical, uint8_t *&block) {
+        block = nullptr;
+        return true;
+    }
+    virtual void _commit_block(uint16_t size) { }
+    virtual void _abort_block() { }
+
     uint32_t dropped;
     uint8_t internal_errors; // uint8_t - wishful thinking?
 
@@ -133,6 +172,37 @@ private:
 
     uint32_t _last_periodic_1Hz;
     uint32_t _last_periodic_10Hz;
+
+#if DATAFLASH_MSG_STATS
+    // accounting for one message type
+    struct msg_stats {
+        uint32_t bytes;         // bytes written this second
+        uint16_t count;         // messages offered this second
+        uint16_t rate_hz;       // messages offered last second
+        uint16_t dropped;       // messages dropped for lack of space
+        uint16_t limited;       // messages suppressed by rate limits and decimation
+    };
+    struct msg_stats *_msg_stats;
+
+    // keep one in this many messages of high rate types
+    uint8_t _decimation;
+
+    // time the current interval of each LOG_RLn limit started
+    uint32_t _rate_limit_last_us[DATAFLASH_RATE_LIMITS];
+
+    // type of the block reserved for in-place writing
+    uint8_t _reserved_type;
+
+    // reserve_block() already admitted a message of _reserved_type
+    // that will be copied in with WritePrioritisedBlock()
+    bool _admitted;
+
+    bool msg_allowed(uint8_t msg_type, bool is_critical);
+    void msg_written(uint8_t msg_type, uint16_t size);
+    void msg_dropped(uint8_t msg_type);
+    void update_decimation();
+    void Log_Write_MsgStats();
+#endif
 };
 
 #endif
@@ -43,7 +43,7 @@ void DataFlash_Block::FinishWrite(void)
     df_BufferIdx = 0;
 }
 
-bool DataFlash_Block::WritePrioritisedBlock(const void *pBuffer, uint16_t size,
+bool DataFlash_Block::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     bool is_critical)
 {
     // is_critical is ignored - we're a ring buffer and never run out
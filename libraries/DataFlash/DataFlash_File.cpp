@@ -210,6 +210,15 @@ uint16_t DataFlash_File::bufferspace_available()
     return (BUF_SPACE(_writebuf)) - critical_message_reserved_space();
 }
 
+uint8_t DataFlash_File::buffer_used_percent()
+{
+    if (_writebuf == NULL || _writebuf_size == 0) {
+        return 0;
+    }
+    uint16_t _head;
+    return 100 - (BUF_SPACE(_writebuf) * 100) / _writebuf_size;
+}
+
 // return true for CardInserted() if we successfully initialised
 bool DataFlash_File::CardInserted(void)
 {
@@ -468,7 +477,12 @@ void DataFlash_File::EraseAll()
 }
 
 /* Write a block of data at current offset */
-bool DataFlash_File::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
+/*
+  check there is room for a message of size bytes and take the write
+  semaphore. On success the caller must add the message and give the
+  semaphore back
+ */
+bool DataFlash_File::start_write(uint16_t size, bool is_critical)
 {
     if (_write_fd == -1 || !_initialised || _open_error || !_writes_enabled) {
         return false;
@@ -514,6 +528,16 @@ bool DataFlash_File::WritePrioritisedBlock(const void *pBuffer, uint16_t size, b
         return false;
     }
 
+    return true;
+}
+
+bool DataFlash_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
+{
+    if (!start_write(size, is_critical)) {
+        return false;
+    }
+
+    const uint16_t _head = _writebuf_head;
     if (_writebuf_tail < _head) {
         // perform as single memcpy
         assert(((uint32_t)_writebuf_tail)+size <= _writebuf_size);
@@ -538,6 +562,40 @@ bool DataFlash_File::WritePrioritisedBlock(const void *pBuffer, uint16_t size, b
     return true;
 }
 
+/*
+  hand out the tail of the write buffer for a message to be built in
+  place, saving the copy in WritePrioritisedBlock(). The semaphore is
+  held until commit_block() or abort_block()
+ */
+bool DataFlash_File::_reserve_block(uint16_t size, bool is_critical, uint8_t *&block)
+{
+    block = nullptr;
+    if (!start_write(size, is_critical)) {
+        return false;
+    }
+    // start_write() has checked the total space, but the message
+    // must not wrap around the end of the buffer
+    const uint16_t _head = _writebuf_head;
+    if (_writebuf_tail >= _head &&
+        _writebuf_size - _writebuf_tail < size) {
+        semaphore->give();
+        return true;
+    }
+    block = &_writebuf[_writebuf_tail];
+    return true;
+}
+
+void DataFlash_File::_commit_block(uint16_t size)
+{
+    BUF_ADVANCETAIL(_writebuf, size);
+    semaphore->give();
+}
+
+void DataFlash_File::_abort_block()
+{
+    semaphore->give();
+}
+
 /*
   read a packet. The header bytes have already been read.
 */
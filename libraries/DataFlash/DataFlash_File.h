@@ -46,7 +46,11 @@ public:
     void Prep();
 
     /* Write a block of data at current offset */
-    bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical);
+    bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical);
+    bool _reserve_block(uint16_t size, bool is_critical, uint8_t *&block) override;
+    void _commit_block(uint16_t size) override;
+    void _abort_block() override;
+    uint8_t buffer_used_percent() override;
     uint16_t bufferspace_available();
 
     // high level interface
@@ -120,6 +124,8 @@ private:
 
     void stop_logging(void);
 
+    bool start_write(uint16_t size, bool is_critical);
+
     void _io_timer(void);
 
     uint16_t critical_message_reserved_space() const {
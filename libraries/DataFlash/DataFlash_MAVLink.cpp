@@ -27,6 +27,14 @@ void DataFlash_MAVLink::Init()
 {
     DataFlash_Backend::Init();
 
+    // size the block pool from LOG_MAV_BUFSIZE; this may get reduced
+    // below if allocation fails
+    int8_t bufsize = _front._params.mav_bufsize;
+    if (bufsize < 2) {
+        bufsize = 2;
+    }
+    _blockcount = (bufsize * 1024UL) / MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN;
+
     _blocks = NULL;
     while (_blockcount >= 8) { // 8 is a *magic* number
         _blocks = (struct dm_block *) malloc(_blockcount * sizeof(_blocks[0]));
@@ -39,9 +47,16 @@ void DataFlash_MAVLink::Init()
     if (_blocks == NULL) {
         return;
     }
+    _blocks_by_seq = (struct dm_block **) calloc(_blockcount, sizeof(_blocks_by_seq[0]));
+    if (_blocks_by_seq == NULL) {
+        free(_blocks);
+        _blocks = NULL;
+        return;
+    }
 
     free_all_blocks();
     stats_init();
+    congestion_reset();
 
     _initialised = true;
     _logging_started = true; // in actual fact, we throw away
@@ -51,7 +66,15 @@ void DataFlash_MAVLink::Init()
 }
 
 uint16_t DataFlash_MAVLink::bufferspace_available() {
-    return (_blockcount_free * 200 + remaining_space_in_current_block());
+    const uint32_t space = _blockcount_free * 200UL + remaining_space_in_current_block();
+    return (space > UINT16_MAX) ? UINT16_MAX : space;
+}
+
+uint8_t DataFlash_MAVLink::buffer_used_percent() {
+    if (_blockcount == 0) {
+        return 0;
+    }
+    return 100 - (_blockcount_free * 100) / _blockcount;
 }
 
 uint8_t DataFlash_MAVLink::remaining_space_in_current_block() {
@@ -61,56 +84,73 @@ uint8_t DataFlash_MAVLink::remaining_space_in_current_block() {
 
 void DataFlash_MAVLink::enqueue_block(dm_block_queue_t &queue, struct dm_block *block)
 {
+    block->next = NULL;
+    block->prev = queue.youngest;
     if (queue.youngest != NULL) {
         queue.youngest->next = block;
     } else {
         queue.oldest = block;
     }
     queue.youngest = block;
+    block->queue = &queue;
+    queue.size++;
 }
 
-struct DataFlash_MAVLink::dm_block *DataFlash_MAVLink::dequeue_seqno(DataFlash_MAVLink::dm_block_queue_t &queue, uint32_t seqno)
+// take a block off whichever queue it is on
+void DataFlash_MAVLink::unlink_block(struct dm_block *block)
 {
-    struct dm_block *prev = NULL;
-    for (struct dm_block *block=queue.oldest; block != NULL; block=block->next) {
+    dm_block_queue_t *queue = block->queue;
+    if (queue == NULL) {
+        return;
+    }
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        queue->oldest = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    } else {
+        queue->youngest = block->prev;
+    }
+    block->next = NULL;
+    block->prev = NULL;
+    block->queue = NULL;
+    queue->size--;
+}
+
+// find the in-use block with a sequence number, NULL if it has been freed
+struct DataFlash_MAVLink::dm_block *DataFlash_MAVLink::find_seqno(uint32_t seqno)
+{
+    for (struct dm_block *block=_blocks_by_seq[seqno % _blockcount]; block != NULL; block=block->seq_next) {
         if (block->seqno == seqno) {
-            if (prev == NULL) {
-                if (queue.youngest == queue.oldest) {
-                    queue.oldest = NULL;
-                    queue.youngest = NULL;
-                } else {
-                    queue.oldest = block->next;
-                }
-            } else {
-                if (queue.youngest == block) {
-                    queue.youngest = prev;
-                }
-                prev->next = block->next;
-            }
-            block->next = NULL;
             return block;
         }
-        prev = block;
     }
     return NULL;
 }
 
-bool DataFlash_MAVLink::free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue)
+void DataFlash_MAVLink::free_block(struct dm_block *block)
 {
-    struct dm_block *block = dequeue_seqno(queue, seqno);
-    if (block != NULL) {
-        block->next = _blocks_free;
-        _blocks_free = block;
-        _blockcount_free++; // comment me out to expose a bug!
-        return true;
+    // remove from the seqno index
+    struct dm_block **link = &_blocks_by_seq[block->seqno % _blockcount];
+    while (*link != NULL && *link != block) {
+        link = &(*link)->seq_next;
     }
-    return false;
+    if (*link == block) {
+        *link = block->seq_next;
+    }
+    block->seq_next = NULL;
+
+    block->next = _blocks_free;
+    _blocks_free = block;
+    _blockcount_free++; // comment me out to expose a bug!
 }
     
 /* Write a block of data at current offset */
 
 // DM_write: 70734 events, 0 overruns, 167806us elapsed, 2us avg, min 1us max 34us 0.620us rms
-bool DataFlash_MAVLink::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
+bool DataFlash_MAVLink::_WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
 {
     if (!_initialised || !_sending_to_client || !_writes_enabled) {
         return false;
@@ -168,7 +208,14 @@ struct DataFlash_MAVLink::dm_block *DataFlash_MAVLink::next_block()
         _blockcount_free--;
         ret->seqno = _next_seq_num++;
         ret->last_sent = 0;
+        ret->last_sent_us = 0;
+        ret->send_count = 0;
         ret->next = NULL;
+        ret->prev = NULL;
+        ret->queue = NULL;
+        struct dm_block *&bucket = _blocks_by_seq[ret->seqno % _blockcount];
+        ret->seq_next = bucket;
+        bucket = ret;
         _latest_block_len = 0;
     }
     return ret;
@@ -180,14 +227,17 @@ void DataFlash_MAVLink::free_all_blocks()
     _current_block = NULL;
 
     _blocks_pending.sent_count = 0;
+    _blocks_pending.size = 0;
     _blocks_pending.oldest = _blocks_pending.youngest = NULL;
     _blocks_retry.sent_count = 0;
+    _blocks_retry.size = 0;
     _blocks_retry.oldest = _blocks_retry.youngest = NULL;
     _blocks_sent.sent_count = 0;
+    _blocks_sent.size = 0;
     _blocks_sent.oldest = _blocks_sent.youngest = NULL;
 
     // add blocks to the free stack:
-    for(uint8_t i=0; i < _blockcount; i++) {
+    for(uint16_t i=0; i < _blockcount; i++) {
         _blocks[i].next = _blocks_free;
         _blocks_free = &_blocks[i];
         // this value doesn't really matter, but it stops valgrind
@@ -195,6 +245,9 @@ void DataFlash_MAVLink::free_all_blocks()
         // state).  Also, when we receive ACKs we check seqno, and we
         // want to ack the *real* block zero!
         _blocks[i].seqno = 9876543;
+        _blocks[i].seq_next = NULL;
+        _blocks[i].queue = NULL;
+        _blocks_by_seq[i] = NULL;
     }
     _blockcount_free = _blockcount;
 
@@ -226,6 +279,7 @@ void DataFlash_MAVLink::handle_ack(mavlink_channel_t chan,
             //     return;
             // }
             stats_init();
+            congestion_reset();
             _sending_to_client = true;
             _target_system_id = msg->sysid;
             _target_component_id = msg->compid;
@@ -238,16 +292,20 @@ void DataFlash_MAVLink::handle_ack(mavlink_channel_t chan,
         return;
     }
 
-    // check SENT blocks (VERY likely to be first on the list):
-    if (free_seqno_from_queue(seqno, _blocks_sent)) {
-        // celebrate
-        _last_response_time = AP_HAL::millis();
-    } else if(free_seqno_from_queue(seqno, _blocks_retry)) {
-        // party
-        _last_response_time = AP_HAL::millis();
-    } else {
+    // acks are selective: each names one block, which may be anywhere
+    // in the window
+    struct dm_block *block = find_seqno(seqno);
+    if (block == NULL ||
+        (block->queue != &_blocks_sent && block->queue != &_blocks_retry)) {
         // probably acked already and put on the free list.
+        return;
     }
+    unlink_block(block);
+    const uint32_t now = AP_HAL::millis();
+    _last_response_time = now;
+    stats.blocks_acked++;
+    congestion_ack(*block, now);
+    free_block(block);
 }
 
 void DataFlash_MAVLink::remote_log_block_status_msg(mavlink_channel_t chan,
@@ -268,13 +326,74 @@ void DataFlash_MAVLink::handle_retry(uint32_t seqno)
         return;
     }
 
-    struct dm_block *victim = dequeue_seqno(_blocks_sent, seqno);
-    if (victim != NULL) {
-        _last_response_time = AP_HAL::millis();
+    struct dm_block *victim = find_seqno(seqno);
+    if (victim != NULL && victim->queue == &_blocks_sent) {
+        const uint32_t now = AP_HAL::millis();
+        _last_response_time = now;
+        unlink_block(victim);
         enqueue_block(_blocks_retry, victim);
+        stats.nacks++;
+        congestion_loss(now);
+    }
+}
+
+void DataFlash_MAVLink::congestion_reset()
+{
+    _cwnd = DF_MAVLINK_CWND_INITIAL;
+    _ssthresh = _blockcount;
+    _have_rtt = false;
+    _srtt_ms = 0;
+    _rttvar_ms = 0;
+    _last_cwnd_cut_ms = 0;
+}
+
+void DataFlash_MAVLink::congestion_ack(const struct dm_block &block, uint32_t now)
+{
+    // only blocks sent once give an unambiguous round trip time
+    if (block.send_count == 1) {
+        const float rtt_ms = (AP_HAL::micros() - block.last_sent_us) * 0.001f;
+        if (!_have_rtt) {
+            _have_rtt = true;
+            _srtt_ms = rtt_ms;
+            _rttvar_ms = rtt_ms / 2;
+        } else {
+            _rttvar_ms = 0.75f * _rttvar_ms + 0.25f * fabsf(_srtt_ms - rtt_ms);
+            _srtt_ms = 0.875f * _srtt_ms + 0.125f * rtt_ms;
+        }
+    }
+
+    if (_cwnd < _ssthresh) {
+        _cwnd += 1;
+    } else {
+        _cwnd += 1 / _cwnd;
+    }
+    if (_cwnd > _blockcount) {
+        _cwnd = _blockcount;
     }
 }
 
+void DataFlash_MAVLink::congestion_loss(uint32_t now)
+{
+    // a burst of losses is a single congestion event; cut the window
+    // at most once per resend timeout
+    if (now - _last_cwnd_cut_ms < resend_timeout_ms()) {
+        return;
+    }
+    _last_cwnd_cut_ms = now;
+    _ssthresh = MAX(_cwnd / 2, DF_MAVLINK_CWND_MIN);
+    _cwnd = _ssthresh;
+}
+
+uint16_t DataFlash_MAVLink::resend_timeout_ms() const
+{
+    if (!_have_rtt) {
+        return DF_MAVLINK_RTO_INITIAL_MS;
+    }
+    return constrain_float(_srtt_ms + 4 * _rttvar_ms,
+                           DF_MAVLINK_RTO_MIN_MS,
+                           DF_MAVLINK_RTO_MAX_MS);
+}
+
 void DataFlash_MAVLink::set_channel(mavlink_channel_t chan)
 {
     _chan = chan;
@@ -304,6 +423,10 @@ void DataFlash_MAVLink::stats_reset() {
     stats.state_sent_min = -1; // unsigned wrap
     stats.state_sent_max = 0;
     stats.collection_count = 0;
+    stats.blocks_sent = 0;
+    stats.blocks_acked = 0;
+    stats.nacks = 0;
+    stats.timeouts = 0;
 }
 
 void DataFlash_MAVLink::Log_Write_DF_MAV(DataFlash_MAVLink &df)
@@ -319,22 +442,45 @@ void DataFlash_MAVLink::Log_Write_DF_MAV(DataFlash_MAVLink &df)
         retries           : df._blocks_retry.sent_count,
         resends           : df.stats.resends,
         internal_errors   : df.internal_errors,
-        state_free_avg    : (uint8_t)(df.stats.state_free/df.stats.collection_count),
+        state_free_avg    : (uint16_t)(df.stats.state_free/df.stats.collection_count),
         state_free_min    : df.stats.state_free_min,
         state_free_max    : df.stats.state_free_max,
-        state_pending_avg : (uint8_t)(df.stats.state_pending/df.stats.collection_count),
+        state_pending_avg : (uint16_t)(df.stats.state_pending/df.stats.collection_count),
         state_pending_min : df.stats.state_pending_min,
         state_pending_max : df.stats.state_pending_max,
-        state_sent_avg    : (uint8_t)(df.stats.state_sent/df.stats.collection_count),
+        state_sent_avg    : (uint16_t)(df.stats.state_sent/df.stats.collection_count),
         state_sent_min    : df.stats.state_sent_min,
         state_sent_max    : df.stats.state_sent_max,
-        // state_retry_avg   : (uint8_t)(df.stats.state_retry/df.stats.collection_count),
+        // state_retry_avg   : (uint16_t)(df.stats.state_retry/df.stats.collection_count),
         // state_retry_min    : df.stats.state_retry_min,
         // state_retry_max    : df.stats.state_retry_max
     };
     WriteBlock(&pkt,sizeof(pkt));
 }
 
+void DataFlash_MAVLink::Log_Write_DF_MAV_Throughput(const uint32_t now)
+{
+    const uint32_t dt = now - _stats_last_logged_time;
+    if (dt == 0) {
+        return;
+    }
+    const uint32_t block_len = MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN;
+    struct log_DF_MAV_Throughput pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_DF_MAV_THROUGHPUT),
+        time_us   : AP_HAL::micros64(),
+        cwnd      : _cwnd,
+        ssthresh  : _ssthresh,
+        srtt      : (uint16_t)_srtt_ms,
+        rto       : resend_timeout_ms(),
+        in_flight : _blocks_sent.size,
+        tx_rate   : (uint32_t)((uint64_t)stats.blocks_sent * block_len * 1000 / dt),
+        ack_rate  : (uint32_t)((uint64_t)stats.blocks_acked * block_len * 1000 / dt),
+        nacks     : stats.nacks,
+        timeouts  : stats.timeouts,
+    };
+    WriteBlock(&pkt, sizeof(pkt));
+}
+
 void DataFlash_MAVLink::stats_log()
 {
     if (!_initialised || !_logging_started) {
@@ -343,7 +489,10 @@ void DataFlash_MAVLink::stats_log()
     if (stats.collection_count == 0) {
         return;
     }
+    const uint32_t now = AP_HAL::millis();
     Log_Write_DF_MAV(*this);
+    Log_Write_DF_MAV_Throughput(now);
+    _stats_last_logged_time = now;
 #if REMOTE_LOG_DEBUGGING
     printf("D:%d Retry:%d Resent:%d E:%d SF:%d/%d/%d SP:%d/%d/%d SS:%d/%d/%d SR:%d/%d/%d\n",
            dropped,
@@ -367,15 +516,15 @@ void DataFlash_MAVLink::stats_log()
     stats_reset();
 }
 
-uint8_t DataFlash_MAVLink::stack_size(struct dm_block *stack)
+uint16_t DataFlash_MAVLink::stack_size(struct dm_block *stack)
 {
-    uint8_t ret = 0;
+    uint16_t ret = 0;
     for (struct dm_block *block=stack; block != NULL; block=block->next) {
         ret++;
     }
     return ret;
 }
-uint8_t DataFlash_MAVLink::queue_size(dm_block_queue_t queue)
+uint16_t DataFlash_MAVLink::queue_size(dm_block_queue_t queue)
 {
     return stack_size(queue.oldest);
 }
@@ -385,12 +534,15 @@ void DataFlash_MAVLink::stats_collect()
     if (!_initialised || !_logging_started) {
         return;
     }
-    uint8_t pending = queue_size(_blocks_pending);
-    uint8_t sent = queue_size(_blocks_sent);
-    uint8_t retry = queue_size(_blocks_retry);
-    uint8_t sfree = stack_size(_blocks_free);
+    uint16_t pending = queue_size(_blocks_pending);
+    uint16_t sent = queue_size(_blocks_sent);
+    uint16_t retry = queue_size(_blocks_retry);
+    uint16_t sfree = stack_size(_blocks_free);
 
-    if (sfree != _blockcount_free) {
+    if (sfree != _blockcount_free ||
+        pending != _blocks_pending.size ||
+        sent != _blocks_sent.size ||
+        retry != _blocks_retry.size) {
         internal_error();
     }
     stats.state_pending += pending;
@@ -427,7 +579,8 @@ void DataFlash_MAVLink::stats_collect()
 }
 
 /* while we "successfully" send log blocks from a queue, move them to
- * the sent list. DO NOT call this for blocks already sent!
+ * the sent list. DO NOT call this for blocks already sent!  Stops
+ * when the congestion window is full.
 */
 bool DataFlash_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue)
 {
@@ -436,16 +589,16 @@ bool DataFlash_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue)
         if (sent_count++ > _max_blocks_per_send_blocks) {
             return false;
         }
+        if (_blocks_sent.size >= (uint16_t)_cwnd) {
+            return false;
+        }
         if (! send_log_block(*queue.oldest)) {
             return false;
         }
         queue.sent_count++;
-        struct DataFlash_MAVLink::dm_block *tmp = dequeue_seqno(queue,queue.oldest->seqno);
-        if (tmp != NULL) { // should never be NULL
-            enqueue_block(_blocks_sent, tmp);
-        } else {
-            internal_error();
-        }
+        struct DataFlash_MAVLink::dm_block *tmp = queue.oldest;
+        unlink_block(tmp);
+        enqueue_block(_blocks_sent, tmp);
     }
     return true;
 }
@@ -473,22 +626,28 @@ void DataFlash_MAVLink::do_resends(uint32_t now)
         return;
     }
 
-    uint8_t count_to_send = 5;
-    if (_blockcount < count_to_send) {
-        count_to_send = _blockcount;
-    }
-    uint32_t oldest = now - 100; // 100 milliseconds before resend.  Hmm.
-    while (count_to_send-- > 0) {
-        for (struct dm_block *block=_blocks_sent.oldest; block != NULL; block=block->next) {
-            // only want to send blocks every now-and-then:
-            if (block->last_sent < oldest) {
-                if (! send_log_block(*block)) {
-                    // failed to send the block; try again later....
-                    return;
-                }
-                stats.resends++;
-            }
+    // blocks unacknowledged for longer than the resend timeout are
+    // taken as lost
+    const uint16_t timeout = resend_timeout_ms();
+    uint8_t count_to_send = _max_blocks_per_send_blocks;
+    bool lost = false;
+    for (struct dm_block *block=_blocks_sent.oldest;
+         block != NULL && count_to_send > 0;
+         block=block->next) {
+        if (now - block->last_sent < timeout) {
+            continue;
         }
+        if (! send_log_block(*block)) {
+            // failed to send the block; try again later....
+            break;
+        }
+        stats.resends++;
+        stats.timeouts++;
+        count_to_send--;
+        lost = true;
+    }
+    if (lost) {
+        congestion_loss(now);
     }
 }
 
@@ -560,6 +719,11 @@ bool DataFlash_MAVLink::send_log_block(struct dm_block &block)
 #endif
 
     block.last_sent = AP_HAL::millis();
+    block.last_sent_us = AP_HAL::micros();
+    if (block.send_count < UINT8_MAX) {
+        block.send_count++;
+    }
+    stats.blocks_sent++;
     chan_status->current_tx_seq = saved_seq;
 
     // _last_send_time is set even if we fail to send the packet; if
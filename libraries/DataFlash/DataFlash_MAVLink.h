@@ -21,6 +21,23 @@ extern const AP_HAL::HAL& hal;
 
 #define DF_MAVLINK_DISABLE_INTERRUPTS 0
 
+// blocks pushed from the retry and pending queues per call to
+// push_log_blocks
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+#define DF_MAVLINK_MAX_BLOCKS_PER_SEND 32
+#else
+#define DF_MAVLINK_MAX_BLOCKS_PER_SEND 8
+#endif
+
+// congestion window, in blocks
+#define DF_MAVLINK_CWND_MIN      2
+#define DF_MAVLINK_CWND_INITIAL  8
+
+// bounds on the time before an unacknowledged block is sent again
+#define DF_MAVLINK_RTO_INITIAL_MS 100
+#define DF_MAVLINK_RTO_MIN_MS      20
+#define DF_MAVLINK_RTO_MAX_MS    1000
+
 class DataFlash_MAVLink : public DataFlash_Backend
 {
     friend class DataFlash_Class; // for access to stats on Log_Df_Mav_Stats
@@ -28,8 +45,8 @@ public:
     // constructor
     DataFlash_MAVLink(DataFlash_Class &front, DFMessageWriter_DFLogStart *writer) :
         DataFlash_Backend(front, writer),
-        _max_blocks_per_send_blocks(8),
-        _blockcount(32) // this may get reduced in Init if allocation fails
+        _max_blocks_per_send_blocks(DF_MAVLINK_MAX_BLOCKS_PER_SEND),
+        _blockcount(0) // set from LOG_MAV_BUFSIZE in Init
         ,_perf_packing(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DM_packing"))
         { }
 
@@ -39,8 +56,8 @@ public:
     bool logging_started() { return _logging_started; }
 
     /* Write a block of data at current offset */
-    bool WritePrioritisedBlock(const void *pBuffer, uint16_t size,
-                               bool is_critical) override;
+    bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size,
+                                bool is_critical) override;
 
     // initialisation
     bool CardInserted(void) override { return true; }
@@ -73,11 +90,17 @@ public:
     //     BLOCK_STATE_SEND_RETRY,
     //     BLOCK_STATE_SENT
     // };
+    struct dm_block_queue;
     struct dm_block {
         uint32_t seqno;
         uint8_t buf[MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN];
-        uint32_t last_sent;
+        uint32_t last_sent;    // ms, for the resend timeout
+        uint32_t last_sent_us; // for the round trip time
+        uint8_t send_count;
         struct dm_block *next;
+        struct dm_block *prev;
+        struct dm_block *seq_next;     // next block in the same _blocks_by_seq bucket
+        struct dm_block_queue *queue;  // queue the block is on, NULL if none
     };
     void push_log_blocks();
     virtual bool send_log_block(struct dm_block &block);
@@ -88,20 +111,24 @@ public:
     virtual void remote_log_block_status_msg(mavlink_channel_t chan, mavlink_message_t* msg) override;
     void free_all_blocks();
 
-    // a stack for free blocks, queues for pending, sent, retries and sent
+    // a stack for free blocks, queues for pending, sent, retries and
+    // sent. The queues are doubly linked so an acked block can be
+    // taken out from anywhere in them
     struct dm_block_queue {
         uint32_t sent_count;
+        uint16_t size;
         struct dm_block *oldest;
         struct dm_block *youngest;
     };
     typedef struct dm_block_queue dm_block_queue_t ;
     void enqueue_block(dm_block_queue_t &queue, struct dm_block *block);
     bool queue_has_block(dm_block_queue_t &queue, struct dm_block *block);
-    struct dm_block *dequeue_seqno(dm_block_queue_t &queue, uint32_t seqno);
-    bool free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue);
+    void unlink_block(struct dm_block *block);
+    struct dm_block *find_seqno(uint32_t seqno);
+    void free_block(struct dm_block *block);
     bool send_log_blocks_from_queue(dm_block_queue_t &queue);
-    uint8_t stack_size(struct dm_block *stack);
-    uint8_t queue_size(dm_block_queue_t queue);
+    uint16_t stack_size(struct dm_block *stack);
+    uint16_t queue_size(dm_block_queue_t queue);
     
     struct dm_block *_blocks_free;
     dm_block_queue_t _blocks_sent;
@@ -113,18 +140,23 @@ protected:
         // the following are reset any time we log stats (see "reset_stats")
         uint32_t resends;
         uint8_t collection_count;
-        uint16_t state_free; // cumulative across collection period
-        uint8_t state_free_min;
-        uint8_t state_free_max;
-        uint16_t state_pending; // cumulative across collection period
-        uint8_t state_pending_min;
-        uint8_t state_pending_max;
-        uint16_t state_retry; // cumulative across collection period
-        uint8_t state_retry_min;
-        uint8_t state_retry_max;
-        uint16_t state_sent; // cumulative across collection period
-        uint8_t state_sent_min;
-        uint8_t state_sent_max;
+        uint32_t state_free; // cumulative across collection period
+        uint16_t state_free_min;
+        uint16_t state_free_max;
+        uint32_t state_pending; // cumulative across collection period
+        uint16_t state_pending_min;
+        uint16_t state_pending_max;
+        uint32_t state_retry; // cumulative across collection period
+        uint16_t state_retry_min;
+        uint16_t state_retry_max;
+        uint32_t state_sent; // cumulative across collection period
+        uint16_t state_sent_min;
+        uint16_t state_sent_max;
+        // throughput over the logging period
+        uint32_t blocks_sent; // including resends
+        uint32_t blocks_acked;
+        uint16_t nacks;
+        uint16_t timeouts;
     } stats;
 
 private:
@@ -152,15 +184,38 @@ private:
     uint8_t _next_block_number_to_resend;
     bool _sending_to_client;
 
+    /*
+      sliding window congestion control. At most _cwnd blocks are
+      sent and not yet acknowledged. The window grows with each ack,
+      exponentially below _ssthresh and by a block per window above
+      it, and halves when the client reports a block missing or a
+      block goes unacknowledged for the resend timeout
+     */
+    float _cwnd;
+    float _ssthresh;
+    bool _have_rtt;
+    float _srtt_ms;   // smoothed round trip time
+    float _rttvar_ms; // round trip time variation
+    uint32_t _last_cwnd_cut_ms;
+    void congestion_reset();
+    void congestion_ack(const struct dm_block &block, uint32_t now);
+    void congestion_loss(uint32_t now);
+    uint16_t resend_timeout_ms() const;
+
     void Log_Write_DF_MAV(DataFlash_MAVLink &df);
+    void Log_Write_DF_MAV_Throughput(uint32_t now);
     
     void internal_error();
     uint16_t bufferspace_available() override; // in bytes
+    uint8_t buffer_used_percent() override;
     uint8_t remaining_space_in_current_block();
     // write buffer
-    uint8_t _blockcount_free;
-    uint8_t _blockcount;
+    uint16_t _blockcount_free;
+    uint16_t _blockcount;
     struct dm_block *_blocks;
+    // blocks handed out by next_block(), hashed on seqno % _blockcount,
+    // so acks find their block without searching the queues
+    struct dm_block **_blocks_by_seq;
     struct dm_block *_current_block;
     struct dm_block *next_block();
 
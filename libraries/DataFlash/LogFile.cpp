@@ -488,6 +488,17 @@ void DataFlash_Backend::_print_log_entry(uint8_t msg_type,
             ofs += 1;
             break;
         }
+        case 'a': {
+            int16_t v[32];
+            memcpy(&v, &pkt[ofs], sizeof(v));
+            port->printf("[");
+            for (uint8_t i=0; i<32; i++) {
+                port->printf(i==0?"%d":" %d", (int)v[i]);
+            }
+            port->printf("]");
+            ofs += sizeof(v);
+            break;
+        }
         default:
             ofs = msg_len;
             break;
@@ -851,68 +862,31 @@ void DataFlash_Class::Log_Write_Baro(AP_Baro &baro)
 // Write an raw accel/gyro data packet
 void DataFlash_Class::Log_Write_IMU(const AP_InertialSensor &ins)
 {
-    uint64_t time_us = AP_HAL::micros64();
-    const Vector3f &gyro = ins.get_gyro(0);
-    const Vector3f &accel = ins.get_accel(0);
-    struct log_IMU pkt = {
-        LOG_PACKET_HEADER_INIT(LOG_IMU_MSG),
-        time_us : time_us,
-        gyro_x  : gyro.x,
-        gyro_y  : gyro.y,
-        gyro_z  : gyro.z,
-        accel_x : accel.x,
-        accel_y : accel.y,
-        accel_z : accel.z,
-        gyro_error  : ins.get_gyro_error_count(0),
-        accel_error : ins.get_accel_error_count(0),
-        temperature : ins.get_temperature(0),
-        gyro_health : (uint8_t)ins.get_gyro_health(0),
-        accel_health : (uint8_t)ins.get_accel_health(0)
-    };
-    WriteBlock(&pkt, sizeof(pkt));
-    if (ins.get_gyro_count() < 2 && ins.get_accel_count() < 2) {
-        return;
-    }
+    static const uint8_t msg_types[] = { LOG_IMU_MSG, LOG_IMU2_MSG, LOG_IMU3_MSG };
+    const uint64_t time_us = AP_HAL::micros64();
+    const uint8_t count = MAX(ins.get_gyro_count(), ins.get_accel_count());
 
-    const Vector3f &gyro2 = ins.get_gyro(1);
-    const Vector3f &accel2 = ins.get_accel(1);
-    struct log_IMU pkt2 = {
-        LOG_PACKET_HEADER_INIT(LOG_IMU2_MSG),
-        time_us : time_us,
-        gyro_x  : gyro2.x,
-        gyro_y  : gyro2.y,
-        gyro_z  : gyro2.z,
-        accel_x : accel2.x,
-        accel_y : accel2.y,
-        accel_z : accel2.z,
-        gyro_error  : ins.get_gyro_error_count(1),
-        accel_error : ins.get_accel_error_count(1),
-        temperature : ins.get_temperature(1),
-        gyro_health : (uint8_t)ins.get_gyro_health(1),
-        accel_health : (uint8_t)ins.get_accel_health(1)
-    };
-    WriteBlock(&pkt2, sizeof(pkt2));
-    if (ins.get_gyro_count() < 3 && ins.get_accel_count() < 3) {
-        return;
+    for (uint8_t i = 0; i < ARRAY_SIZE(msg_types); i++) {
+        if (i > 0 && count <= i) {
+            break;
+        }
+        const Vector3f &gyro = ins.get_gyro(i);
+        const Vector3f &accel = ins.get_accel(i);
+        DataFlash_Message<log_IMU> pkt(*this, msg_types[i]);
+        pkt->time_us      = time_us;
+        pkt->gyro_x       = gyro.x;
+        pkt->gyro_y       = gyro.y;
+        pkt->gyro_z       = gyro.z;
+        pkt->accel_x      = accel.x;
+        pkt->accel_y      = accel.y;
+        pkt->accel_z      = accel.z;
+        pkt->gyro_error   = ins.get_gyro_error_count(i);
+        pkt->accel_error  = ins.get_accel_error_count(i);
+        pkt->temperature  = ins.get_temperature(i);
+        pkt->gyro_health  = ins.get_gyro_health(i);
+        pkt->accel_health = ins.get_accel_health(i);
+        pkt.write();
     }
-    const Vector3f &gyro3 = ins.get_gyro(2);
-    const Vector3f &accel3 = ins.get_accel(2);
-    struct log_IMU pkt3 = {
-        LOG_PACKET_HEADER_INIT(LOG_IMU3_MSG),
-        time_us : time_us,
-        gyro_x  : gyro3.x,
-        gyro_y  : gyro3.y,
-        gyro_z  : gyro3.z,
-        accel_x : accel3.x,
-        accel_y : accel3.y,
-        accel_z : accel3.z,
-        gyro_error  : ins.get_gyro_error_count(2),
-        accel_error : ins.get_accel_error_count(2),
-        temperature : ins.get_temperature(2),
-        gyro_health : (uint8_t)ins.get_gyro_health(2),
-        accel_health : (uint8_t)ins.get_accel_health(2)
-    };
-    WriteBlock(&pkt3, sizeof(pkt3));
 }
 
 // Write an accel/gyro delta time data packet
@@ -1003,6 +977,35 @@ void DataFlash_Class::Log_Write_Vibration(const AP_InertialSensor &ins)
         clipping_2  : ins.get_accel_clip_count(2)
     };
     WriteBlock(&pkt, sizeof(pkt));
+
+#if GYRO_FFT_ENABLED
+    // the gyro spectrum updates at a similar rate, log it alongside
+    // whenever a new frame has been analysed
+    const GyroFFT *fft = ins.get_gyro_fft();
+    if (fft == nullptr || !fft->healthy() ||
+        fft->get_frames_analysed() == _last_gfft_frame) {
+        return;
+    }
+    _last_gfft_frame = fft->get_frames_analysed();
+    const Vector3f &peak_freq = fft->get_peak_freq();
+    const Vector3f &peak_energy = fft->get_peak_energy();
+    const Vector3f &total_energy = fft->get_total_energy();
+    struct log_GyroFFT fft_pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_GYRO_FFT_MSG),
+        time_us        : time_us,
+        peak_freq_x    : peak_freq.x,
+        peak_freq_y    : peak_freq.y,
+        peak_freq_z    : peak_freq.z,
+        peak_energy_x  : peak_energy.x,
+        peak_energy_y  : peak_energy.y,
+        peak_energy_z  : peak_energy.z,
+        total_energy_x : total_energy.x,
+        total_energy_y : total_energy.y,
+        total_energy_z : total_energy.z,
+        frames_dropped : fft->get_frames_dropped()
+    };
+    WriteBlock(&fft_pkt, sizeof(fft_pkt));
+#endif
 }
 
 // Write a mission command. Total length : 36 bytes
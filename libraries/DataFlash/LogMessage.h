@@ -0,0 +1,117 @@
+/// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+#pragma once
+
+/*
+  compile time definition of log messages
+
+  A message is described once, as a list of fields each with its C
+  type, member name, format character and column label:
+
+    #define LOG_FOO_FIELDS(F0, F) \
+        F0(uint64_t, time_us, Q, TimeUS) \
+        F(float,     value,   f, Val)
+
+  The first field uses F0 so that the labels can be joined with commas.
+  From that list
+
+    LOG_MESSAGE_STRUCT(log_Foo, LOG_FOO_FIELDS);
+
+  declares the packed message structure, and
+
+    LOG_MESSAGE_STRUCTURE(log_Foo, LOG_FOO_MSG, "FOO", LOG_FOO_FIELDS)
+
+  is the matching LogStructure entry for the FMT records. The build
+  fails if a field's type doesn't match the size of its format
+  character, or the format or labels are too long, so the two can no
+  longer drift apart.
+
+  DataFlash_Message<log_Foo> then writes the message straight into
+  the backend's write buffer where it can:
+
+    DataFlash_Message<log_Foo> pkt(DataFlash, LOG_FOO_MSG);
+    pkt->time_us = AP_HAL::micros64();
+    pkt->value = foo;
+    pkt.write();
+
+  Every field must be set before write(). The write buffer stays
+  locked while the message is filled in, so do nothing but fill in
+  fields, and in particular don't log anything else, in between.
+ */
+
+// included from LogStructure.h, after the packet header and struct
+// LogStructure are defined
+
+class DataFlash_Class;
+
+// size of a field of the given format character, or 0 if unknown
+constexpr uint8_t log_format_char_size(char c)
+{
+    return (c == 'b' || c == 'B' || c == 'M') ? 1 :
+           (c == 'h' || c == 'H' || c == 'c' || c == 'C') ? 2 :
+           (c == 'i' || c == 'I' || c == 'e' || c == 'E' || c == 'L' || c == 'f' || c == 'n') ? 4 :
+           (c == 'q' || c == 'Q' || c == 'd') ? 8 :
+           (c == 'N') ? 16 :
+           (c == 'Z' || c == 'a') ? 64 :
+           0;
+}
+
+// total size of the fields of a format string
+constexpr uint16_t log_format_size(const char *fmt)
+{
+    return *fmt == 0 ? 0 : log_format_char_size(*fmt) + log_format_size(fmt + 1);
+}
+
+// lets array types such as char[16] be used as a field type
+template <typename T> using log_field_t = T;
+
+#define LOG_FIELD_MEMBER(type, name, fmt, label)                        \
+    log_field_t<type> name;                                             \
+    static_assert(sizeof(log_field_t<type>) == log_format_char_size(#fmt[0]), \
+                  "log field " #name " does not match format " #fmt);
+#define LOG_FIELD_FORMAT(type, name, fmt, label) #fmt
+#define LOG_FIELD_LABEL_FIRST(type, name, fmt, label) #label
+#define LOG_FIELD_LABEL(type, name, fmt, label) "," #label
+
+#define LOG_MESSAGE_STRUCT(name, FIELDS)                                \
+    struct PACKED name {                                                \
+        LOG_PACKET_HEADER;                                              \
+        FIELDS(LOG_FIELD_MEMBER, LOG_FIELD_MEMBER)                      \
+    };                                                                  \
+    static_assert(sizeof(FIELDS(LOG_FIELD_FORMAT, LOG_FIELD_FORMAT)) <= sizeof(((LogStructure *)0)->format), \
+                  #name " has too many fields");                        \
+    static_assert(sizeof(FIELDS(LOG_FIELD_LABEL_FIRST, LOG_FIELD_LABEL)) <= sizeof(((LogStructure *)0)->labels), \
+                  #name " labels are too long");                        \
+    static_assert(sizeof(name) == 3 + log_format_size(FIELDS(LOG_FIELD_FORMAT, LOG_FIELD_FORMAT)), \
+                  #name " does not match its format")
+
+#define LOG_MESSAGE_STRUCTURE(name, id, msg_name, FIELDS)               \
+    { id, sizeof(name), msg_name,                                       \
+      FIELDS(LOG_FIELD_FORMAT, LOG_FIELD_FORMAT),                       \
+      FIELDS(LOG_FIELD_LABEL_FIRST, LOG_FIELD_LABEL) }
+
+/*
+  writer for one message. Points into the write buffer of the backend
+  if there is a single backend with enough contiguous space, otherwise
+  at a local copy which write() passes to WriteBlock()
+ */
+template <typename T>
+class DataFlash_Message {
+public:
+    DataFlash_Message(DataFlash_Class &dataflash, uint8_t msg_type, bool is_critical = false);
+
+    ~DataFlash_Message();
+
+    T *operator->() { return _pkt; }
+    T &operator*() { return *_pkt; }
+
+    // finish the message. It is dropped if the buffer was full
+    void write();
+
+private:
+    DataFlash_Class &_dataflash;
+    T *_pkt;
+    bool _is_critical;
+    bool _reserved;
+    bool _dropped;
+    T _local;
+};
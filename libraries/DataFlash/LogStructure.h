@@ -22,6 +22,8 @@ struct LogStructure {
     const char labels[64];
 };
 
+#include "LogMessage.h"
+
 /*
   log structures common to all vehicle types
  */
@@ -74,15 +76,20 @@ struct PACKED log_Message {
     char msg[64];
 };
 
-struct PACKED log_IMU {
-    LOG_PACKET_HEADER;
-    uint64_t time_us;
-    float gyro_x, gyro_y, gyro_z;
-    float accel_x, accel_y, accel_z;
-    uint32_t gyro_error, accel_error;
-    float temperature;
-    uint8_t gyro_health, accel_health;
-};
+#define LOG_IMU_FIELDS(F0, F)                   \
+    F0(uint64_t, time_us,      Q, TimeUS)       \
+    F(float,     gyro_x,       f, GyrX)         \
+    F(float,     gyro_y,       f, GyrY)         \
+    F(float,     gyro_z,       f, GyrZ)         \
+    F(float,     accel_x,      f, AccX)         \
+    F(float,     accel_y,      f, AccY)         \
+    F(float,     accel_z,      f, AccZ)         \
+    F(uint32_t,  gyro_error,   I, ErrG)         \
+    F(uint32_t,  accel_error,  I, ErrA)         \
+    F(float,     temperature,  f, Temp)         \
+    F(uint8_t,   gyro_health,  B, GyHlt)        \
+    F(uint8_t,   accel_health, B, AcHlt)
+LOG_MESSAGE_STRUCT(log_IMU, LOG_IMU_FIELDS);
 
 struct PACKED log_IMUDT {
     LOG_PACKET_HEADER;
@@ -99,6 +106,51 @@ struct PACKED log_Vibe {
     uint32_t clipping_0, clipping_1, clipping_2;
 };
 
+struct PACKED log_GyroFFT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    float peak_freq_x, peak_freq_y, peak_freq_z;
+    float peak_energy_x, peak_energy_y, peak_energy_z;
+    float total_energy_x, total_energy_y, total_energy_z;
+    uint32_t frames_dropped;
+};
+
+// header of a batch of raw IMU samples
+struct PACKED log_ISBH {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t seqno;
+    uint8_t sensor_type; // 0 for accel, 1 for gyro
+    uint8_t instance;
+    uint16_t multiplier;
+    uint16_t sample_count;
+    uint64_t sample_us;
+    float sample_rate_hz;
+};
+
+// 32 samples of a batch, x/y/z are scaled by the header multiplier
+struct PACKED log_ISBD {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t isb_seqno;
+    uint16_t seqno; // message number within the batch
+    int16_t x[32];
+    int16_t y[32];
+    int16_t z[32];
+};
+
+// logging bandwidth of one message type over the last second
+#define LOG_DFT_FIELDS(F0, F)                   \
+    F0(uint64_t, time_us,    Q, TimeUS)         \
+    F(uint8_t,   msg_type,   B, Id)             \
+    F(char[4],   name,       n, Name)           \
+    F(uint16_t,  rate_hz,    H, Rate)           \
+    F(uint32_t,  bytes,      I, Bps)            \
+    F(uint16_t,  dropped,    H, Drop)           \
+    F(uint16_t,  limited,    H, Lim)            \
+    F(uint8_t,   decimation, B, Dec)
+LOG_MESSAGE_STRUCT(log_DFT, LOG_DFT_FIELDS);
+
 struct PACKED log_Gimbal1 {
     LOG_PACKET_HEADER;
     uint32_t time_ms;
@@ -597,20 +649,34 @@ struct PACKED log_DF_MAV_Stats {
     uint32_t retries;
     uint32_t resends;
     uint8_t internal_errors; // uint8_t - wishful thinking?
-    uint8_t state_free_avg;
-    uint8_t state_free_min;
-    uint8_t state_free_max;
-    uint8_t state_pending_avg;
-    uint8_t state_pending_min;
-    uint8_t state_pending_max;
-    uint8_t state_sent_avg;
-    uint8_t state_sent_min;
-    uint8_t state_sent_max;
-    // uint8_t state_retry_avg;
-    // uint8_t state_retry_min;
-    // uint8_t state_retry_max;
+    uint16_t state_free_avg;
+    uint16_t state_free_min;
+    uint16_t state_free_max;
+    uint16_t state_pending_avg;
+    uint16_t state_pending_min;
+    uint16_t state_pending_max;
+    uint16_t state_sent_avg;
+    uint16_t state_sent_min;
+    uint16_t state_sent_max;
+    // uint16_t state_retry_avg;
+    // uint16_t state_retry_min;
+    // uint16_t state_retry_max;
 };
 
+// congestion control state and throughput of MAVLink logging
+#define LOG_DF_MAV_THROUGHPUT_FIELDS(F0, F)     \
+    F0(uint64_t, time_us,   Q, TimeUS)          \
+    F(float,     cwnd,      f, Win)             \
+    F(float,     ssthresh,  f, SSTh)            \
+    F(uint16_t,  srtt,      H, RTT)             \
+    F(uint16_t,  rto,       H, RTO)             \
+    F(uint16_t,  in_flight, H, Fl)              \
+    F(uint32_t,  tx_rate,   I, TxBps)           \
+    F(uint32_t,  ack_rate,  I, AckBps)          \
+    F(uint16_t,  nacks,     H, Nak)             \
+    F(uint16_t,  timeouts,  H, TO)
+LOG_MESSAGE_STRUCT(log_DF_MAV_Throughput, LOG_DF_MAV_THROUGHPUT_FIELDS);
+
 struct PACKED log_ORGN {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -687,6 +753,7 @@ Format characters in the format string for binary log messages
   M   : uint8_t flight mode
   q   : int64_t
   Q   : uint64_t
+  a   : int16_t[32]
  */
 
 // messages for all boards
@@ -703,8 +770,7 @@ Format characters in the format string for binary log messages
       "GPA",  "QCCCC", "TimeUS,VDop,HAcc,VAcc,SAcc" }, \
     { LOG_GPA2_MSG, sizeof(log_GPA), \
       "GPA2", "QCCCC", "TimeUS,VDop,HAcc,VAcc,SAcc" }, \
-    { LOG_IMU_MSG, sizeof(log_IMU), \
-      "IMU",  "QffffffIIfBB",     "TimeUS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ,ErrG,ErrA,Temp,GyHlt,AcHlt" }, \
+    LOG_MESSAGE_STRUCTURE(log_IMU, LOG_IMU_MSG, "IMU", LOG_IMU_FIELDS), \
     { LOG_MESSAGE_MSG, sizeof(log_Message), \
       "MSG",  "QZ",     "TimeUS,Message"}, \
     { LOG_RCIN_MSG, sizeof(log_RCIN), \
@@ -738,14 +804,13 @@ Format characters in the format string for binary log messages
     { LOG_RFND_MSG, sizeof(log_RFND), \
       "RFND", "QCC",         "TimeUS,Dist1,Dist2" }, \
     { LOG_DF_MAV_STATS, sizeof(log_DF_MAV_Stats), \
-      "DMS", "IIIIIBBBBBBBBBB",         "TimeMS,N,Dp,RT,RS,Er,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx" }
+      "DMS", "IIIIIBHHHHHHHHH",         "TimeMS,N,Dp,RT,RS,Er,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx" }, \
+    LOG_MESSAGE_STRUCTURE(log_DF_MAV_Throughput, LOG_DF_MAV_THROUGHPUT, "DMT", LOG_DF_MAV_THROUGHPUT_FIELDS)
 
 // messages for more advanced boards
 #define LOG_EXTRA_STRUCTURES \
-    { LOG_IMU2_MSG, sizeof(log_IMU), \
-      "IMU2",  "QffffffIIfBB",     "TimeUS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ,ErrG,ErrA,Temp,GyHlt,AcHlt" }, \
-    { LOG_IMU3_MSG, sizeof(log_IMU), \
-      "IMU3",  "QffffffIIfBB",     "TimeUS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ,ErrG,ErrA,Temp,GyHlt,AcHlt" }, \
+    LOG_MESSAGE_STRUCTURE(log_IMU, LOG_IMU2_MSG, "IMU2", LOG_IMU_FIELDS), \
+    LOG_MESSAGE_STRUCTURE(log_IMU, LOG_IMU3_MSG, "IMU3", LOG_IMU_FIELDS), \
     { LOG_AHR2_MSG, sizeof(log_AHRS), \
       "AHR2","QccCfLL","TimeUS,Roll,Pitch,Yaw,Alt,Lat,Lng" }, \
     { LOG_POS_MSG, sizeof(log_POS), \
@@ -861,7 +926,14 @@ Format characters in the format string for binary log messages
     { LOG_GIMBAL2_MSG, sizeof(log_Gimbal2), \
       "GMB2", "IBfffffffff", "TimeMS,es,ex,ey,ez,rx,ry,rz,tx,ty,tz" }, \
     { LOG_GIMBAL3_MSG, sizeof(log_Gimbal3), \
-      "GMB3", "Ihhh", "TimeMS,rl_torque_cmd,el_torque_cmd,az_torque_cmd" }
+      "GMB3", "Ihhh", "TimeMS,rl_torque_cmd,el_torque_cmd,az_torque_cmd" }, \
+    { LOG_GYRO_FFT_MSG, sizeof(log_GyroFFT), \
+      "GFFT", "QfffffffffI", "TimeUS,PkX,PkY,PkZ,EPkX,EPkY,EPkZ,ETotX,ETotY,ETotZ,Drop" }, \
+    { LOG_ISBH_MSG, sizeof(log_ISBH), \
+      "ISBH", "QHBBHHQf", "TimeUS,N,type,instance,mul,smp_cnt,SampleUS,smp_rate" }, \
+    { LOG_ISBD_MSG, sizeof(log_ISBD), \
+      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z" }, \
+    LOG_MESSAGE_STRUCTURE(log_DFT, LOG_DFT_MSG, "DFT", LOG_DFT_FIELDS)
 
 // #if SBP_HW_LOGGING
 #define LOG_SBP_STRUCTURES \
@@ -975,6 +1047,12 @@ enum LogMessages {
     LOG_GIMBAL2_MSG,
     LOG_GIMBAL3_MSG,
 
+    LOG_GYRO_FFT_MSG,
+    LOG_ISBH_MSG,
+    LOG_ISBD_MSG,
+    LOG_DFT_MSG,
+    LOG_DF_MAV_THROUGHPUT,
+
 // message types 211 to 220 reversed for autotune use
 
 };
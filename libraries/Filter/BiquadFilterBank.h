@@ -0,0 +1,138 @@
+// -*- tab-width: 4; Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file   BiquadFilterBank.h
+/// @brief  Cascaded biquad filters for the three axes of several sensor
+///         instances, with all filter state kept in one block of memory
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+#include <string.h>
+
+/*
+  A bank of cascaded biquad filters, a 2 pole low pass followed by an
+  optional notch, for the X/Y/Z axes of up to INSTANCES sensors.
+
+  Delay elements are stored as arrays of 4 floats (X, Y, Z and a pad
+  lane) per stage and instance, so the per axis update of a stage is a
+  single 4 wide operation the compiler can vectorise, and the state of
+  all instances shares a few cache lines instead of being spread over a
+  separate filter object per instance. Stages that are not configured
+  are skipped.
+ */
+template <uint8_t INSTANCES>
+class BiquadFilterBank {
+public:
+    enum stage {
+        STAGE_LOWPASS = 0,
+        STAGE_NOTCH   = 1,
+        NUM_STAGES
+    };
+
+    BiquadFilterBank() {
+        memset(_coeffs, 0, sizeof(_coeffs));
+        memset(_enabled, 0, sizeof(_enabled));
+        memset(_delay1, 0, sizeof(_delay1));
+        memset(_delay2, 0, sizeof(_delay2));
+    }
+
+    // set the 2 pole low pass stage of an instance. A cutoff of zero
+    // disables the stage
+    void set_lowpass(uint8_t instance, float sample_freq, float cutoff_freq) {
+        if (sample_freq <= 0.0f || cutoff_freq <= 0.0f) {
+            _enabled[STAGE_LOWPASS][instance] = false;
+            return;
+        }
+        struct coeffs &c = _coeffs[STAGE_LOWPASS][instance];
+        const float ohm = tanf(M_PI * cutoff_freq / sample_freq);
+        const float k = 2.0f * cosf(M_PI / 4.0f) * ohm;
+        const float a0_inv = 1.0f / (1.0f + k + ohm*ohm);
+        c.b0 = ohm*ohm * a0_inv;
+        c.b1 = 2.0f * c.b0;
+        c.b2 = c.b0;
+        c.a1 = 2.0f * (ohm*ohm - 1.0f) * a0_inv;
+        c.a2 = (1.0f - k + ohm*ohm) * a0_inv;
+        _enabled[STAGE_LOWPASS][instance] = true;
+    }
+
+    // set the notch stage of an instance. A zero center frequency or
+    // attenuation disables the stage
+    void set_notch(uint8_t instance, float sample_freq, float center_freq,
+                   float bandwidth, float attenuation_db) {
+        if (sample_freq <= 0.0f || center_freq <= 0.0f ||
+            attenuation_db <= 0.0f ||
+            center_freq >= 0.5f * sample_freq ||
+            bandwidth <= 0.0f || center_freq <= 0.5f * bandwidth) {
+            _enabled[STAGE_NOTCH][instance] = false;
+            return;
+        }
+        struct coeffs &c = _coeffs[STAGE_NOTCH][instance];
+        const float omega = 2.0f * M_PI * center_freq / sample_freq;
+        const float octaves = log2f(center_freq / (center_freq - 0.5f * bandwidth)) * 2.0f;
+        // peaking EQ with a negative gain, the gain at the center is A^2
+        const float A = powf(10.0f, -attenuation_db / 40.0f);
+        const float Q = sqrtf(powf(2.0f, octaves)) / (powf(2.0f, octaves) - 1.0f);
+        const float alpha = sinf(omega) / (2.0f * Q);
+        const float a0_inv = 1.0f / (1.0f + alpha / A);
+        c.b0 = (1.0f + alpha * A) * a0_inv;
+        c.b1 = -2.0f * cosf(omega) * a0_inv;
+        c.b2 = (1.0f - alpha * A) * a0_inv;
+        c.a1 = c.b1;
+        c.a2 = (1.0f - alpha / A) * a0_inv;
+        _enabled[STAGE_NOTCH][instance] = true;
+    }
+
+    // run a new sample of an instance through all enabled stages
+    Vector3f apply(uint8_t instance, const Vector3f &sample) {
+        float v[4] = { sample.x, sample.y, sample.z, 0.0f };
+        for (uint8_t s = 0; s < NUM_STAGES; s++) {
+            if (!_enabled[s][instance]) {
+                continue;
+            }
+            const struct coeffs &c = _coeffs[s][instance];
+            float *d1 = _delay1[s][instance];
+            float *d2 = _delay2[s][instance];
+            for (uint8_t i = 0; i < 4; i++) {
+                const float d0 = v[i] - d1[i] * c.a1 - d2[i] * c.a2;
+                v[i] = d0 * c.b0 + d1[i] * c.b1 + d2[i] * c.b2;
+                d2[i] = d1[i];
+                d1[i] = d0;
+            }
+        }
+        return Vector3f(v[0], v[1], v[2]);
+    }
+
+    // clear the state of all stages of an instance
+    void reset(uint8_t instance) {
+        for (uint8_t s = 0; s < NUM_STAGES; s++) {
+            memset(_delay1[s][instance], 0, sizeof(_delay1[s][instance]));
+            memset(_delay2[s][instance], 0, sizeof(_delay2[s][instance]));
+        }
+    }
+
+private:
+    // coefficients normalised by a0, direct form II as DigitalBiquadFilter
+    struct coeffs {
+        float b0, b1, b2;
+        float a1, a2;
+    };
+
+    struct coeffs _coeffs[NUM_STAGES][INSTANCES];
+    bool _enabled[NUM_STAGES][INSTANCES];
+
+    float _delay1[NUM_STAGES][INSTANCES][4] __attribute__((aligned(16)));
+    float _delay2[NUM_STAGES][INSTANCES][4] __attribute__((aligned(16)));
+};
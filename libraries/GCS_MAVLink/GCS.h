@@ -30,6 +30,17 @@
     #define GCS_MAVLINK_PAYLOAD_STATUS_CAPACITY          30
 #endif
 
+// largest number of mission items requested ahead of the last
+// contiguous item received during a mission upload, when MIS_UPLOAD_WIN
+// asks for more than one. Must be between 1 and 32
+#ifndef GCS_MAVLINK_MISSION_WINDOW
+#if HAL_CPU_CLASS >= HAL_CPU_CLASS_1000
+    #define GCS_MAVLINK_MISSION_WINDOW                   16
+#else
+    #define GCS_MAVLINK_MISSION_WINDOW                   4
+#endif
+#endif
+
 //  GCS Message ID's
 /// NOTE: to ensure we never block on sending MAVLink messages
 /// please keep each MSG_ to a single MAVLink message. If need be
@@ -238,8 +249,14 @@ private:
     uint8_t        crlf_count;
 
     // waypoints
-    uint16_t        waypoint_request_i; // request index
-    uint16_t        waypoint_request_last; // last request index
+    uint16_t        waypoint_request_i; // request index, the first item not yet received
+    uint16_t        waypoint_request_last; // one past the last request index
+    uint16_t        waypoint_request_next; // next item to request in the window
+    uint32_t        waypoint_window_received; // bitmap of items received, bit 0 is waypoint_request_i
+    uint8_t         waypoint_window_size; // items requested at once in this upload, 1 for the strict handshake
+    uint16_t        waypoint_request_start; // first item of the upload, for the final CRC
+    uint16_t        waypoint_upload_crc; // CRC of the item CRCs of the contiguous items received
+    uint16_t        waypoint_window_crc[GCS_MAVLINK_MISSION_WINDOW]; // CRC of each item received in the window, by seq % window
     uint16_t        waypoint_dest_sysid; // where to send requests
     uint16_t        waypoint_dest_compid; // "
     bool            waypoint_receiving; // currently receiving
@@ -327,6 +344,8 @@ private:
     void handle_mission_count(AP_Mission &mission, mavlink_message_t *msg);
     void handle_mission_clear_all(AP_Mission &mission, mavlink_message_t *msg);
     void handle_mission_write_partial_list(AP_Mission &mission, mavlink_message_t *msg);
+    static uint16_t mission_item_crc(const mavlink_mission_item_t &packet);
+    void send_mission_crc(void);
     bool handle_mission_item(mavlink_message_t *msg, AP_Mission &mission);
 
     void handle_request_data_stream(mavlink_message_t *msg, bool save);
@@ -159,20 +159,37 @@ GCS_MAVLINK::queued_param_send()
 }
 
 /**
- * @brief Send the next pending waypoint, called from deferred message
- * handling code
+ * @brief Send requests for the pending waypoints in the upload window,
+ * called from deferred message handling code
+ *
+ * Up to waypoint_window_size items past the first missing item are
+ * requested without waiting for each to arrive, so the upload rate is
+ * limited by link bandwidth rather than round trip time. Items already
+ * received are not requested again. The window is only opened beyond
+ * one item when the ground station has asked for it with
+ * MIS_UPLOAD_WIN, otherwise this is the usual one request per item.
  */
 void
 GCS_MAVLINK::queued_waypoint_send()
 {
-    if (initialised &&
-        waypoint_receiving &&
-        waypoint_request_i <= waypoint_request_last) {
+    if (!initialised || !waypoint_receiving) {
+        return;
+    }
+    if (waypoint_request_next < waypoint_request_i) {
+        waypoint_request_next = waypoint_request_i;
+    }
+    uint16_t window_end = MIN(waypoint_request_i + waypoint_window_size, waypoint_request_last);
+    while (waypoint_request_next < window_end &&
+           HAVE_PAYLOAD_SPACE(chan, MISSION_REQUEST)) {
+        uint16_t seq = waypoint_request_next++;
+        if (waypoint_window_received & (1UL << (seq - waypoint_request_i))) {
+            continue;
+        }
         mavlink_msg_mission_request_send(
             chan,
             waypoint_dest_sysid,
             waypoint_dest_compid,
-            waypoint_request_i);
+            seq);
     }
 }
 
@@ -302,6 +319,34 @@ mission_item_send_failed:
     mavlink_msg_mission_ack_send(chan, msg->sysid, msg->compid, MAV_MISSION_ERROR);
 }
 
+/*
+  CRC of the fields of a MISSION_ITEM that describe the command, as
+  they were sent, so a GCS can compute the same value from its own
+  copy of the mission
+ */
+uint16_t GCS_MAVLINK::mission_item_crc(const mavlink_mission_item_t &packet)
+{
+    // param1 to z, seq and command, in wire order
+    uint16_t crc = crc16_ccitt((const uint8_t *)&packet.param1,
+                               offsetof(mavlink_mission_item_t, target_system), 0);
+    // frame, current and autocontinue
+    return crc16_ccitt(&packet.frame,
+                       sizeof(mavlink_mission_item_t) - offsetof(mavlink_mission_item_t, frame), crc);
+}
+
+/*
+  send the CRC of a completed upload as a NAMED_VALUE_INT called
+  MIS_CRC, so a GCS can check the whole upload in one go. The value is
+  a CRC16 over the little endian mission_item_crc() of each item in
+  order, accumulated as the items arrive so no commands need to be
+  read back from storage
+ */
+void GCS_MAVLINK::send_mission_crc(void)
+{
+    const char name[MAVLINK_MSG_NAMED_VALUE_INT_FIELD_NAME_LEN] = "MIS_CRC";
+    mavlink_msg_named_value_int_send(chan, AP_HAL::millis(), name, waypoint_upload_crc);
+}
+
 /*
   handle a MISSION_SET_CURRENT mavlink packet
  */
@@ -342,6 +387,11 @@ void GCS_MAVLINK::handle_mission_count(AP_Mission &mission, mavlink_message_t *m
     waypoint_request_i = 0;                 // reset the next expected command number to zero
     waypoint_request_last = packet.count;   // record how many commands we expect to receive
     waypoint_timelast_request = 0;          // set time we last requested commands to zero
+    waypoint_request_next = 0;              // nothing requested yet
+    waypoint_window_received = 0;           // nothing received yet
+    waypoint_window_size = MIN(mission.upload_window(), GCS_MAVLINK_MISSION_WINDOW);
+    waypoint_request_start = 0;
+    waypoint_upload_crc = 0;
 }
 
 /*
@@ -384,7 +434,12 @@ void GCS_MAVLINK::handle_mission_write_partial_list(AP_Mission &mission, mavlink
     waypoint_timelast_request = 0;
     waypoint_receiving   = true;
     waypoint_request_i   = packet.start_index;
-    waypoint_request_last= packet.end_index;
+    waypoint_request_last= packet.end_index+1;  // end_index is inclusive
+    waypoint_request_next= packet.start_index;
+    waypoint_window_received = 0;
+    waypoint_window_size = MIN(mission.upload_window(), GCS_MAVLINK_MISSION_WINDOW);
+    waypoint_request_start = packet.start_index;
+    waypoint_upload_crc = 0;
 }
 
 
@@ -666,8 +721,17 @@ bool GCS_MAVLINK::handle_mission_item(mavlink_message_t *msg, AP_Mission &missio
         goto mission_ack;
     }
 
-    // check if this is the requested waypoint
-    if (packet.seq != waypoint_request_i) {
+    // items before the window, or already received within it, are
+    // duplicates from a retransmit and can be ignored
+    if (packet.seq < waypoint_request_i ||
+        (packet.seq < waypoint_request_i + waypoint_window_size &&
+         (waypoint_window_received & (1UL << (packet.seq - waypoint_request_i))))) {
+        return false;
+    }
+
+    // check if this is one of the requested waypoints
+    if (packet.seq >= waypoint_request_i + waypoint_window_size ||
+        packet.seq >= waypoint_request_last) {
         result = MAV_MISSION_INVALID_SEQUENCE;
         goto mission_ack;
     }
@@ -680,25 +744,36 @@ bool GCS_MAVLINK::handle_mission_item(mavlink_message_t *msg, AP_Mission &missio
             result = MAV_MISSION_ERROR;
             goto mission_ack;
         }
-        // if command is at the end of command list, add the command
-    } else if (packet.seq == mission.num_commands()) {
-        if (mission.add_cmd(cmd)) {
-            result = MAV_MISSION_ACCEPTED;
-        }else{
-            result = MAV_MISSION_ERROR;
-            goto mission_ack;
-        }
-        // if beyond the end of the command list, return an error
+        // if command is beyond the end of command list, write it
+        // directly. The mission is extended once all items arrive
+    } else if (mission.write_cmd_to_storage(packet.seq, cmd)) {
+        result = MAV_MISSION_ACCEPTED;
     } else {
         result = MAV_MISSION_ERROR;
         goto mission_ack;
     }
     
-    // update waypoint receiving state machine
+    // update waypoint receiving state machine, sliding the window
+    // past all contiguous received items
     waypoint_timelast_receive = AP_HAL::millis();
-    waypoint_request_i++;
+    waypoint_window_received |= 1UL << (packet.seq - waypoint_request_i);
+    waypoint_window_crc[packet.seq % GCS_MAVLINK_MISSION_WINDOW] = mission_item_crc(packet);
+    while (waypoint_window_received & 1) {
+        waypoint_upload_crc = crc16_ccitt((const uint8_t *)&waypoint_window_crc[waypoint_request_i % GCS_MAVLINK_MISSION_WINDOW],
+                                          sizeof(uint16_t), waypoint_upload_crc);
+        waypoint_window_received >>= 1;
+        waypoint_request_i++;
+    }
     
     if (waypoint_request_i >= waypoint_request_last) {
+        if (!mission.extend(waypoint_request_last)) {
+            // the upload is over either way, stop asking for items
+            waypoint_receiving = false;
+            waypoint_window_received = 0;
+            waypoint_request_next = waypoint_request_last;
+            result = MAV_MISSION_ERROR;
+            goto mission_ack;
+        }
         mavlink_msg_mission_ack_send_buf(
             msg,
             chan,
@@ -707,15 +782,17 @@ bool GCS_MAVLINK::handle_mission_item(mavlink_message_t *msg, AP_Mission &missio
             MAV_MISSION_ACCEPTED);
         
         send_text(MAV_SEVERITY_INFO,"Flight plan received");
+        send_mission_crc();
         waypoint_receiving = false;
         mission_is_complete = true;
         // XXX ignores waypoint radius for individual waypoints, can
         // only set WP_RADIUS parameter
     } else {
         waypoint_timelast_request = AP_HAL::millis();
-        // if we have enough space, then send the next WP immediately
+        // if we have enough space, then top up the request window
+        // immediately
         if (comm_get_txspace(chan) >= 
-            MAVLINK_NUM_NON_PAYLOAD_BYTES+MAVLINK_MSG_ID_MISSION_ITEM_LEN) {
+            MAVLINK_NUM_NON_PAYLOAD_BYTES+MAVLINK_MSG_ID_MISSION_REQUEST_LEN) {
             queued_waypoint_send();
         } else {
             send_message(MSG_NEXT_WAYPOINT);
@@ -850,9 +927,11 @@ GCS_MAVLINK::update(run_cli_fn run_cli)
     uint32_t wp_recv_time = 1000U + (stream_slowdown*20);
 
     if (waypoint_receiving &&
-        waypoint_request_i <= waypoint_request_last &&
+        waypoint_request_i < waypoint_request_last &&
         tnow - waypoint_timelast_request > wp_recv_time) {
         waypoint_timelast_request = tnow;
+        // re-request the items in the window that haven't arrived
+        waypoint_request_next = waypoint_request_i;
         send_message(MSG_NEXT_WAYPOINT);
     }
 
@@ -1411,6 +1490,46 @@ void GCS_MAVLINK::send_vibration(const AP_InertialSensor &ins) const
         ins.get_accel_clip_count(0),
         ins.get_accel_clip_count(1),
         ins.get_accel_clip_count(2));
+
+#if GYRO_FFT_ENABLED
+    // strongest gyro noise frequency on each axis, then the power in
+    // that peak and the total power above GYRO_FFT_MIN_FREQ_HZ
+    const GyroFFT *fft = ins.get_gyro_fft();
+    if (fft == nullptr || !fft->healthy()) {
+        return;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+    if (HAVE_PAYLOAD_SPACE(chan, DEBUG_VECT)) {
+        const Vector3f &peak_freq = fft->get_peak_freq();
+        mavlink_msg_debug_vect_send(
+            chan,
+            "GYRO_FFT",
+            now_us,
+            peak_freq.x,
+            peak_freq.y,
+            peak_freq.z);
+    }
+    if (HAVE_PAYLOAD_SPACE(chan, DEBUG_VECT)) {
+        const Vector3f &peak_energy = fft->get_peak_energy();
+        mavlink_msg_debug_vect_send(
+            chan,
+            "GFFT_PEAK",
+            now_us,
+            peak_energy.x,
+            peak_energy.y,
+            peak_energy.z);
+    }
+    if (HAVE_PAYLOAD_SPACE(chan, DEBUG_VECT)) {
+        const Vector3f &total_energy = fft->get_total_energy();
+        mavlink_msg_debug_vect_send(
+            chan,
+            "GFFT_TOT",
+            now_us,
+            total_energy.x,
+            total_energy.y,
+            total_energy.z);
+    }
+#endif
 }
 
 void GCS_MAVLINK::send_home(const Location &home) const
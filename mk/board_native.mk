@@ -59,6 +59,10 @@ LDFLAGS        +=   -Wl,--gc-sections -Wl,-Map -Wl,$(SKETCHMAP)
 endif
 
 LIBS ?= -lm -pthread
+ifeq ($(SYSTYPE),Linux)
+# shm_open() for AP_SharedState
+LIBS += -lrt
+endif
 ifneq ($(findstring CYGWIN, $(SYSTYPE)),)
 LIBS += -lwinmm
 endif